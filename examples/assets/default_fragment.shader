@@ -2,14 +2,26 @@
 
 in vec4 passColor;
 in vec2 UV;
-in float texture;
+flat in uint textureSlot;
+flat in uint textureLayer;
 
 out vec4 color;
 
-layout(binding=0) uniform sampler2D textureSamplers[32];
+layout(binding=0) uniform sampler2D textureSamplers[16];
+layout(binding=16) uniform sampler2DArray textureArrays[16];
+
+uniform float alphaCutoff = 0.0;
 
 void main()
 {
-    int index = int(texture);
-    color = texture2D(textureSamplers[index], UV).rgba * passColor;
-}
\ No newline at end of file
+    int index = int(textureSlot);
+    if (index < 16) {
+        color = texture(textureSamplers[index], UV).rgba * passColor;
+    } else {
+        color = texture(textureArrays[index - 16], vec3(UV, float(textureLayer))).rgba * passColor;
+    }
+
+    if (color.a < alphaCutoff) {
+        discard;
+    }
+}
@@ -3,18 +3,25 @@
 layout (location = 0) in vec2 inPosition;
 layout (location = 1) in vec2 inUV;
 layout (location = 2) in vec4 inColor;
-layout (location = 3) in float inTexture;
+layout (location = 3) in uint inTexture;
+layout (location = 4) in uint inTextureLayer;
+layout (location = 5) in float inDepth;
 
-uniform mat4 mvp;
+layout (std140, binding = 0) uniform Camera {
+    mat4 mvp;
+};
 
 out vec4 passColor;
 out vec2 UV;
-out float texture;
+flat out uint textureSlot;
+flat out uint textureLayer;
 
 void main()
 {
     gl_Position = mvp * vec4(inPosition, 0.0, 1.0);
+    gl_Position.z = inDepth * gl_Position.w;
     passColor = inColor;
     UV = inUV;
-    texture = inTexture;
-}
\ No newline at end of file
+    textureSlot = inTexture;
+    textureLayer = inTextureLayer;
+}
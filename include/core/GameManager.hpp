@@ -24,6 +24,7 @@
 
 #include <core/ResourceManager.hpp>
 #include <core/Scene.hpp>
+#include <graphics/FramePacket.hpp>
 #include <graphics/RenderOverlay.hpp>
 #include <graphics/RenderWindow.hpp>
 #include <memory>
@@ -49,13 +50,17 @@ namespace rosa {
          * \param window_title the window title
          * \param msaa the level of MSAA to apply
          * \param window_hidden true to hide the window (for tests), false to show
+         * \param backend WindowBackend::Headless to render without a display, see RenderWindow
+         * \param present_mode How frames reach the screen, see RenderWindow::setPresentMode()
          */
         explicit GameManager(
                 int window_width,
                 int window_height,
                 const std::string& window_title = "rosa window",
                 int msaa = 0,
-                bool window_hidden = false
+                bool window_hidden = false,
+                WindowBackend backend = WindowBackend::Native,
+                PresentMode present_mode = PresentMode::Offscreen
         );
 
         /**
@@ -126,6 +131,32 @@ namespace rosa {
             m_clear_colour = colour;
         }
 
+        /**
+         * \brief Execute GL work on a separate render thread
+         *
+         * Each frame is recorded into a packet and drawn on the render thread while the next
+         * one is simulated, so rendering lags the simulation by at most one frame. While it
+         * runs, the game thread uses a hidden context sharing the window's objects. Takes
+         * effect on the next call to run().
+         *
+         * \param enabled true to pipeline rendering, false to render on the game thread
+         */
+        auto setRenderThread(bool enabled) -> void {
+            m_use_render_thread = enabled;
+        }
+
+        /**
+         * \brief Compile shader programs without stalling the frame that requested them
+         *
+         * Uses GL_KHR_parallel_shader_compile where the driver supports it, otherwise a worker
+         * thread with its own hidden context. Renderables drawn before their program is ready
+         * follow the Renderer's PendingShaderPolicy. Takes effect straight away, so enable it
+         * before adding scenes to keep their programs off the critical path too.
+         *
+         * \param enabled true to compile asynchronously, false to compile on demand
+         */
+        auto setAsyncShaders(bool enabled) -> void;
+
         ~GameManager();
 
         GameManager(GameManager const&)                     = delete;
@@ -135,7 +166,13 @@ namespace rosa {
 
     private:
 
+        /**
+         * \brief Draw a recorded frame into the window, on the thread owning its context
+         */
+        auto executeFrame(FramePacket& packet) -> void;
+
         std::chrono::time_point<std::chrono::system_clock> m_time; /**< used to calculate the frame delta time */
+        std::chrono::time_point<std::chrono::steady_clock> m_last_execute{}; /**< frame interval for dynamic resolution */
 
         std::unordered_map<std::string, std::unique_ptr<Scene>> m_scenes{}; /**< collection of all the registered scenes */
         Scene* m_current_scene{nullptr};
@@ -145,6 +182,9 @@ namespace rosa {
 
         std::uint64_t m_frame_count{0};
 
+        bool        m_use_render_thread{false};
+        FramePacket m_frame_packet{};
+
         RenderOverlay m_render_overlay;
     };
 
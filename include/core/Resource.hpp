@@ -35,7 +35,8 @@ namespace rosa {
         ResourceMusic          = 2,
         ResourceFont           = 3,
         ResourceVertexShader   = 5,
-        ResourceFragmentShader = 6
+        ResourceFragmentShader = 6,
+        ResourceAnimation      = 7
     };
 
     /**
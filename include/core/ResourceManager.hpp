@@ -20,8 +20,11 @@
 #include <core/Resource.hpp>
 #include <core/Uuid.hpp>
 #include <graphics/Texture.hpp>
+#include <graphics/TextureAtlas.hpp>
+#include <graphics/TexturePool.hpp>
 
 #include <fmt/format.h>
+#include <functional>
 #include <memory>
 #include <physfs.h>
 #include <string>
@@ -91,6 +94,12 @@ namespace rosa {
      *  manifest is read and the assets are loaded into memory, performing any relevant initialisation.
      *
      *  Assets can then be retrieved in the engine by Uuid with getAsset()
+     *
+     *  Textures given a `pool` name in the manifest are grouped by name, dimensions and format
+     *  into TexturePool array textures once the whole pack has been read.
+     *
+     *  When atlasing is enabled with setAtlasSettings(), other small textures and font pages are
+     *  copied into shared TextureAtlas textures as they are loaded.
      */
     class ResourceManager {
     public:
@@ -154,11 +163,37 @@ namespace rosa {
         ResourceManager()  = default;
         ~ResourceManager() = default;
 
+        /**
+         * \brief Get all texture pools built for an asset pack
+         */
+        auto getTexturePools(const std::string& path) const -> const std::vector<std::unique_ptr<TexturePool>>&;
+
+        /**
+         * \brief Control which textures are copied into atlases
+         *
+         * Only affects asset packs registered afterwards.
+         */
+        auto setAtlasSettings(const AtlasSettings& settings) -> void;
+
+        auto getAtlasSettings() const -> const AtlasSettings&;
+
+        /**
+         * \brief Get combined fill and eviction figures for all atlases
+         */
+        auto getAtlasStats() const -> AtlasStats;
+
     private:
-        std::unordered_map<Uuid, std::unique_ptr<Resource>> m_resources;
-        static std::unique_ptr<ResourceManager>             s_instance;
+        // Atlases must outlive the resources that hold regions in them
+        std::vector<std::unique_ptr<TextureAtlas>>                                 m_texture_atlases;
+        AtlasSettings                                                              m_atlas_settings{};
+        std::unordered_map<Uuid, std::unique_ptr<Resource>>                        m_resources;
+        std::unordered_map<std::string, std::vector<std::unique_ptr<TexturePool>>> m_texture_pools;
+        std::vector<std::pair<std::string, Texture*>>                              m_pending_pool_textures;
+        static std::unique_ptr<ResourceManager>                                    s_instance;
 
         auto load_resource(const std::string& path, const YAML::Node& node) -> void;
+        auto build_texture_pools(const std::string& path) -> void;
+        auto insert_into_atlas(unsigned int format, TextureFilterParams filter_params, const std::function<bool(TextureAtlas&)>& insert) -> bool;
     };
 
 }// namespace rosa
\ No newline at end of file
@@ -16,10 +16,15 @@
 #pragma once
 
 #include <core/ResourceManager.hpp>
+#include <core/SpatialIndex.hpp>
+#include <core/ThreadPool.hpp>
 #include <ecs/EntityRegistry.hpp>
 #include <graphics/RenderWindow.hpp>
+#include <memory>
+#include <optional>
 #include <spdlog/spdlog.h>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <core/Entity.hpp>
 #include <core/Event.hpp>
@@ -124,6 +129,41 @@ namespace rosa {
              */
             auto getEntity(const Uuid& uuid) -> Entity&;
 
+            /**
+             * @brief Enable or disable culling of off-screen world-space renderables
+             *
+             *  Enabled by default. Screen-space renderables are never culled.
+             */
+            auto setCulling(bool enabled) -> void {
+                m_culling = enabled;
+            }
+
+            /**
+             * @brief Check whether off-screen culling is enabled
+             */
+            auto getCulling() const -> bool {
+                return m_culling;
+            }
+
+            /**
+             * @brief Get the spatial index of world-space sprites and text
+             *
+             *  Entities are keyed by uuid and their bounds are refreshed at the end of update, so
+             *  queries made from scripts see positions as of the previous frame. Only entities whose
+             *  transform, sprite or text was fetched through Entity since then, and their children,
+             *  are looked at again; components changed through the registry directly are missed.
+             */
+            auto getSpatialIndex() const -> const SpatialIndex& {
+                return m_spatial_index;
+            }
+
+            /**
+             * @brief Simulate large particle emitters on worker threads
+             *
+             * @param thread_count Number of workers, 0 simulates everything on the calling thread
+             */
+            auto setParticleThreads(std::size_t thread_count) -> void;
+
         private:
             ecs::EntityRegistry<Entity> m_registry;
             RenderWindow* m_render_window;
@@ -138,6 +178,23 @@ namespace rosa {
 
             double m_last_frame_time{};
             glm::vec4 m_active_camera_pos{0};
+            bool m_culling{true};
+
+            auto markIndexDirty(const Uuid& uuid) -> void;
+            auto updateSpatialIndex() -> void;
+            auto unindexEntity(const Uuid& uuid) -> void;
+            auto drawTilemaps(const std::optional<Rect>& view) -> void;
+            auto drawParticles() -> void;
+
+            SpatialIndex             m_spatial_index{};
+            std::vector<Uuid>        m_index_dirty{};
+            std::unordered_set<Uuid> m_index_pending{};
+            std::unordered_set<Uuid> m_screen_space_set{};
+            bool                     m_screen_space_dirty{false};
+            std::vector<Uuid>        m_screen_space_entities{};
+            std::vector<Uuid>        m_visible_entities{};
+
+            std::unique_ptr<ThreadPool> m_particle_pool{};
     };
 
 } // namespace rosa
\ No newline at end of file
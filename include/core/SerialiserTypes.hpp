@@ -17,10 +17,12 @@
 
 #include <yaml-cpp/yaml.h>
 #include <glm/glm.hpp>
+#include <graphics/BlendMode.hpp>
 
 namespace rosa {
     auto operator<<(YAML::Emitter& out, const glm::vec2& vec) -> YAML::Emitter&;
     auto operator<<(YAML::Emitter& out, const glm::vec3& vec) -> YAML::Emitter&;
+    auto operator<<(YAML::Emitter& out, BlendMode blend_mode) -> YAML::Emitter&;
 } // namespace rosa
 
 namespace YAML {
@@ -65,4 +67,11 @@ namespace YAML {
             return node;
         }
     };
+
+    // Blend modes are stored by name, anything else is rejected rather than cast into the enum
+    template<>
+    struct convert<rosa::BlendMode> {
+        static auto decode(const Node& node, rosa::BlendMode& rhs) -> bool;
+        static auto encode(const rosa::BlendMode& rhs) -> Node;
+    };
 } // namespace YAML
\ No newline at end of file
@@ -0,0 +1,162 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <core/Uuid.hpp>
+#include <glm/glm.hpp>
+#include <graphics/Rect.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief A uniform hash grid of world-space bounds, keyed by entity Uuid
+     *
+     * Each handle is stored in every grid cell its bounds overlap. Bounds spanning more than
+     * max_cells_per_axis cells in either axis are kept in a separate list that every query
+     * checks, so a handful of huge objects can't flood the grid.
+     *
+     * Changes are queued with update() and remove() and only applied on commit(), which the
+     * Scene does once per frame after transforms have been resolved. Queries see the state as
+     * of the last commit and return handles in the order they were first inserted, so callers
+     * get a stable ordering from frame to frame.
+     */
+    class SpatialIndex {
+    public:
+        static constexpr int max_cells_per_axis{16};
+
+        /**
+         * \brief Create an empty index
+         * \param cell_size Width and height of each grid cell in world units
+         */
+        explicit SpatialIndex(float cell_size = 256.F);
+
+        /**
+         * \brief Queue an insertion or a change of bounds
+         */
+        auto update(const Uuid& handle, const Rect& bounds) -> void;
+
+        /**
+         * \brief Queue a removal
+         */
+        auto remove(const Uuid& handle) -> void;
+
+        /**
+         * \brief Apply all queued changes
+         */
+        auto commit() -> void;
+
+        /**
+         * \brief Remove everything, including queued changes
+         */
+        auto clear() -> void;
+
+        /**
+         * \brief Find all handles whose bounds overlap a rect
+         * \param area World-space rect to test
+         * \param results Cleared, then filled with matching handles
+         */
+        auto queryRect(const Rect& area, std::vector<Uuid>& results) const -> void;
+
+        /**
+         * \brief Find all handles whose bounds overlap a rect
+         */
+        auto queryRect(const Rect& area) const -> std::vector<Uuid>;
+
+        /**
+         * \brief Find all handles whose bounds overlap a circle
+         */
+        auto queryRadius(glm::vec2 centre, float radius) const -> std::vector<Uuid>;
+
+        /**
+         * \brief Find all handles whose bounds contain a point
+         */
+        auto queryPoint(glm::vec2 point) const -> std::vector<Uuid>;
+
+        /**
+         * \brief Get the committed bounds of a handle
+         */
+        auto getBounds(const Uuid& handle) const -> std::optional<Rect>;
+
+        /**
+         * \brief Check whether a handle is in the index, as of the last commit
+         */
+        auto contains(const Uuid& handle) const -> bool;
+
+        /**
+         * \brief Number of handles in the index, as of the last commit
+         */
+        auto size() const -> std::size_t {
+            return m_lookup.size();
+        }
+
+        auto getCellSize() const -> float {
+            return m_cell_size;
+        }
+
+    private:
+        struct CellRange {
+            int min_x{0};
+            int min_y{0};
+            int max_x{-1};
+            int max_y{-1};
+
+            auto operator==(const CellRange& other) const -> bool = default;
+        };
+
+        struct Entry {
+            Uuid          handle{};
+            Rect          bounds{};
+            CellRange     cells{};
+            bool          oversized{false};
+            std::uint64_t sequence{0};
+            mutable int   query_stamp{0};
+        };
+
+        struct PendingChange {
+            Uuid handle{};
+            Rect bounds{};
+            bool removal{false};
+        };
+
+        auto getCellRange(const Rect& bounds) const -> CellRange;
+        auto link(std::uint32_t entry_index) -> void;
+        auto unlink(std::uint32_t entry_index) -> void;
+        auto collect(const Rect& area, std::vector<std::uint32_t>& candidates) const -> void;
+        auto toHandles(std::vector<std::uint32_t>& candidates, std::vector<Uuid>& results) const -> void;
+
+        static auto cellKey(int cell_x, int cell_y) -> std::uint64_t;
+
+        float m_cell_size;
+
+        std::vector<Entry>                                            m_entries{};
+        std::vector<std::uint32_t>                                    m_free_entries{};
+        std::unordered_map<Uuid, std::uint32_t>                       m_lookup{};
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_cells{};
+        std::vector<std::uint32_t>                                    m_oversized{};
+        std::vector<PendingChange>                                    m_pending{};
+
+        std::uint64_t m_next_sequence{0};
+        mutable int   m_query_stamp{0};
+    };
+
+}// namespace rosa
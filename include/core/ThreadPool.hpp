@@ -0,0 +1,84 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief A fixed set of worker threads taking jobs from a shared queue
+     */
+    class ThreadPool {
+    public:
+        /**
+         * \brief Start the workers
+         * \param thread_count Number of workers, at least one is always started
+         */
+        explicit ThreadPool(std::size_t thread_count);
+
+        /**
+         * \brief Finish any queued jobs, then join the workers
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&)                    = delete;
+        auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+        ThreadPool(ThreadPool&&)                         = delete;
+        auto operator=(ThreadPool&&) -> ThreadPool&      = delete;
+
+        /**
+         * \brief Queue a job
+         * \return A future that is ready when the job has run, rethrowing anything it threw
+         */
+        auto submit(std::function<void()> job) -> std::future<void>;
+
+        /**
+         * \brief Split [0, count) into contiguous ranges and run them in parallel
+         *
+         * The calling thread runs the first range itself and returns once every range has
+         * finished. Ranges are never smaller than min_range, so small counts run inline.
+         *
+         * \param count Number of items
+         * \param min_range Smallest number of items worth giving to a thread
+         * \param job Called with the begin and end of each range
+         */
+        auto parallelFor(std::size_t count, std::size_t min_range, const std::function<void(std::size_t, std::size_t)>& job) -> void;
+
+        auto getThreadCount() const -> std::size_t {
+            return m_threads.size();
+        }
+
+    private:
+        auto run() -> void;
+
+        std::vector<std::thread>               m_threads{};
+        std::queue<std::packaged_task<void()>> m_jobs{};
+        std::mutex                             m_mutex{};
+        std::condition_variable                m_condition{};
+        bool                                   m_stopping{false};
+    };
+
+}// namespace rosa
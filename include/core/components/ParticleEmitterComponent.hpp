@@ -0,0 +1,269 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <core/SerialiserTypes.hpp>
+#include <core/ThreadPool.hpp>
+#include <core/Uuid.hpp>
+#include <glm/glm.hpp>
+#include <graphics/BlendMode.hpp>
+#include <graphics/Colour.hpp>
+#include <graphics/Quad.hpp>
+#include <graphics/ShaderProgram.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace rosa {
+
+    /**
+     * \brief How an emitter spawns and moves its particles
+     */
+    struct ParticleSettings {
+        float         rate{50.F};          // Particles spawned per second while emitting
+        std::uint32_t max_particles{1000}; // Spawning stops while this many are alive
+        glm::vec2     lifetime{1.F, 1.F};  // Seconds, minimum and maximum
+        glm::vec2     speed{50.F, 100.F};  // World units per second, minimum and maximum
+        float         direction{-90.F};    // Degrees, 0 points along +x
+        float         spread{30.F};        // Degrees either side of direction
+        glm::vec2     gravity{0.F, 0.F};   // Acceleration in world units per second squared
+        float         drag{0.F};           // Fraction of velocity lost per second
+        float         start_size{8.F};
+        float         end_size{8.F};
+        Colour        start_colour{1.F, 1.F, 1.F, 1.F};
+        Colour        end_colour{1.F, 1.F, 1.F, 0.F};
+    };
+
+    /**
+     * \brief Spawns, simulates and draws a cloud of particles
+     *
+     * Particles aren't entities. They live in structure of arrays storage inside the emitter,
+     * one array per attribute, so each simulation pass is a simple loop over contiguous
+     * floats that the compiler can vectorise and that can be split across worker threads.
+     * Dead particles are swapped with the last live one, keeping the arrays dense.
+     *
+     * Particles are spawned at the emitter's world position and then move independently of
+     * it. They are drawn as a single batch per emitter, see Renderer::submitParticles().
+     */
+    struct ParticleEmitterComponent {
+
+        ParticleEmitterComponent();
+
+        auto setSettings(const ParticleSettings& settings) -> void;
+
+        auto getSettings() const -> const ParticleSettings& {
+            return m_settings;
+        }
+
+        /**
+         * \brief Set the texture drawn for each particle, nothing is drawn until there is one
+         */
+        auto setTexture(const Uuid& uuid) -> void;
+
+        auto getTextureUuid() const -> const Uuid& {
+            return m_texture_uuid;
+        }
+
+        /**
+         * \brief Start or stop spawning, live particles carry on either way
+         */
+        auto setEmitting(bool emitting) -> void {
+            m_emitting = emitting;
+        }
+
+        auto isEmitting() const -> bool {
+            return m_emitting;
+        }
+
+        /**
+         * \brief Set the render layer, ordering the particles against transparent sprites as well as other emitters
+         */
+        auto setLayer(int layer) -> void {
+            m_layer = layer;
+        }
+
+        auto getLayer() const -> int {
+            return m_layer;
+        }
+
+        auto setBlendMode(BlendMode blend_mode) -> void {
+            m_blend_mode = blend_mode;
+        }
+
+        auto getBlendMode() const -> BlendMode {
+            return m_blend_mode;
+        }
+
+        /**
+         * \brief Spawn a number of particles at once, up to max_particles
+         */
+        auto burst(std::uint32_t count, glm::vec2 origin) -> void;
+
+        /**
+         * \brief Remove every live particle
+         */
+        auto clear() -> void;
+
+        /**
+         * \brief Spawn new particles at the origin, then advance and age every particle
+         * \param pool Workers to split large emitters across, or nullptr
+         */
+        auto update(float delta_time, glm::vec2 origin, ThreadPool* pool = nullptr) -> void;
+
+        /**
+         * \brief Submit every live particle to the renderer as one batch
+         */
+        auto draw() -> void;
+
+        /**
+         * \brief Number of live particles
+         */
+        auto getCount() const -> std::size_t {
+            return m_position_x.size();
+        }
+
+        auto getPositionX() const -> const std::vector<float>& {
+            return m_position_x;
+        }
+
+        auto getPositionY() const -> const std::vector<float>& {
+            return m_position_y;
+        }
+
+        auto getColours() const -> const std::vector<Colour>& {
+            return m_colour;
+        }
+
+    private:
+        auto spawn(std::uint32_t count, glm::vec2 origin) -> void;
+        auto simulate(std::size_t begin, std::size_t end, float delta_time) -> void;
+        auto removeDead() -> void;
+
+        ParticleSettings m_settings{};
+        bool             m_emitting{true};
+        float            m_spawn_debt{0.F};
+        std::minstd_rand m_random{};
+        bool             m_seeded{false};
+
+        // One entry per live particle in each
+        std::vector<float>  m_position_x{};
+        std::vector<float>  m_position_y{};
+        std::vector<float>  m_velocity_x{};
+        std::vector<float>  m_velocity_y{};
+        std::vector<float>  m_age{};
+        std::vector<float>  m_lifetime{};
+        std::vector<float>  m_size{};
+        std::vector<Colour> m_colour{};
+
+        Uuid      m_texture_uuid{};
+        Quad      m_quad{};
+        int       m_layer{0};
+        BlendMode m_blend_mode{BlendMode::Transparent};
+
+        rosa::Uuid     m_vertex_shader{"00000000-0000-0000-0000-000000000001"};
+        rosa::Uuid     m_fragment_shader{"00000000-0000-0000-0000-000000000002"};
+        ShaderProgram* m_shader_program{nullptr};
+    };
+
+    auto operator<<(YAML::Emitter& out, const ParticleEmitterComponent& component) -> YAML::Emitter&;
+
+}// namespace rosa
+
+namespace YAML {
+    template<>
+    struct convert<rosa::ParticleEmitterComponent> {
+        static auto decode(const Node& node, rosa::ParticleEmitterComponent& rhs) -> bool {
+            if (!node.IsMap()) {
+                return false;
+            }
+
+            rosa::ParticleSettings settings{};
+
+            if (node["rate"]) {
+                settings.rate = node["rate"].as<float>();
+            }
+
+            if (node["max_particles"]) {
+                settings.max_particles = node["max_particles"].as<std::uint32_t>();
+            }
+
+            if (node["lifetime"]) {
+                settings.lifetime = node["lifetime"].as<glm::vec2>();
+            }
+
+            if (node["speed"]) {
+                settings.speed = node["speed"].as<glm::vec2>();
+            }
+
+            if (node["direction"]) {
+                settings.direction = node["direction"].as<float>();
+            }
+
+            if (node["spread"]) {
+                settings.spread = node["spread"].as<float>();
+            }
+
+            if (node["gravity"]) {
+                settings.gravity = node["gravity"].as<glm::vec2>();
+            }
+
+            if (node["drag"]) {
+                settings.drag = node["drag"].as<float>();
+            }
+
+            if (node["start_size"]) {
+                settings.start_size = node["start_size"].as<float>();
+            }
+
+            if (node["end_size"]) {
+                settings.end_size = node["end_size"].as<float>();
+            }
+
+            if (node["start_colour"]) {
+                settings.start_colour = node["start_colour"].as<rosa::Colour>();
+            }
+
+            if (node["end_colour"]) {
+                settings.end_colour = node["end_colour"].as<rosa::Colour>();
+            }
+
+            rhs.setSettings(settings);
+
+            if (node["texture"]) {
+                rhs.setTexture(node["texture"].as<rosa::Uuid>());
+            }
+
+            if (node["emitting"]) {
+                rhs.setEmitting(node["emitting"].as<bool>());
+            }
+
+            if (node["layer"]) {
+                rhs.setLayer(node["layer"].as<int>());
+            }
+
+            if (node["blend_mode"]) {
+                rhs.setBlendMode(node["blend_mode"].as<rosa::BlendMode>());
+            }
+
+            return true;
+        }
+    };
+}// namespace YAML
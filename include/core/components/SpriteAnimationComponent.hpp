@@ -0,0 +1,155 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <core/Uuid.hpp>
+#include <graphics/SpriteAnimation.hpp>
+
+#include <cstdint>
+#include <string_view>
+#include <yaml-cpp/yaml.h>
+
+namespace rosa {
+
+    /**
+     * \brief Plays sprite sheet clips on the entity's SpriteComponent
+     *
+     * The component only holds playback state. The Scene steps every animation in one pass
+     * over the component array each update, and only touches the sprite when its frame
+     * has actually changed.
+     */
+    struct SpriteAnimationComponent {
+
+        /**
+         * \brief Use the clips of a SpriteAnimation asset, stopping playback
+         */
+        auto setAnimation(const Uuid& uuid) -> void;
+
+        /**
+         * \brief Use the clips of an animation that is already loaded, stopping playback
+         */
+        auto setAnimation(const SpriteAnimation& animation) -> void;
+
+        auto getAnimationUuid() const -> const Uuid& {
+            return m_uuid;
+        }
+
+        /**
+         * \brief Start playing a clip from its first frame
+         * \param restart Start over even if the clip is already playing
+         * \return False if the clip doesn't exist
+         */
+        auto play(std::string_view clip, bool restart = false) -> bool;
+
+        /**
+         * \brief Stop on the current frame
+         */
+        auto stop() -> void;
+
+        /**
+         * \brief Carry on from where the clip was stopped
+         */
+        auto resume() -> void;
+
+        /**
+         * \brief Set the playback rate, 1 is normal speed
+         */
+        auto setSpeed(float speed) -> void;
+
+        auto getSpeed() const -> float {
+            return m_speed;
+        }
+
+        auto isPlaying() const -> bool {
+            return m_playing;
+        }
+
+        /**
+         * \brief Check whether a clip that plays once has reached its end
+         */
+        auto isFinished() const -> bool {
+            return m_finished;
+        }
+
+        /**
+         * \brief Get the current clip, if any
+         */
+        auto getClip() const -> const AnimationClip*;
+
+        auto getFrame() const -> std::size_t {
+            return m_frame;
+        }
+
+        /**
+         * \brief Advance playback
+         * \return True if the sprite needs the current frame's rect
+         */
+        auto step(float delta_time) -> bool;
+
+        /**
+         * \brief Get the current frame's rect for a texture
+         */
+        auto getFrameUv(const Texture& texture) const -> const AnimationFrameUv&;
+
+        private:
+            auto advance(std::size_t frame_count) -> void;
+
+            const SpriteAnimation* m_animation{nullptr};
+            Uuid                   m_uuid{};
+
+            std::uint32_t m_clip{0};
+            std::uint32_t m_frame{0};
+            float         m_time{0.F};
+            float         m_speed{1.F};
+            bool          m_playing{false};
+            bool          m_finished{false};
+            bool          m_reverse{false};
+            bool          m_dirty{false};
+    };
+
+    auto operator<<(YAML::Emitter& out, const SpriteAnimationComponent& component) -> YAML::Emitter&;
+
+} // namespace rosa
+
+namespace YAML {
+    template<>
+    struct convert<rosa::SpriteAnimationComponent> {
+        static auto decode(const Node& node, rosa::SpriteAnimationComponent& rhs) -> bool {
+            if (!node.IsMap()) {
+                return false;
+            }
+
+            rhs.setAnimation(node["animation"].as<rosa::Uuid>());
+
+            if (node["speed"]) {
+                rhs.setSpeed(node["speed"].as<float>());
+            }
+
+            if (node["clip"]) {
+                rhs.play(node["clip"].as<std::string>());
+
+                if (node["playing"] && !node["playing"].as<bool>()) {
+                    rhs.stop();
+                }
+            }
+
+            return true;
+        }
+    };
+}// namespace YAML
@@ -17,6 +17,7 @@
 
 #include <core/Uuid.hpp>
 #include <core/ResourceManager.hpp>
+#include <core/SerialiserTypes.hpp>
 #include <graphics/Sprite.hpp>
 
 #include <string_view>
@@ -49,13 +50,24 @@ namespace YAML {
 
             rhs.setTexture(node["texture"].as<rosa::Uuid>());
             rhs.setColour(node["colour"].as<rosa::Colour>());
+
+            if (node["layer"]) {
+                rhs.setLayer(node["layer"].as<int>());
+            }
+
+            if (node["blend_mode"]) {
+                rhs.setBlendMode(node["blend_mode"].as<rosa::BlendMode>());
+            }
+
             return true;
         }
 
         static auto encode(const rosa::SpriteComponent& rhs) -> Node {
             Node node;
-            node["texture"] = rhs.getTextureUuid().toString();
-            node["colour"]  = rhs.getColour();
+            node["texture"]    = rhs.getTextureUuid().toString();
+            node["colour"]     = rhs.getColour();
+            node["layer"]      = rhs.getLayer();
+            node["blend_mode"] = rhs.getBlendMode();
             return node;
         }
     };
@@ -21,9 +21,13 @@
 #include <glm/glm.hpp>
 #include <graphics/BitmapFont.hpp>
 #include <graphics/Quad.hpp>
+#include <graphics/Rect.hpp>
 #include <graphics/Renderer.hpp>
 #include <graphics/ShaderProgram.hpp>
+#include <spdlog/spdlog.h>
 
+#include <array>
+#include <memory>
 #include <string_view>
 #include <vector>
 
@@ -38,8 +42,34 @@ namespace rosa {
 
         /**
          * \brief Set the text to be displayed
+         *
+         * Setting the same text again does nothing, and a changed string only has its glyphs
+         * laid out again from the first changed character onward.
          */
-        auto setText(const std::string& text) -> void;
+        auto setText(std::string_view text) -> void;
+
+        /**
+         * \brief Format the text to be displayed in place, for labels that change every frame
+         *
+         * The result is formatted into a fixed buffer, so nothing is allocated along the way.
+         * Anything past bf_max_layout_length characters, the most a font will lay out, is cut
+         * off with a warning.
+         *
+         * \return false if the text was truncated
+         */
+        template<typename... Args>
+        auto setTextFormatted(fmt::format_string<Args...> format, Args&&... args) -> bool {
+            std::array<char, bf_max_layout_length> buffer;
+            auto result = fmt::format_to_n(buffer.data(), buffer.size(), format, std::forward<Args>(args)...);
+            setText(std::string_view(buffer.data(), std::min(result.size, buffer.size())));
+
+            if (result.size > buffer.size()) {
+                spdlog::warn("TextComponent: Formatted text truncated from {} to {} characters", result.size, buffer.size());
+                return false;
+            }
+
+            return true;
+        }
 
         /**
          * \brief Retrieve a previously set string
@@ -56,6 +86,15 @@ namespace rosa {
          */
         auto getScreenSpace() const -> bool;
 
+        /**
+         * \brief Set the draw layer, higher layers are drawn over lower ones
+         *
+         * Text is drawn after the sprites on its own layer.
+         */
+        auto setLayer(int layer) -> void;
+
+        auto getLayer() const -> int;
+
         /**
          * \brief Retrieve the asset Uuid of the font
          */
@@ -102,17 +141,34 @@ namespace rosa {
          */
         auto getFragmentShader() -> const Uuid&;
 
+        /**
+         * \brief Get the world-space bounds of the laid out text under a transform
+         *
+         * The result is cached and only recalculated when the transform or text changes.
+         */
+        auto getBounds(const glm::mat4& transform) -> const Rect&;
+
     protected:
         auto draw(glm::mat4 transform) -> void;
 
+        // Bring the layout up to date if anything has changed since the last call
+        auto updateLayout() -> void;
+
     private:
-        BitmapFont* m_font{nullptr};
-        Uuid m_font_uuid;
-        std::vector<Quad> m_quad_cache;
-        bool m_screen_space{true};
-        std::string m_text;
-        Colour m_colour{1.F, 1.F, 1.F};
-        glm::vec2         m_offset{0.F, 0.F};
+        BitmapFont*                 m_font{nullptr};
+        Uuid                        m_font_uuid;
+        std::shared_ptr<TextLayout> m_layout{};
+        bool                        m_layout_dirty{true};
+        bool                        m_screen_space{true};
+        int                         m_layer{0};
+        std::string                 m_text;
+        Colour                      m_colour{1.F, 1.F, 1.F};
+        glm::vec2                   m_offset{0.F, 0.F};
+
+        Rect      m_bounds{};
+        glm::mat4 m_bounds_transform{0.F};
+        bool      m_bounds_dirty{true};
+        Uuid      m_indexed_as{};
 
         rosa::Uuid     m_vertex_shader{"00000000-0000-0000-0000-000000000001"};
         rosa::Uuid     m_fragment_shader{"00000000-0000-0000-0000-000000000002"};
@@ -0,0 +1,214 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <core/SerialiserTypes.hpp>
+#include <core/Uuid.hpp>
+#include <glm/glm.hpp>
+#include <graphics/BlendMode.hpp>
+#include <graphics/Colour.hpp>
+#include <graphics/QuadBuffer.hpp>
+#include <graphics/Rect.hpp>
+#include <graphics/ShaderProgram.hpp>
+#include <graphics/Texture.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+constexpr int tilemap_chunk_size{32};
+constexpr int tilemap_dirty_limit{tilemap_chunk_size * tilemap_chunk_size / 4};// Past this, a chunk is rebaked whole
+
+namespace rosa {
+
+    /**
+     * \brief A grid of tiles from a single tileset, drawn from geometry baked per chunk
+     *
+     * Tiles are stored in chunks of tilemap_chunk_size by tilemap_chunk_size. The first time
+     * a chunk is on screen its quads are baked into a static buffer that stays on the GPU,
+     * after that only tiles that change are rewritten. Chunks that don't overlap the view
+     * are skipped altogether, so a large map costs one draw per visible chunk.
+     *
+     * The map's top left corner sits at the entity's position, one tile is tile_size units
+     * across before the entity's scale. Moving the entity rebakes every visible chunk, so
+     * tilemaps are best left where they are.
+     */
+    struct TilemapComponent {
+
+        static constexpr int empty_tile{-1};
+
+        TilemapComponent();
+
+        /**
+         * \brief Set the texture tiles are cut from
+         * \param uuid Texture asset, tiles are numbered left to right then top to bottom
+         * \param tile_size Size of each tile in the texture, in pixels
+         */
+        auto setTileset(const Uuid& uuid, glm::vec2 tile_size) -> void;
+
+        auto getTilesetUuid() const -> const Uuid& {
+            return m_tileset_uuid;
+        }
+
+        auto getTileSize() const -> glm::vec2 {
+            return m_tile_size;
+        }
+
+        /**
+         * \brief Change the size of the map in tiles, emptying it
+         */
+        auto resize(int width, int height) -> void;
+
+        auto getWidth() const -> int {
+            return m_width;
+        }
+
+        auto getHeight() const -> int {
+            return m_height;
+        }
+
+        /**
+         * \brief Set a tile, positions outside the map are ignored
+         * \param tile Index into the tileset, or empty_tile
+         */
+        auto setTile(int x, int y, int tile) -> void;
+
+        /**
+         * \brief Get a tile, or empty_tile outside the map
+         */
+        auto getTile(int x, int y) const -> int;
+
+        auto setColour(const Colour& colour) -> void;
+
+        auto getColour() const -> const Colour& {
+            return m_colour;
+        }
+
+        auto setLayer(int layer) -> void;
+
+        auto getLayer() const -> int {
+            return m_layer;
+        }
+
+        auto setBlendMode(BlendMode blend_mode) -> void {
+            m_blend_mode = blend_mode;
+        }
+
+        auto getBlendMode() const -> BlendMode {
+            return m_blend_mode;
+        }
+
+        /**
+         * \brief Number of chunks across and down
+         */
+        auto getChunkCount() const -> glm::ivec2 {
+            return {m_chunks_x, m_chunks_y};
+        }
+
+        /**
+         * \brief Get the chunks overlapping a world-space rect, as a range of chunk coordinates
+         * \return First chunk and one past the last chunk, empty if nothing overlaps
+         */
+        auto getVisibleChunks(const glm::mat4& transform, const Rect& view) const -> std::pair<glm::ivec2, glm::ivec2>;
+
+        /**
+         * \brief Bake anything that changed and submit the chunks overlapping the view
+         * \param view World-space area to draw, or nothing to draw every chunk
+         */
+        auto draw(const glm::mat4& transform, const std::optional<Rect>& view = std::nullopt) -> void;
+
+    private:
+        struct Chunk {
+            std::array<std::int32_t, tilemap_chunk_size * tilemap_chunk_size> tiles{};
+
+            std::shared_ptr<QuadBuffer> buffer{};
+            std::vector<std::uint16_t>  dirty{};      // Tiles changed since the last bake
+            bool                        rebuild{true};// Every tile needs baking
+        };
+
+        auto bakeTile(Chunk& chunk, int chunk_x, int chunk_y, int index) -> void;
+        auto rebuildAll() -> void;
+
+        int                m_width{0};
+        int                m_height{0};
+        int                m_chunks_x{0};
+        int                m_chunks_y{0};
+        std::vector<Chunk> m_chunks{};
+
+        Uuid      m_tileset_uuid{};
+        Texture*  m_tileset{nullptr};
+        glm::vec2 m_tile_size{16.F, 16.F};
+        int       m_tileset_columns{1};
+
+        Colour    m_colour{1.F, 1.F, 1.F, 1.F};
+        int       m_layer{0};
+        BlendMode m_blend_mode{BlendMode::Transparent};
+
+        // Transform the baked vertices were written with
+        glm::mat4 m_baked_transform{0.F};
+
+        rosa::Uuid     m_vertex_shader{"00000000-0000-0000-0000-000000000001"};
+        rosa::Uuid     m_fragment_shader{"00000000-0000-0000-0000-000000000002"};
+        ShaderProgram* m_shader_program{nullptr};
+    };
+
+    auto operator<<(YAML::Emitter& out, const TilemapComponent& component) -> YAML::Emitter&;
+
+}// namespace rosa
+
+namespace YAML {
+    template<>
+    struct convert<rosa::TilemapComponent> {
+        static auto decode(const Node& node, rosa::TilemapComponent& rhs) -> bool {
+            if (!node.IsMap()) {
+                return false;
+            }
+
+            rhs.resize(node["width"].as<int>(), node["height"].as<int>());
+            rhs.setTileset(node["tileset"].as<rosa::Uuid>(), node["tile_size"].as<glm::vec2>());
+
+            if (node["colour"]) {
+                rhs.setColour(node["colour"].as<rosa::Colour>());
+            }
+
+            if (node["layer"]) {
+                rhs.setLayer(node["layer"].as<int>());
+            }
+
+            if (node["blend_mode"]) {
+                rhs.setBlendMode(node["blend_mode"].as<rosa::BlendMode>());
+            }
+
+            // Row by row, width tiles to each
+            if (node["tiles"]) {
+                int index{0};
+                for (const auto& tile: node["tiles"]) {
+                    rhs.setTile(index % rhs.getWidth(), index / rhs.getWidth(), tile.as<int>());
+                    index++;
+                }
+            }
+
+            return true;
+        }
+    };
+}// namespace YAML
@@ -84,6 +84,21 @@ namespace rosa::ecs {
             return m_components[m_uuid_to_index[uuid]];
         }
 
+        // Dense access for systems that walk every component of this type
+        auto size() const -> size_t {
+            return m_size;
+        }
+
+        auto getAtIndex(size_t index) -> T& {
+            assert(index < m_size && "Component index out of range.");
+            return m_components[index];
+        }
+
+        auto getUuidAtIndex(size_t index) const -> const rosa::Uuid& {
+            assert(index < m_size && "Component index out of range.");
+            return m_index_to_uuid.at(index);
+        }
+
         void onEntityDestroyed(const rosa::Uuid& uuid) override {
             if (m_uuid_to_index.find(uuid) != m_uuid_to_index.end()) {
                 // Remove the entity's component if it existed
@@ -82,6 +82,12 @@ namespace rosa::ecs {
             return getComponentArray<T>()->getData(uuid);
         }
 
+        template<typename T>
+        auto getComponents() -> ComponentArray<T>& {
+            // Get the whole packed array for a component type
+            return *getComponentArray<T>();
+        }
+
         auto onEntityDestroyed(const rosa::Uuid& uuid) -> void {
             // Notify each component array that an entity has been destroyed
             // If it has a component for that entity, it will remove it
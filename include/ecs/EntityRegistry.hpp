@@ -93,6 +93,12 @@ namespace rosa::ecs {
             return m_component_registry.getComponent<T>(uuid);
         }
 
+        template<typename T>
+        auto getComponents() -> ComponentArray<T>& {
+            ZoneScopedNC("Registry:GetComponents", profiler::detail::tracy_colour_registry);
+            return m_component_registry.template getComponents<T>();
+        }
+
         template<typename T>
         auto hasComponent(const rosa::Uuid& uuid) -> bool {
             ZoneScopedNC("Registry:HasComponent", profiler::detail::tracy_colour_registry);
@@ -0,0 +1,110 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief A rectangle of pixels within an atlas
+     */
+    struct AtlasRegion {
+        int x{0};
+        int y{0};
+        int width{0};
+        int height{0};
+    };
+
+    /**
+     * \brief Packs rectangles into a fixed size area using guillotine splitting
+     *
+     * Each allocation is placed in the free rectangle that leaves the least area over, and
+     * the remainder is split into two new free rectangles along the shorter leftover axis.
+     * Released regions are returned to the free list and merged with their neighbours where
+     * they share a full edge.
+     *
+     * Allocations can be rounded up to an alignment, which is needed when copying block
+     * compressed data, and padded to keep filtering from sampling neighbouring regions.
+     * The allocator only does the bookkeeping, see TextureAtlas for the GPU side.
+     */
+    class AtlasAllocator {
+    public:
+        /**
+         * \brief Create an allocator for an empty area
+         * \param width Width of the area in pixels
+         * \param height Height of the area in pixels
+         * \param alignment Allocation positions and sizes are rounded up to a multiple of this
+         * \param padding Space left free to the right and below each allocation
+         */
+        AtlasAllocator(int width, int height, int alignment = 1, int padding = 0);
+
+        /**
+         * \brief Find space for a rectangle
+         * \return The region allocated, or nothing if there is no room
+         */
+        auto allocate(int width, int height) -> std::optional<AtlasRegion>;
+
+        /**
+         * \brief Return a previously allocated region to the free list
+         */
+        auto release(const AtlasRegion& region) -> void;
+
+        /**
+         * \brief Release everything
+         */
+        auto reset() -> void;
+
+        /**
+         * \brief Proportion of the area in use, from 0 to 1
+         */
+        auto getFillRatio() const -> float;
+
+        /**
+         * \brief Number of regions currently allocated
+         */
+        auto getAllocationCount() const -> int {
+            return m_allocations;
+        }
+
+        auto getWidth() const -> int {
+            return m_width;
+        }
+
+        auto getHeight() const -> int {
+            return m_height;
+        }
+
+    private:
+        auto align(int value) const -> int;
+        auto merge() -> void;
+
+        int m_width;
+        int m_height;
+        int m_alignment;
+        int m_padding;
+
+        std::int64_t m_used_area{0};
+        int          m_allocations{0};
+
+        std::vector<AtlasRegion> m_free_regions{};
+    };
+
+}// namespace rosa
@@ -16,24 +16,48 @@
 #pragma once
 
 #include <core/Resource.hpp>
+#include <glm/glm.hpp>
+#include <graphics/AtlasAllocator.hpp>
 #include <graphics/Colour.hpp>
 #include <graphics/Quad.hpp>
+#include <graphics/TextLayout.hpp>
 
 #include <array>
+#include <cstddef>
+#include <string_view>
+#include <vector>
 
 static constexpr int bf_max_string_length{256};
 static constexpr int bf_width_data_offset{20};
 static constexpr int bf_map_data_offset{276};
 
+// Longest string layout() accepts, TextComponent::setTextFormatted truncates to it
+static constexpr std::size_t bf_max_layout_length{256};
+
 namespace rosa {
 
+    class TextureAtlas;
+
     class BitmapFont : public Resource {
     public:
-        BitmapFont(const std::string& name, const Uuid& uuid, const std::string& pack);
+        BitmapFont(const std::string& name, const Uuid& uuid, const std::string& pack, bool defer_upload = false);
+        ~BitmapFont() override;
 
         auto print(const std::string& text, int pos_x, int pos_y, Colour colour = Colour{1.F, 1.F, 1.F}) -> std::vector<Quad>;
         auto getWidth(const std::string& text) -> int;
 
+        /**
+         * \brief Lay out text into a reusable mesh, regenerating only the glyphs from the first changed character
+         */
+        auto layout(TextLayout& layout, std::string_view text, Colour colour = Colour{1.F, 1.F, 1.F}) -> void;
+
+        /**
+         * \brief Get the live layouts of this font, for identical labels to share
+         */
+        auto getLayoutCache() -> TextLayoutCache& {
+            return m_layouts;
+        }
+
     protected:
         auto setCursor(int x, int y) -> void;
         auto bind() -> void;
@@ -41,6 +65,13 @@ namespace rosa {
         auto select() -> void;
         auto reverseYAxis(bool state) -> void;
         auto generateCharQuads(const std::string& text, Colour colour = Colour{1.F, 1.F, 1.F}) -> std::vector<Quad>;
+        auto makeCharQuad(char character, int pos_x, int pos_y, Colour colour) const -> Quad;
+
+        // Upload the glyph page to a texture of our own
+        auto upload() -> void;
+
+        // Copy the glyph page into an RGBA8 atlas, sampling the same as the standalone texture would
+        auto insertIntoAtlas(TextureAtlas& atlas) -> bool;
 
         unsigned int m_texture_id{};
         int m_cell_x{};
@@ -57,6 +88,16 @@ namespace rosa {
         bool m_invert_y_axis{false};
         int m_image_x{0};
         int m_image_y{0};
+        std::vector<char> m_image_data{};
+
+        TextureAtlas* m_atlas{nullptr};
+        AtlasRegion m_atlas_region{};
+        glm::vec2 m_uv_offset{0.F, 0.F};
+        glm::vec2 m_uv_scale{1.F, 1.F};
+
+        TextLayoutCache m_layouts{};
+
+        friend class ResourceManager;
     };
 
 } // namespace rosa
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+namespace rosa {
+
+    /**
+     * \brief How a renderable is composited with what is already drawn
+     *
+     * Opaque and alpha tested renderables are drawn first, front to back with depth writes
+     * and blending off, so anything they cover is rejected before shading. Transparent
+     * renderables follow back to front, blended and tested against that depth.
+     */
+    enum class BlendMode {
+        Transparent,// Alpha blended, the default
+        Opaque,     // Every fragment covers whatever is behind it
+        AlphaTested,// As opaque, but fragments below half alpha are discarded
+    };
+
+}// namespace rosa
@@ -90,6 +90,22 @@ namespace rosa {
          */
         auto blitDepthTo(GLuint fbo_id, int start_x = 0, int start_y = 0, int width = 0, int height = 0) -> void;
 
+        /**
+         * \brief Stretch the bottom left of the colour buffer over a region of another FBO
+         *
+         * Used by dynamic resolution, which draws into a smaller viewport. Multisampled
+         * buffers are resolved first, only over the area that was drawn. The stretch is a
+         * textured draw rather than a blit, so the destination may be multisampled. It leaves
+         * the destination bound with a viewport of its size.
+         *
+         * \param fbo_id destination FBO
+         * \param source_width width of the drawn area
+         * \param source_height height of the drawn area
+         * \param width destination width
+         * \param height destination height
+         */
+        auto upscaleTo(GLuint fbo_id, int source_width, int source_height, int width, int height) -> void;
+
         /**
          * \brief Copy the colour buffer from GPU to CPU
          *
@@ -128,6 +144,14 @@ namespace rosa {
          */
         auto getId() const -> GLuint;
 
+        /**
+         * \brief Get the single-sample FBO, holding the resolved frame after update()
+         * \return object ID
+         */
+        auto getResolvedId() const -> GLuint {
+            return m_fbo_id;
+        }
+
         /**
          * \brief Get the ID of the single-sample colour buffer object
          * \return object ID
@@ -190,6 +214,12 @@ namespace rosa {
          */
         auto check_frame_buffer_status() -> bool;
 
+        /**
+         * \brief Create the program, vertex array and sampler used by upscaleTo()
+         * \return true if the program linked
+         */
+        auto create_upscale_program() -> bool;
+
         /**
          * \brief Get texture parameters as string using glGetTexLevelParameteriv()
          * \param id Texture object ID
@@ -222,6 +252,10 @@ namespace rosa {
         GLuint m_fbo_id{0};                          // secondary id for frame buffer object
         GLuint m_texture_id{0};                      // id for texture object (color buffer)
         GLuint m_rbo_id{0};                          // id for render buffer object (depth buffer)
+        GLuint m_upscale_program{0};                 // stretches the colour buffer for upscaleTo()
+        GLuint m_upscale_vao{0};                     // empty vertex array for the upscale draw
+        GLuint m_upscale_sampler{0};                 // linear sampler without mipmaps
+        GLint m_upscale_scale_id{-1};                // uvScale uniform location
         std::string m_error_message{"no error"};  // error message, if any
     };
 
@@ -0,0 +1,142 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/BlendMode.hpp>
+#include <graphics/Colour.hpp>
+#include <graphics/Vertex.hpp>
+#include <graphics/VertexFormat.hpp>
+#include <graphics/gl.hpp>
+#include <imgui.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+constexpr int max_textures{16};
+constexpr int max_texture_arrays{16};
+
+namespace rosa {
+
+    class QuadBuffer;
+
+    /**
+     * \brief Textures for one batch, 2D textures on the first units and arrays after them
+     */
+    struct TextureBindings {
+        uint32_t                                 texture_count{0};
+        std::array<uint32_t, max_textures>       textures{};
+        uint32_t                                 texture_array_count{0};
+        std::array<uint32_t, max_texture_arrays> texture_arrays{};
+    };
+
+    enum class RenderCommandType {
+        BindTextures,  // Bind packet.bindings[first]
+        Upload,        // Replace the batch vertex buffer of vertex_format with count vertices from the packet vertices of that format, at first
+        Draw,          // Draw count quads of the batch buffer of vertex_format starting at quad first
+        RetainedUpload,// Write count quads from packet.vertices[source] into target at quad first
+        RetainedDraw,  // Draw the first count quads of target
+        ClearDepth,    // Clear the depth buffer, so later draws ignore what came before
+        ScreenSpace,   // Everything after is screen space, where dynamic resolution switches to the window
+        StreamDraw,    // Stream count quads from the packet vertices of vertex_format, at first, to its stream buffer and draw them
+    };
+
+    /**
+     * \brief A single recorded renderer operation
+     */
+    struct RenderCommand {
+        RenderCommandType type{RenderCommandType::Draw};
+        unsigned int      program{0};
+        int               mvp_id{-1};
+        int               alpha_cutoff_id{-1};
+        std::size_t       camera{0};// Index into FramePacket::cameras
+        BlendMode         blend_mode{BlendMode::Transparent};
+        bool              depth_test{false};// Test transparent draws against depth from opaque ones
+        VertexFormat      vertex_format{VertexFormat::Compact};
+        std::size_t       first{0};
+        std::size_t       count{0};
+        std::size_t       source{0};
+        QuadBuffer*       target{nullptr};
+    };
+
+    /**
+     * \brief ImGui draw data for a frame
+     *
+     * When executed on the thread that built it, the draw data can be used directly. When
+     * it has to outlive the next ImGui frame, the command lists are cloned.
+     */
+    class ImGuiFrame {
+    public:
+        ImGuiFrame() = default;
+        ~ImGuiFrame();
+
+        ImGuiFrame(const ImGuiFrame&)                    = delete;
+        auto operator=(const ImGuiFrame&) -> ImGuiFrame& = delete;
+        ImGuiFrame(ImGuiFrame&&)                         = delete;
+        auto operator=(ImGuiFrame&&) -> ImGuiFrame&      = delete;
+
+        /**
+         * \brief Take the draw data of the current ImGui frame
+         * \param clone Copy the command lists so they survive the next ImGui::NewFrame
+         */
+        auto capture(ImDrawData* draw_data, bool clone) -> void;
+
+        /**
+         * \brief Get the captured draw data, or nullptr if there is none
+         */
+        auto getDrawData() -> ImDrawData*;
+
+        auto clear() -> void;
+
+    private:
+        ImDrawData*              m_source{nullptr};
+        ImDrawData               m_copy{};
+        std::vector<ImDrawList*> m_lists{};
+        bool                     m_cloned{false};
+    };
+
+    /**
+     * \brief Everything needed to draw one frame, recorded on the game thread
+     *
+     * A packet is immutable once submitted. It is replayed by whichever thread owns the GL
+     * context, either straight away or on the render thread while the next frame is being
+     * simulated.
+     */
+    struct FramePacket {
+        std::vector<Vertex>          vertices{};        // Retained and static quads, and batches of VertexFormat::Full programs
+        std::vector<CompactVertex>   compact_vertices{};// Batches of VertexFormat::Compact programs, uploaded as they are
+        std::vector<TextureBindings> bindings{};
+        std::vector<RenderCommand>   commands{};
+        std::vector<glm::mat4>       cameras{};// Uploaded to the Camera uniform buffer before any draw
+
+        Colour                            clear_colour{0, 0, 0, 1};
+        std::array<int, 2>                window_size{0, 0};
+        std::optional<std::array<int, 2>> viewport{};        // New viewport, if it changed
+        std::optional<std::array<int, 2>> framebuffer_size{};// New framebuffer size, if the window was resized
+
+        ImGuiFrame imgui{};
+
+        // Signalled once resources created by the game thread for this frame are visible
+        GLsync fence{nullptr};
+
+        auto clear() -> void;
+    };
+
+}// namespace rosa
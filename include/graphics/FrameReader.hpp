@@ -0,0 +1,137 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/FrameBuffer.hpp>
+#include <graphics/gl.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+constexpr std::uint64_t readback_latency{2};
+
+namespace rosa {
+
+    /**
+     * \brief Pixels read back from a finished frame
+     */
+    struct FrameCapture {
+        std::uint64_t              frame{0};// Counted by the FrameReader, from 1
+        int                        width{0};
+        int                        height{0};
+        std::vector<unsigned char> colour{};// RGBA8, top row first
+        std::vector<float>         depth{}; // Only filled when requested, top row first
+    };
+
+    using ReadbackCallback = std::function<void(const FrameCapture&)>;
+
+    /**
+     * \brief Reads finished frames back from the FrameBuffer without stalling the pipeline
+     *
+     * Readbacks go into a ring of pixel buffer objects. The copy for frame N is issued once
+     * the frame has been drawn and fenced, then mapped readback_latency frames later, by
+     * which point the GPU has normally finished with it. Only when it hasn't does mapping
+     * wait, so a slow consumer holds the frame rate back rather than dropping frames.
+     *
+     * Requests can be made from any thread. Frames are only read while a request is
+     * outstanding, and callbacks run on the thread owning the window's context, which is
+     * the render thread when one is used. Keep them short, or hand the pixels on.
+     */
+    class FrameReader {
+    public:
+        FrameReader() = default;
+        ~FrameReader();
+
+        FrameReader(const FrameReader&)                    = delete;
+        auto operator=(const FrameReader&) -> FrameReader& = delete;
+        FrameReader(FrameReader&&)                         = delete;
+        auto operator=(FrameReader&&) -> FrameReader&      = delete;
+
+        /**
+         * \brief Read back the next frame drawn
+         * \param callback Receives the frame once it has been mapped
+         * \param depth Also read the depth buffer
+         */
+        auto request(ReadbackCallback callback, bool depth = false) -> void;
+
+        /**
+         * \brief Read back the next frame drawn
+         * \param depth Also read the depth buffer
+         */
+        auto request(bool depth = false) -> std::future<FrameCapture>;
+
+        /**
+         * \brief Read back every frame until cleared with an empty callback
+         */
+        auto setContinuous(ReadbackCallback callback, bool depth = false) -> void;
+
+        /**
+         * \brief Issue the readback of a drawn frame and deliver any that are due
+         *
+         * Called once per frame on the thread owning the context, after the framebuffer has
+         * been resolved.
+         */
+        auto capture(FrameBuffer& framebuffer) -> void;
+
+        /**
+         * \brief Wait for every issued readback and deliver it
+         */
+        auto finish() -> void;
+
+        /**
+         * \brief Check whether the next frame has to go through the FrameBuffer
+         *
+         * True while frames are requested, or readbacks are still waiting to be delivered.
+         * Called on the thread owning the context.
+         */
+        auto isCapturing() const -> bool;
+
+    private:
+        struct Slot {
+            GLuint                        colour_pbo{0};
+            GLuint                        depth_pbo{0};
+            std::size_t                   colour_size{0};
+            std::size_t                   depth_size{0};
+            GLsync                        fence{nullptr};
+            std::uint64_t                 frame{0};
+            int                           width{0};
+            int                           height{0};
+            bool                          depth{false};
+            std::vector<ReadbackCallback> callbacks{};
+        };
+
+        auto issue(Slot& slot, const FrameBuffer& framebuffer, bool depth) -> void;
+        auto deliver(Slot& slot) -> void;
+
+        std::array<Slot, readback_latency + 1> m_slots{};
+        std::size_t                            m_next{0};
+        std::uint64_t                          m_frame{0};
+
+        mutable std::mutex            m_mutex{};
+        std::vector<ReadbackCallback> m_requests{};
+        bool                          m_requests_depth{false};
+        ReadbackCallback              m_continuous{};
+        bool                          m_continuous_depth{false};
+    };
+
+}// namespace rosa
@@ -0,0 +1,167 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <core/ThreadPool.hpp>
+#include <graphics/FrameReader.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rosa {
+
+    enum class CaptureFormat {
+        PngSequence,// One numbered PNG per frame in a directory
+        Raw,        // Packed RGBA8 frames back to back, top row first
+        Y4m,        // YUV4MPEG2 with 4:2:0 chroma, readable by ffmpeg and most encoders
+    };
+
+    /**
+     * \brief What happens to a frame arriving while the queue is full
+     */
+    enum class CaptureOverflow {
+        DropNewest,// Discard the incoming frame
+        DropOldest,// Discard the longest waiting frame to make room
+        Block,     // Wait for room, slowing the renderer down to the encoder's pace
+    };
+
+    struct CaptureSettings {
+        CaptureFormat   format{CaptureFormat::PngSequence};
+        std::string     path{};           // Directory for PNG sequences, otherwise a file, or "|command" to pipe into
+        std::size_t     queue_size{8};    // Frames waiting to be encoded before overflow applies
+        std::size_t     workers{2};       // Encoder threads
+        CaptureOverflow overflow{CaptureOverflow::DropNewest};
+        int             frame_rate{60};   // Written into the Y4M header
+    };
+
+    struct CaptureStats {
+        std::uint64_t captured{0};// Frames accepted into the queue
+        std::uint64_t encoded{0};
+        std::uint64_t dropped{0};
+        std::uint64_t failed{0};
+    };
+
+    /**
+     * \brief Encodes captured frames on background threads
+     *
+     * Frames are pushed into a bounded queue and picked up by a small pool of encoder
+     * threads, so the render loop only ever pays for a copy. When the encoders fall behind,
+     * the overflow policy decides whether frames are dropped or the renderer is made to
+     * wait.
+     *
+     * PNG frames are written independently and may finish out of order. Stream formats are
+     * converted in parallel but written strictly in capture order, and keep the size of the
+     * first frame, later frames of a different size are dropped.
+     *
+     * Attach the recorder to a window's FrameReader to capture every frame, or push frames
+     * from anywhere else.
+     */
+    class FrameRecorder {
+    public:
+        FrameRecorder() = default;
+        ~FrameRecorder();
+
+        FrameRecorder(const FrameRecorder&)                    = delete;
+        auto operator=(const FrameRecorder&) -> FrameRecorder& = delete;
+        FrameRecorder(FrameRecorder&&)                         = delete;
+        auto operator=(FrameRecorder&&) -> FrameRecorder&      = delete;
+
+        /**
+         * \brief Open the output and start the encoders
+         * \throws Exception if the output can't be opened
+         */
+        auto start(const CaptureSettings& settings) -> void;
+
+        /**
+         * \brief Capture every frame read by a FrameReader until stop() is called
+         */
+        auto attach(FrameReader& reader) -> void;
+
+        /**
+         * \brief Queue a frame for encoding, applying the overflow policy
+         * \return False if the frame was dropped
+         */
+        auto push(const FrameCapture& capture) -> bool;
+
+        /**
+         * \brief Detach, encode everything still queued and close the output
+         */
+        auto stop() -> void;
+
+        auto isRecording() const -> bool {
+            return m_pool != nullptr;
+        }
+
+        auto getStats() const -> CaptureStats;
+
+    private:
+        struct QueuedFrame {
+            std::uint64_t sequence{0};
+            FrameCapture  capture{};
+        };
+
+        // Lets a FrameReader callback outlive the recorder's interest in it
+        struct Link {
+            std::mutex     mutex{};
+            FrameRecorder* recorder{nullptr};
+        };
+
+        auto encodeNext() -> void;
+        auto encode(QueuedFrame& frame) -> void;
+        auto write(std::uint64_t sequence, std::vector<unsigned char> data) -> void;
+        auto close() -> void;
+
+        auto toY4m(const QueuedFrame& frame) const -> std::vector<unsigned char>;
+
+        CaptureSettings m_settings{};
+
+        std::mutex              m_mutex{};
+        std::condition_variable m_space{};
+        std::deque<QueuedFrame> m_queue{};
+        std::uint64_t           m_next_sequence{0};
+        int                     m_stream_width{0};
+        int                     m_stream_height{0};
+        bool                    m_accepting{false};
+
+        std::mutex                                          m_write_mutex{};
+        std::map<std::uint64_t, std::vector<unsigned char>> m_reorder{};
+        std::uint64_t                                       m_next_write{0};
+        std::FILE*                                          m_file{nullptr};
+        bool                                                m_pipe{false};
+
+        std::atomic<std::uint64_t> m_captured{0};
+        std::atomic<std::uint64_t> m_encoded{0};
+        std::atomic<std::uint64_t> m_dropped{0};
+        std::atomic<std::uint64_t> m_failed{0};
+
+        FrameReader*          m_reader{nullptr};
+        std::shared_ptr<Link> m_link{};
+
+        std::unique_ptr<ThreadPool> m_pool{};
+    };
+
+}// namespace rosa
@@ -0,0 +1,131 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/gl.hpp>
+
+#include <array>
+#include <cstddef>
+
+constexpr std::size_t max_texture_units{32};
+constexpr std::size_t max_uniform_bindings{4};
+
+namespace rosa {
+
+    /**
+     * \brief Shadow copy of the GL state the renderer changes, skipping calls that change nothing
+     *
+     * There is one instance per thread, as a context is only ever current on one thread at
+     * a time. Code that changes state without going through the cache, such as ImGui or
+     * resource loading, leaves it stale, so it is invalidated at the start of every
+     * Renderer::execute().
+     */
+    class GlState {
+    public:
+        /**
+         * \brief Get the cache for the context current on this thread
+         */
+        static auto current() -> GlState&;
+
+        GlState();
+
+        /**
+         * \brief Forget everything, the next call of each kind always reaches GL
+         */
+        auto invalidate() -> void;
+
+        auto useProgram(GLuint program) -> void;
+        auto bindVertexArray(GLuint vertex_array) -> void;
+
+        /**
+         * \brief Bind a buffer, only GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER are cached
+         *
+         * The element array binding belongs to the vertex array, so it is always passed on.
+         */
+        auto bindBuffer(GLenum target, GLuint buffer) -> void;
+
+        /**
+         * \brief Bind part of a uniform buffer to an indexed binding point
+         */
+        auto bindUniformRange(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) -> void;
+
+        /**
+         * \brief Bind a GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY to a texture unit
+         */
+        auto bindTexture(GLuint unit, GLenum target, GLuint texture) -> void;
+
+        auto setBlend(bool enabled) -> void;
+        auto setBlendFunc(GLenum source, GLenum destination) -> void;
+        auto setDepthTest(bool enabled) -> void;
+        auto setDepthMask(bool enabled) -> void;
+        auto setDepthFunc(GLenum func) -> void;
+
+        /**
+         * \brief Number of calls skipped since the last reset
+         */
+        auto getSkipped() const -> int {
+            return m_skipped;
+        }
+
+        auto resetSkipped() -> void {
+            m_skipped = 0;
+        }
+
+    private:
+        static constexpr GLuint unknown{0xFFFFFFFF};
+
+        struct UniformRange {
+            GLuint     buffer{unknown};
+            GLintptr   offset{0};
+            GLsizeiptr size{0};
+        };
+
+        // Compare against the cached value and update it, true if GL needs calling
+        template<typename T>
+        auto change(T& cached, T value) -> bool {
+            if (cached == value) {
+                m_skipped++;
+                return false;
+            }
+
+            cached = value;
+            return true;
+        }
+
+        GLuint m_program{unknown};
+        GLuint m_vertex_array{unknown};
+        GLuint m_array_buffer{unknown};
+        GLuint m_uniform_buffer{unknown};
+        GLuint m_active_unit{unknown};
+
+        std::array<UniformRange, max_uniform_bindings> m_uniform_ranges{};
+        std::array<GLuint, max_texture_units>          m_textures_2d{};
+        std::array<GLuint, max_texture_units>          m_texture_arrays{};
+
+        // 0 and 1 for off and on, so a fresh cache never matches
+        GLuint m_blend{unknown};
+        GLuint m_blend_source{unknown};
+        GLuint m_blend_destination{unknown};
+        GLuint m_depth_test{unknown};
+        GLuint m_depth_mask{unknown};
+        GLuint m_depth_func{unknown};
+
+        int m_skipped{0};
+    };
+
+}// namespace rosa
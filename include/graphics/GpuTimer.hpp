@@ -0,0 +1,144 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/gl.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+constexpr std::size_t gpu_timer_latency{3};
+constexpr std::size_t max_gpu_timer_zones{256};
+
+namespace rosa {
+
+    /**
+     * \brief Parts of a frame timed on the GPU
+     */
+    enum class GpuPass {
+        Batches,// Every renderer draw, batched or retained
+        Resolve,// MSAA resolve in FrameBuffer::update()
+        Blit,   // Copying the framebuffer to the window
+        ImGui,
+    };
+
+    /**
+     * \brief GPU time spent on a frame, in milliseconds
+     */
+    struct GpuTimings {
+        float batches_ms{0.F};
+        float flush_max_ms{0.F};// Slowest single draw
+        int   flushes{0};
+        float resolve_ms{0.F};
+        float blit_ms{0.F};
+        float imgui_ms{0.F};
+        float frame_ms{0.F};// From the first timestamp of the frame to the last
+    };
+
+    /**
+     * \brief Times zones of GPU work with pairs of GL_TIMESTAMP queries
+     *
+     * Queries for each frame come from a pool that is reused gpu_timer_latency frames
+     * later, by which point the results are normally available. Results that still aren't
+     * ready are dropped rather than waited for, so timing never stalls the pipeline.
+     *
+     * Zones are begun and ended on the thread owning the GL context. Timings may be read
+     * from any thread.
+     */
+    class GpuTimer {
+    public:
+        GpuTimer() = default;
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer&)                    = delete;
+        auto operator=(const GpuTimer&) -> GpuTimer& = delete;
+        GpuTimer(GpuTimer&&)                         = delete;
+        auto operator=(GpuTimer&&) -> GpuTimer&      = delete;
+
+        /**
+         * \brief Start timing a zone
+         * \return Handle for end(), -1 if the zone isn't timed
+         */
+        auto begin(GpuPass pass) -> int;
+
+        /**
+         * \brief Stop timing a zone
+         */
+        auto end(int zone) -> void;
+
+        /**
+         * \brief Finish the current frame and collect the oldest one that has completed
+         */
+        auto endFrame() -> void;
+
+        /**
+         * \brief Get the most recently collected timings
+         */
+        auto getTimings() const -> GpuTimings;
+
+        auto setEnabled(bool enabled) -> void {
+            m_enabled = enabled;
+        }
+
+        auto isEnabled() const -> bool {
+            return m_enabled;
+        }
+
+    private:
+        struct Frame {
+            std::vector<GLuint>  queries{};// Start and end timestamp of each zone
+            std::vector<GpuPass> passes{};
+            std::size_t          zones{0};
+        };
+
+        auto collect(Frame& frame) -> void;
+
+        std::array<Frame, gpu_timer_latency> m_frames{};
+        std::size_t                          m_current{0};
+        bool                                 m_enabled{true};
+
+        mutable std::mutex m_mutex{};
+        GpuTimings         m_timings{};
+    };
+
+    /**
+     * \brief Times a GPU zone for the lifetime of the object
+     */
+    class GpuTimerZone {
+    public:
+        GpuTimerZone(GpuTimer& timer, GpuPass pass)
+            : m_timer(timer), m_zone(timer.begin(pass)) {}
+
+        ~GpuTimerZone() {
+            m_timer.end(m_zone);
+        }
+
+        GpuTimerZone(const GpuTimerZone&)                    = delete;
+        auto operator=(const GpuTimerZone&) -> GpuTimerZone& = delete;
+        GpuTimerZone(GpuTimerZone&&)                         = delete;
+        auto operator=(GpuTimerZone&&) -> GpuTimerZone&      = delete;
+
+    private:
+        GpuTimer& m_timer;
+        int       m_zone;
+    };
+
+}// namespace rosa
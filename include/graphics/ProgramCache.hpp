@@ -0,0 +1,144 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr std::uint32_t program_cache_magic{0x42505352};// "RSPB"
+constexpr std::uint32_t program_cache_version{1};
+
+namespace rosa {
+
+    /**
+     * \brief A linked program as returned by glGetProgramBinary
+     */
+    struct ProgramBinary {
+        std::uint32_t              format{0};
+        std::vector<unsigned char> data{};
+    };
+
+    /**
+     * \brief Stores linked shader programs on disk so later runs can skip compilation
+     *
+     * Entries are keyed by a hash of both shader sources and the GL vendor, renderer and
+     * version strings, so editing a shader or updating the driver simply misses the cache.
+     * A binary the driver refuses to load is treated the same way, and the program is
+     * compiled from source and stored again.
+     *
+     * Program binaries need GL 4.1 or ARB_get_program_binary. Without either the cache
+     * stays out of the way and every program is compiled from source.
+     *
+     * The cache may be shared between threads with contexts sharing the same objects, such
+     * as the game thread and a ShaderCompiler worker.
+     */
+    class ProgramCache {
+    public:
+        /**
+         * \brief Create a cache in the default user cache directory
+         */
+        ProgramCache();
+
+        /**
+         * \brief Create a cache in a specific directory, an empty path disables it
+         */
+        explicit ProgramCache(std::filesystem::path directory);
+
+        /**
+         * \brief Get the per-user directory binaries are stored in by default
+         *
+         * This is $XDG_CACHE_HOME/rosa/shaders, falling back to %LOCALAPPDATA% and then
+         * ~/.cache before the system temporary directory.
+         */
+        static auto getDefaultDirectory() -> std::filesystem::path;
+
+        /**
+         * \brief Hash the inputs that decide whether a stored binary is still valid
+         * \param driver Vendor, renderer and version, see getDriverString()
+         */
+        static auto makeKey(std::string_view vertex_source, std::string_view fragment_source, std::string_view driver) -> std::uint64_t;
+
+        /**
+         * \brief Get the vendor, renderer and version of the current context
+         */
+        static auto getDriverString() -> std::string;
+
+        /**
+         * \brief Check whether the current context can save and restore program binaries
+         */
+        auto isSupported() -> bool;
+
+        /**
+         * \brief Ask the driver to keep the binary of a program that is about to be linked
+         */
+        auto prepare(unsigned int program) -> void;
+
+        /**
+         * \brief Replace a program with a stored binary
+         * \return False if there was no usable entry, the program must then be linked from source
+         */
+        auto load(std::uint64_t key, unsigned int program) -> bool;
+
+        /**
+         * \brief Save the binary of a linked program
+         */
+        auto store(std::uint64_t key, unsigned int program) -> void;
+
+        /**
+         * \brief Read an entry from disk, checking it belongs to the key
+         */
+        auto read(std::uint64_t key) const -> std::optional<ProgramBinary>;
+
+        /**
+         * \brief Write an entry to disk, replacing any existing one
+         * \return False if the entry couldn't be written
+         */
+        auto write(std::uint64_t key, const ProgramBinary& binary) const -> bool;
+
+        auto getDirectory() const -> const std::filesystem::path& {
+            return m_directory;
+        }
+
+        /**
+         * \brief Number of programs restored from the cache
+         */
+        auto getHits() const -> int;
+
+        /**
+         * \brief Number of programs that had to be compiled from source
+         */
+        auto getMisses() const -> int;
+
+    private:
+        auto checkSupport() -> bool;
+        auto getPath(std::uint64_t key) const -> std::filesystem::path;
+
+        mutable std::mutex    m_mutex{};
+        std::filesystem::path m_directory;
+        std::optional<bool>   m_supported{};
+        int                   m_hits{0};
+        int                   m_misses{0};
+    };
+
+}// namespace rosa
@@ -25,6 +25,7 @@ namespace rosa {
         glm::vec2 pos{0.F, 0.F};
         Colour colour;
         uint32_t texture_id{0};
+        int texture_layer{-1};
         glm::vec2 texture_rect_pos{0, 0};
         glm::vec2 texture_rect_size{0, 0};
     };
@@ -0,0 +1,136 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/Vertex.hpp>
+#include <graphics/VertexFormat.hpp>
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief A persistent GPU buffer of quads, patched in place
+     *
+     * Each slot holds the four vertices of one quad. Writes go to a CPU-side copy and
+     * widen a dirty range, collectDirty() then hands over only that range so it can be sent
+     * with a single glBufferSubData. Released slots are collapsed to zero area so they can
+     * stay in the draw range until they are reused.
+     *
+     * The CPU side and the GL side are used from different threads when the renderer runs
+     * on its own thread. GL objects are created on the first upload, on whichever thread
+     * owns the context.
+     */
+    class QuadBuffer {
+    public:
+        /**
+         * \brief Create an empty buffer
+         * \param capacity Maximum number of quads, no more than 16 bit indices can address
+         * \param format Layout the quads are uploaded in, to suit the programs drawing them
+         */
+        explicit QuadBuffer(int capacity, VertexFormat format = VertexFormat::Compact);
+        ~QuadBuffer();
+
+        QuadBuffer(const QuadBuffer&)                    = delete;
+        auto operator=(const QuadBuffer&) -> QuadBuffer& = delete;
+        QuadBuffer(QuadBuffer&&)                         = delete;
+        auto operator=(QuadBuffer&&) -> QuadBuffer&      = delete;
+
+        /**
+         * \brief Reserve a slot
+         * \return The slot index, or nothing if the buffer is full
+         */
+        auto allocate() -> std::optional<int>;
+
+        /**
+         * \brief Return a slot for reuse
+         */
+        auto release(int slot) -> void;
+
+        /**
+         * \brief Get the four vertices of a slot for writing, marking them dirty
+         */
+        auto getVertices(int slot) -> Vertex*;
+
+        /**
+         * \brief Append the vertices of the dirty range to a vector and clear it
+         * \return The first quad and number of quads appended
+         */
+        auto collectDirty(std::vector<Vertex>& vertices) -> std::pair<int, int>;
+
+        /**
+         * \brief Write quads into the GPU buffer, creating it if needed
+         * \param first_quad Slot of the first quad
+         * \param quad_count Number of quads
+         * \param vertices Four vertices per quad
+         * \param index_buffer 16 bit quad index buffer, covering every quad drawn by the time it is
+         */
+        auto uploadRange(int first_quad, int quad_count, const Vertex* vertices, unsigned int index_buffer) -> void;
+
+        /**
+         * \brief Draw the first quad_count slots
+         *
+         * The caller is responsible for the shader program and textures.
+         */
+        auto draw(int quad_count) -> void;
+
+        /**
+         * \brief Number of slots currently allocated
+         */
+        auto getCount() const -> int {
+            return m_count;
+        }
+
+        auto getCapacity() const -> int {
+            return m_capacity;
+        }
+
+        /**
+         * \brief One past the highest slot that has been allocated
+         */
+        auto getHighWater() const -> int {
+            return m_high_water;
+        }
+
+        auto getVertexFormat() const -> VertexFormat {
+            return m_format;
+        }
+
+    private:
+        auto markDirty(int slot) -> void;
+
+        int          m_capacity;
+        VertexFormat m_format;
+        unsigned int m_vao{0};
+        unsigned int m_vbo{0};
+
+        std::vector<Vertex> m_vertices;
+        std::vector<int>    m_free_slots{};
+        int                 m_count{0};
+        int                 m_high_water{0};
+
+        int m_dirty_begin{0};
+        int m_dirty_end{0};
+
+        // Packed vertices on their way to the GPU, on the thread that owns the context
+        std::vector<CompactVertex> m_staging{};
+    };
+
+}// namespace rosa
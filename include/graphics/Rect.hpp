@@ -16,6 +16,7 @@
 #pragma once
 
 #include <glm/common.hpp>
+#include <glm/glm.hpp>
 
 namespace rosa {
 
@@ -23,8 +24,57 @@ namespace rosa {
         Rect() = default;
         Rect(glm::vec2 new_pos, glm::vec2 new_size) : position(new_pos), size(new_size) {}
 
+        /**
+         * \brief Check whether two rects overlap, touching edges count
+         */
+        auto intersects(const Rect& other) const -> bool {
+            return position.x <= other.position.x + other.size.x &&
+                   other.position.x <= position.x + size.x &&
+                   position.y <= other.position.y + other.size.y &&
+                   other.position.y <= position.y + size.y;
+        }
+
+        /**
+         * \brief Check whether a point lies within the rect
+         */
+        auto contains(glm::vec2 point) const -> bool {
+            return point.x >= position.x && point.x <= position.x + size.x &&
+                   point.y >= position.y && point.y <= position.y + size.y;
+        }
+
         glm::vec2 position;
         glm::vec2 size;
     };
 
+    /**
+     * \brief Get the axis-aligned bounds of a local-space rect after transformation
+     */
+    inline auto transformRect(const glm::mat4& transform, const Rect& local) -> Rect {
+        glm::vec2 min_corner{0.F};
+        glm::vec2 max_corner{0.F};
+
+        for (int corner = 0; corner < 4; corner++) {
+            glm::vec2 point{local.position.x + ((corner & 1) != 0 ? local.size.x : 0.F),
+                            local.position.y + ((corner & 2) != 0 ? local.size.y : 0.F)};
+            glm::vec2 transformed = transform * glm::vec4(point, 1.F, 1.F);
+
+            if (corner == 0) {
+                min_corner = transformed;
+                max_corner = transformed;
+            } else {
+                min_corner = glm::min(min_corner, transformed);
+                max_corner = glm::max(max_corner, transformed);
+            }
+        }
+
+        return {min_corner, max_corner - min_corner};
+    }
+
+    /**
+     * \brief Get the axis-aligned bounds of a quad centred on the transform origin, as the Renderer draws it
+     */
+    inline auto quadBounds(const glm::mat4& transform, glm::vec2 size) -> Rect {
+        return transformRect(transform, {-size / 2.F, size});
+    }
+
 } // namespace rosa
\ No newline at end of file
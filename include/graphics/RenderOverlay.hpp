@@ -36,6 +36,7 @@ namespace rosa {
         std::array<float, 120> m_textures{0};
         std::array<float, 120> m_shaders{0};
         std::array<float, 120> m_fps{0};
+        std::array<float, 120> m_gpu_times{0};
 
         bool m_visible{false};
     };
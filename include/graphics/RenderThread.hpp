@@ -0,0 +1,101 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <graphics/FramePacket.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace rosa {
+
+    /**
+     * \brief Replays frame packets on a dedicated thread that owns the window's GL context
+     *
+     * Two packets are kept. The game thread records into one while the other is executed,
+     * and submit() blocks until the previous packet has finished, so the render thread is
+     * never more than one frame behind the simulation.
+     *
+     * Anything thrown while executing stops the thread and is rethrown on the game thread by
+     * submit() and finish().
+     */
+    class RenderThread {
+    public:
+        using Executor = std::function<void(FramePacket&)>;
+
+        /**
+         * \brief Start the thread
+         * \param context Window whose context the thread makes current, it must not be current anywhere else
+         * \param executor Called on the render thread for every submitted packet
+         */
+        RenderThread(GLFWwindow* context, Executor executor);
+
+        /**
+         * \brief Execute anything still pending, then join the thread
+         */
+        ~RenderThread();
+
+        RenderThread(const RenderThread&)                    = delete;
+        auto operator=(const RenderThread&) -> RenderThread& = delete;
+        RenderThread(RenderThread&&)                         = delete;
+        auto operator=(RenderThread&&) -> RenderThread&      = delete;
+
+        /**
+         * \brief Get the packet to record the next frame into
+         *
+         * The packet is cleared first. It is never the one being executed.
+         */
+        auto acquire() -> FramePacket&;
+
+        /**
+         * \brief Hand the acquired packet over for execution
+         *
+         * Blocks until the previously submitted packet has been executed.
+         */
+        auto submit() -> void;
+
+        /**
+         * \brief Wait for all submitted packets, then stop the thread and release the context
+         */
+        auto finish() -> void;
+
+    private:
+        auto run() -> void;
+        auto rethrow() -> void;
+
+        GLFWwindow* m_context;
+        Executor    m_executor;
+
+        std::array<FramePacket, 2> m_packets{};
+        std::size_t                m_recording{0};
+        FramePacket*               m_pending{nullptr};
+        bool                       m_in_flight{false};
+        bool                       m_stopping{false};
+        std::exception_ptr         m_error{};
+
+        std::mutex              m_mutex{};
+        std::condition_variable m_condition{};
+        std::thread             m_thread{};
+    };
+
+}// namespace rosa
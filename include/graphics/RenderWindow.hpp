@@ -21,13 +21,18 @@
 
 #include <GLFW/glfw3.h>
 #include <array>
+#include <atomic>
 #include <core/input/Keyboard.hpp>
 #include <fmt/format.h>
 #include <graphics/Colour.hpp>
 #include <graphics/FrameBuffer.hpp>
+#include <graphics/FrameReader.hpp>
+#include <graphics/Rect.hpp>
+#include <graphics/ResolutionScaler.hpp>
 #include <graphics/Sprite.hpp>
 #include <graphics/Texture.hpp>
 #include <graphics/gl.hpp>
+#include <optional>
 #include <stdexcept>
 #include <vector>
 
@@ -45,12 +50,39 @@ namespace rosa {
         }
     };
 
+    /**
+     * \brief Where the window's context comes from
+     */
+    enum class WindowBackend {
+        Native,  // A window on the desktop, hidden or not
+        Headless,// No display at all, using GLFW's null platform with EGL or OSMesa
+    };
+
+    /**
+     * \brief How finished frames reach the screen
+     */
+    enum class PresentMode {
+        Offscreen,// Draw into the FrameBuffer, then resolve and blit it to the window
+        Direct,   // Draw straight into the window's framebuffer unless the FrameBuffer is needed
+    };
+
     /**
      * \brief Provides and interface to the OpenGL context
      *
      * The RenderWindow handles initialising the OpenGL context and window. It also polls for events
      * and pushes them to the event queue. It can handle resizing the window and going into/out of
      * fullscreen.
+     *
+     * A headless window needs no display server. Its context is created through EGL, using
+     * EGL_MESA_platform_surfaceless where available, or OSMesa, so it has no default
+     * framebuffer and frames only exist in the FrameBuffer, see readFrame(). Setting the
+     * ROSA_HEADLESS environment variable makes every window headless, which lets existing
+     * tests and tools run on machines without X. It needs GLFW 3.4, and a process can't mix
+     * headless and native windows.
+     *
+     * Only one RenderWindow per process is supported. Renderer and ResourceManager are singletons
+     * whose GL objects live in the first window's context, and a second window's context would
+     * not see them.
      */
     class RenderWindow {
     public:
@@ -61,8 +93,74 @@ namespace rosa {
          * \param title window title
          * \param msaa MSAA multiplier
          * \param window_hidden Make the window invisible
+         * \param backend Create a native window or a headless context
+         * \param present_mode Initial presentation, a multisampled window is only requested for Direct
          */
-        RenderWindow(int width, int height, const std::string& title = "Rosa Engine", int msaa = 1, bool window_hidden = false);
+        RenderWindow(int width, int height, const std::string& title = "Rosa Engine", int msaa = 1, bool window_hidden = false, WindowBackend backend = WindowBackend::Native, PresentMode present_mode = PresentMode::Offscreen);
+
+        /**
+         * \brief Check whether the window has no display, and so no default framebuffer
+         */
+        auto isHeadless() const -> bool {
+            return m_backend == WindowBackend::Headless;
+        }
+
+        /**
+         * \brief Choose how frames reach the screen
+         *
+         * Direct presentation saves the resolve and two full screen blits per frame. The
+         * FrameBuffer is still used for any frame that needs it: on a headless window, while
+         * the FrameReader has readbacks outstanding, or while setOffscreenRequired() is set,
+         * for example by a post-processing pass. Note readFrame() only sees frames that went
+         * through the FrameBuffer.
+         *
+         * The window's framebuffer is only multisampled when the window was created with
+         * PresentMode::Direct, so switching to it later draws direct frames without MSAA.
+         */
+        auto setPresentMode(PresentMode mode) -> void {
+            m_present_mode = mode;
+        }
+
+        auto getPresentMode() const -> PresentMode {
+            return m_present_mode;
+        }
+
+        /**
+         * \brief Keep frames going through the FrameBuffer in PresentMode::Direct
+         */
+        auto setOffscreenRequired(bool required) -> void {
+            m_offscreen_required = required;
+        }
+
+        /**
+         * \brief Draw the world at a resolution that follows the frame time
+         *
+         * World space is drawn into part of the FrameBuffer, then stretched over the window
+         * before screen space and ImGui are drawn at native resolution. Frames that are read
+         * back or need the FrameBuffer for other reasons are always drawn at full size, as is
+         * everything on a headless window.
+         */
+        auto setDynamicResolution(const DynamicResolution& settings) -> void {
+            m_resolution_scaler.setSettings(settings);
+        }
+
+        auto getResolutionScaler() -> ResolutionScaler& {
+            return m_resolution_scaler;
+        }
+
+        /**
+         * \brief Get the scale to draw the next frame's world space at
+         *
+         * Called on the thread owning the context.
+         */
+        auto getFrameScale() const -> float;
+
+        /**
+         * \brief Check whether the next frame has to be drawn into the FrameBuffer
+         *
+         * Called on the thread owning the context.
+         */
+        auto needsOffscreen() const -> bool;
 
         /**
          * \brief Tracks whether window closure has been requested
@@ -115,11 +213,25 @@ namespace rosa {
          */
         auto getView() const -> glm::mat4;
 
+        /**
+         * \brief Get the world-space rect visible through the current view and projection
+         *
+         * Used to cull world-space renderables, it matches the transform the Renderer applies.
+         */
+        auto getViewRect() const -> Rect;
+
         /**
          * \brief Get the framebuffer
          */
         auto getFrameBuffer() -> FrameBuffer&;
 
+        /**
+         * \brief Get the asynchronous reader for finished frames
+         */
+        auto getFrameReader() -> FrameReader& {
+            return m_frame_reader;
+        }
+
         /**
          * \brief Poll for input events and push to the queue
          */
@@ -136,6 +248,51 @@ namespace rosa {
          */
         auto display(glm::vec2 camera_pos) -> void;
 
+        /**
+         * \brief Calculate the matrices for the next frame
+         *
+         * Makes no GL calls, so it can run on the game thread while another thread renders.
+         *
+         * \param camera_pos World-space position of the active camera
+         * \return The new viewport size, if it has changed since the last call
+         */
+        auto updateView(glm::vec2 camera_pos) -> std::optional<std::array<int, 2>>;
+
+        /**
+         * \brief Apply a viewport change and swap buffers, on the thread owning the context
+         */
+        auto present(std::optional<std::array<int, 2>> viewport) -> void;
+
+        /**
+         * \brief Get the size the framebuffer must be rebuilt at, if the window was resized since the last call
+         */
+        auto takeFramebufferResize() -> std::optional<std::array<int, 2>>;
+
+        /**
+         * \brief Create a hidden context sharing objects with the window, and make it current
+         *
+         * Used while a render thread owns the window's context, so the game thread can
+         * still load textures and compile shaders.
+         */
+        auto createLoaderContext() -> void;
+
+        /**
+         * \brief Destroy the loader context and make the window's context current again
+         */
+        auto destroyLoaderContext() -> void;
+
+        /**
+         * \brief Create a hidden context sharing objects with the window, for a ShaderCompiler worker
+         *
+         * The context is not made current, the worker thread does that itself.
+         */
+        auto createCompilerContext() -> GLFWwindow*;
+
+        /**
+         * \brief Destroy the compiler context, once its worker has stopped
+         */
+        auto destroyCompilerContext() -> void;
+
         /**
          * \brief Get pixel data for the current framebuffer state
          */
@@ -147,13 +304,21 @@ namespace rosa {
         static void callbackResize(GLFWwindow* window, int changed_x, int changed_y);
 
     private:
+        auto createSharedContext(const char* purpose) -> GLFWwindow*;
+
         std::array<int, 2> m_wnd_pos{0, 0};
         std::array<int, 2> m_wnd_size{0, 0};
         std::array<int, 2> m_vp_size{0, 0};
         bool               m_update_viewport = true;
         GLFWwindow*        m_wnd             = nullptr;
+        GLFWwindow*        m_loader          = nullptr;
+        GLFWwindow*        m_compiler        = nullptr;
+        WindowBackend      m_backend         = WindowBackend::Native;
+        int                m_context_api     = GLFW_NATIVE_CONTEXT_API;
         GLFWmonitor*       m_monitor         = nullptr;
 
+        std::optional<std::array<int, 2>> m_framebuffer_resize{};
+
         void resize(int change_x, int change_y);
 
         /**
@@ -167,6 +332,12 @@ namespace rosa {
         glm::mat4 m_view_matrix{0.F};
 
         FrameBuffer m_framebuffer;
+        FrameReader m_frame_reader;
+
+        std::atomic<PresentMode> m_present_mode{PresentMode::Offscreen};
+        std::atomic<bool>        m_offscreen_required{false};
+
+        ResolutionScaler m_resolution_scaler{};
 
         friend class GameManager;
     };
@@ -15,17 +15,33 @@
 
 #pragma once
 
+#include <core/ThreadPool.hpp>
+#include <core/Uuid.hpp>
 #include <cstdint>
+#include <functional>
+#include <graphics/BlendMode.hpp>
+#include <graphics/FramePacket.hpp>
+#include <graphics/GpuTimer.hpp>
+#include <graphics/ProgramCache.hpp>
 #include <graphics/Quad.hpp>
+#include <graphics/QuadBuffer.hpp>
 #include <graphics/RenderWindow.hpp>
+#include <graphics/ShaderCompiler.hpp>
 #include <graphics/ShaderProgram.hpp>
 #include <graphics/Vertex.hpp>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
 
-constexpr int max_vertex_count{10000};
-constexpr int max_quad_count{max_vertex_count / 4};
-constexpr int max_index_count{max_quad_count * 6};
-constexpr int max_textures{32};
+constexpr int default_batch_quads{2500};// Batch capacity to start from, and of each retained buffer
+constexpr int max_batch_quads{65536};   // Adaptive batch capacity never grows past this
+constexpr int max_indexed_quads{16384}; // Most quads a single draw addresses with 16 bit indices
+constexpr int min_parallel_quads{512};
+constexpr int min_parallel_particles{4096};
+constexpr int max_render_layer{4095};
 
 namespace rosa {
 
@@ -37,6 +53,14 @@ namespace rosa {
         int vertices{0};
         int textures{0};
         int shaders{0};
+        int retained{0};        // Quads drawn from retained buffers
+        int retained_updates{0};// Retained quads written this frame
+        int particles{0};       // Particles drawn from emitter batches
+        int static_quads{0};    // Quads drawn from static buffers, such as tilemap chunks
+        int meshes{0};          // Quads drawn from cached meshes, such as text
+        int batch_capacity{0};  // Quads the render queue holds before it has to flush
+
+        GpuTimings gpu{};// From a few frames ago, as queries are read back late
     };
 
     /**
@@ -48,6 +72,88 @@ namespace rosa {
         ShaderProgram* shader_program{};
         bool           screen_space{false};
         float          texture_index{0.F};
+        int            layer{0};// Higher layers draw over lower ones, clamped to +-max_render_layer
+        BlendMode      blend_mode{BlendMode::Transparent};
+    };
+
+    /**
+     * \brief Compact form of a Renderable, as kept in the render queue
+     *
+     * Only the 2D affine part of the transform that places the quad's corners is kept, and
+     * the quad is reduced to what ends up in its vertices. Systems drawing many quads can
+     * build these directly and hand them over in bulk with Renderer::submit(std::span).
+     */
+    struct RenderItem {
+        glm::vec2      axis_x{1.F, 0.F};// Where the transform takes the unit x axis
+        glm::vec2      axis_y{0.F, 1.F};// Where the transform takes the unit y axis
+        glm::vec2      origin{0.F, 0.F};// Where the transform takes the quad's centre
+        glm::vec2      size{0.F, 0.F};
+        glm::vec2      texture_rect_pos{0.F, 0.F};
+        glm::vec2      texture_rect_size{0.F, 0.F};
+        Colour         colour{};
+        ShaderProgram* shader_program{};
+        std::uint32_t  texture_id{0};
+        std::int16_t   texture_layer{-1};
+        std::int16_t   layer{0};// Clamped to +-max_render_layer
+        BlendMode      blend_mode{BlendMode::Transparent};
+        bool           screen_space{false};
+        std::uint8_t   texture_slot{0};// Assigned by the renderer on submission
+
+        /**
+         * \brief Reduce a renderable, keeping the texture index as the slot
+         */
+        static auto fromRenderable(const Renderable& renderable) -> RenderItem;
+    };
+
+    /**
+     * \brief A run of particles drawn as one batch, read straight from structure of arrays storage
+     *
+     * Every particle is a square of its own size centred on its position, in world space,
+     * sharing the texture, texture rect, shader, layer and blend mode of the batch. The
+     * arrays only have to live until submitParticles() returns.
+     */
+    struct ParticleBatch {
+        const float*   position_x{nullptr};
+        const float*   position_y{nullptr};
+        const float*   size{nullptr};
+        const Colour*  colour{nullptr};
+        std::size_t    count{0};
+        Quad           quad{};// Texture and texture rect, size and colour are ignored
+        ShaderProgram* shader_program{};
+        int            layer{0};
+        BlendMode      blend_mode{BlendMode::Transparent};
+    };
+
+    /**
+     * \brief A block of quads laid out once in local space and placed by a transform, such as a line of text
+     *
+     * Vertices come in fours, in the order Renderer::bakeQuad() writes them. Only their
+     * position, texture coordinates and colour are used, the renderer fills in the rest. The
+     * block only has to live until submitMesh() returns.
+     */
+    struct MeshBatch {
+        const Vertex*  vertices{nullptr};
+        std::size_t    count{0};// Quads, so a quarter of the vertices
+        glm::mat4      transform{1.F};
+        Quad           quad{};// Texture of every quad in the block, everything else is ignored
+        ShaderProgram* shader_program{};
+        bool           screen_space{false};
+        int            layer{0};
+        BlendMode      blend_mode{BlendMode::Transparent};
+    };
+
+    /**
+     * \brief Geometry baked into a QuadBuffer once and drawn as it is, such as a tilemap chunk
+     *
+     * Every quad in the buffer shares the texture, shader, layer and blend mode of the batch.
+     * Vertices are written with Renderer::bakeQuad() and only the changed range is uploaded.
+     */
+    struct StaticBatch {
+        QuadBuffer*    buffer{nullptr};
+        Quad           quad{};// Texture of every quad in the buffer, everything else is ignored
+        ShaderProgram* shader_program{};
+        int            layer{0};
+        BlendMode      blend_mode{BlendMode::Transparent};
     };
 
     /**
@@ -55,14 +161,56 @@ namespace rosa {
      *
      * Renderables are submitted to the renderer. On flushing, the renderer will
      * sort renderables by render space. World-space objects will be rendered first,
-     * then screen-space.
+     * then screen-space. Screen-space draws are held back until flushFrame(), so they come
+     * after the world-space draws of every flush in the frame.
      *
-     * The renderables are sorted secondarily by shader, grouping objects which use the
+     * Within each space, opaque and alpha tested renderables are drawn first, front to back
+     * by layer with depth writes on, then transparent renderables back to front by layer,
+     * blended and depth tested against them. Each renderable's layer is written into its
+     * vertices as depth, so shaders must pass it through for opaque rendering to work.
+     * Within a layer, renderables keep their submission order.
+     *
+     * The renderables are sorted after that by shader, grouping objects which use the
      * same shader together to minimise program changes.
      *
-     * There is an upper limit to how many objects will be rendered in a single draw call.
-     * If the limit is reached and additional objects are submitted, the renderer will flush
-     * the render queue before adding the new object.
+     * Regular textures are bound to the first max_textures texture units, array textures
+     * from a TexturePool to the following max_texture_arrays units. Array textures receive
+     * a slot offset by max_textures and the layer is passed alongside in the vertex data.
+     *
+     * The render queue holds up to the batch capacity of renderables. If it is full when
+     * another is submitted, the renderer will flush the queue before adding the new object.
+     * With adaptive batching, a frame that had to flush for lack of room grows the capacity
+     * to fit everything it queued, up to max_batch_quads. Quads are indexed with 16 bit
+     * indices, so batches larger than max_indexed_quads are drawn in slices from a single
+     * upload.
+     *
+     * Renderables submitted with a key are retained. Their vertices live in persistent
+     * buffers grouped by shader and render space, and are only rewritten when the
+     * renderable differs from the previous frame. Retained quads not resubmitted before
+     * flushFrame() are released. Groups are also split by layer and blend mode.
+     *
+     * Opaque static batches are drawn first in world space, after opaque retained
+     * renderables and before anything queued. Their buffers are created by the renderer and
+     * freed on the thread executing packets once nothing else holds them.
+     *
+     * Particle batches and meshes skip the queue. Their vertices are written as they are
+     * submitted, and consecutive batches sharing a program, layer, blend mode and textures
+     * are merged. Each merged run is streamed to the GPU as a single upload.
+     *
+     * Transparent retained groups, static batches and streams are interleaved by layer with
+     * the transparent queue of their render space. Each layer draws its queued renderables
+     * first, then its retained groups, static batches and streams in that order, so a label
+     * lands over a panel sprite on the same layer.
+     *
+     * Vertices for the queue can optionally be built on worker threads, see
+     * setVertexThreads(). Each thread writes a separate range of the vertex buffer, so the
+     * output is identical to building on a single thread.
+     *
+     * Flushing never touches GL directly. Vertices and draws are recorded into a
+     * FramePacket and replayed by execute(). Outside of beginPacket() and endPacket() the
+     * renderer records into its own packet and executes it at the end of every flush, so
+     * callers see the immediate behaviour, screen space aside. Between them, execution is left to the owner of
+     * the packet, which may be another thread.
      */
     class Renderer {
     public:
@@ -79,18 +227,95 @@ namespace rosa {
         /**
          * \brief Push a renderable object to the queue
          */
-        auto submit(Renderable renderable) -> void;
+        auto submit(const Renderable& renderable) -> void;
+
+        /**
+         * \brief Push a run of render items to the queue
+         *
+         * Items are copied straight into the queue, which keeps its capacity between frames,
+         * so the span can be reused scratch storage of the caller.
+         */
+        auto submit(std::span<const RenderItem> items) -> void;
+
+        /**
+         * \brief Keep a renderable in a persistent buffer between frames
+         * \param key Stable identity, such as the owning entity
+         */
+        auto submitRetained(const Uuid& key, Renderable renderable) -> void;
+
+        /**
+         * \brief Write the vertices of a particle batch, to be drawn with the next flush
+         */
+        auto submitParticles(const ParticleBatch& batch) -> void;
+
+        /**
+         * \brief Transform a mesh into place, to be drawn with the next flush
+         *
+         * Meshes are drawn with the transparent pass of their render space, after the queued
+         * renderables on the same layer and before those on higher layers.
+         */
+        auto submitMesh(const MeshBatch& batch) -> void;
+
+        /**
+         * \brief Create a buffer for static geometry
+         * \param capacity Maximum number of quads, up to max_indexed_quads
+         * \param format Vertex format of the program it will be drawn with
+         */
+        auto createStaticBuffer(int capacity, VertexFormat format = VertexFormat::Compact) -> std::shared_ptr<QuadBuffer>;
+
+        /**
+         * \brief Upload the changed quads of a static buffer and draw it with the next flush
+         */
+        auto submitStatic(const StaticBatch& batch) -> void;
+
+        /**
+         * \brief Write the four vertices of a quad in a static buffer, using the quad's own texture
+         */
+        static auto bakeQuad(Vertex* vertices, Renderable renderable) -> void;
 
         /**
          * \brief Explicitly flush the queue
          */
         auto flushBatch() -> void;
 
+        /**
+         * \brief Flush the queue and draw retained renderables, ending the frame
+         *
+         * Retained renderables that weren't submitted since the previous call are released.
+         */
+        auto flushFrame() -> void;
+
+        /**
+         * \brief Record into a packet until endPacket() instead of drawing immediately
+         */
+        auto beginPacket(FramePacket* packet) -> void;
+
+        /**
+         * \brief Go back to drawing at the end of every flush
+         */
+        auto endPacket() -> void;
+
+        /**
+         * \brief Replay a recorded packet, on the thread that owns the GL context
+         * \param begin_screen_space Called where screen space drawing starts, to change render target
+         */
+        auto execute(const FramePacket& packet, const std::function<void()>& begin_screen_space = {}) -> void;
+
         /**
          * \brief Get render stats for the previous frame
          */
         auto getStats() -> RendererStats;
 
+        /**
+         * \brief Get the timer used for GPU timings in the stats
+         *
+         * Work outside the renderer, such as the framebuffer resolve and blits, is timed with
+         * it too. It is driven from the thread that executes packets.
+         */
+        auto getGpuTimer() -> GpuTimer& {
+            return m_gpu_timer;
+        }
+
         /**
          * \brief Zero out all stats counters
          */
@@ -101,34 +326,182 @@ namespace rosa {
          */
         auto updateVp(glm::mat4 view, glm::mat4 projection) -> void;
 
+        /**
+         * \brief Build vertices for large batches on worker threads
+         * \param thread_count Number of workers, 0 builds everything on the calling thread
+         */
+        auto setVertexThreads(std::size_t thread_count) -> void;
+
+        /**
+         * \brief Get the number of vertex building workers, 0 if disabled
+         */
+        auto getVertexThreads() const -> std::size_t;
+
+        /**
+         * \brief Set how many quads the render queue holds before it has to flush
+         * \param quad_count Capacity, clamped to 1-max_batch_quads
+         */
+        auto setBatchCapacity(int quad_count) -> void;
+
+        auto getBatchCapacity() const -> int {
+            return m_batch_capacity;
+        }
+
+        /**
+         * \brief Let the batch capacity grow to fit frames that overflow it, on by default
+         */
+        auto setAdaptiveBatching(bool state) -> void {
+            m_adaptive_batching = state;
+        }
+
+        auto getAdaptiveBatching() const -> bool {
+            return m_adaptive_batching;
+        }
+
         /**
          * \brief Request a shader program be constructed
          *
          * Renderable objects should request a shader program here. If a matching
          * shader already exists, it will be returned - otherwise it will be constructed
-         * and cached.
+         * and cached. Linked programs are also kept in the ProgramCache, so later runs
+         * can skip compilation.
+         *
+         * Once the ShaderCompiler has been started, the program may still be compiling when
+         * it is returned. Renderables using it are handled according to the
+         * PendingShaderPolicy until it is ready.
          */
         auto makeShaderProgram(const Uuid& vertex_shader, const Uuid& fragment_shader) -> ShaderProgram*;
 
+        /**
+         * \brief Get the on-disk cache of linked shader programs
+         */
+        auto getProgramCache() -> ProgramCache& {
+            return m_program_cache;
+        }
+
+        /**
+         * \brief Get the compiler building programs for makeShaderProgram()
+         */
+        auto getShaderCompiler() -> ShaderCompiler& {
+            return m_shader_compiler;
+        }
+
+        /**
+         * \brief Choose whether renderables with a program still compiling are skipped or drawn with the default shaders
+         */
+        auto setPendingShaderPolicy(PendingShaderPolicy policy) -> void {
+            m_pending_shader_policy = policy;
+        }
+
+        auto getPendingShaderPolicy() const -> PendingShaderPolicy {
+            return m_pending_shader_policy;
+        }
+
         Renderer();
         ~Renderer();
 
     private:
-        auto flush(unsigned int shader_program_id, glm::mat4 mvp, int mvp_id) -> void;
+        /**
+         * \brief Hash of the vertex and fragment shader Uuids of a program
+         */
+        struct ShaderPairHash {
+            auto operator()(const std::pair<Uuid, Uuid>& shaders) const -> std::size_t {
+                return std::hash<Uuid>()(shaders.first) * 31 + std::hash<Uuid>()(shaders.second);
+            }
+        };
+
+        /**
+         * \brief Persistent quads sharing a shader, a render space and a set of textures
+         */
+        struct RetainedGroup {
+            ShaderProgram*              shader_program{nullptr};
+            bool                        screen_space{false};
+            int                         layer{0};
+            BlendMode                   blend_mode{BlendMode::Transparent};
+            std::unique_ptr<QuadBuffer> buffer;
+            TextureBindings             bindings{};
+        };
+
+        // Vertices written straight into the packet, from particle batches and meshes
+        struct PendingStream {
+            ShaderProgram*  shader_program{nullptr};
+            bool            screen_space{false};
+            bool            mesh{false};
+            int             layer{0};
+            BlendMode       blend_mode{BlendMode::Transparent};
+            TextureBindings bindings{};
+            std::size_t     first_vertex{0};
+            std::size_t     count{0};
+        };
+
+        struct PendingStatic {
+            QuadBuffer*     buffer{nullptr};
+            ShaderProgram*  shader_program{nullptr};
+            int             layer{0};
+            BlendMode       blend_mode{BlendMode::Transparent};
+            TextureBindings bindings{};
+        };
+
+        struct RetainedQuad {
+            Renderable    renderable;
+            std::size_t   group{0};
+            int           slot{-1};
+            std::uint64_t frame{0};
+        };
+
+        auto flush(const RenderItem& item, std::size_t camera, std::size_t first_quad, std::size_t quad_count) -> void;
+        auto buildVertices(VertexFormat format) -> void;
+        auto bindTextures(const TextureBindings& bindings) -> void;
+        auto createGlObjects() -> void;
+        auto placeRetained(const Renderable& renderable, RetainedQuad& retained) -> void;
+        auto resolveShaderProgram(ShaderProgram*& shader_program) -> bool;
+        auto queueItem(RenderItem item) -> void;
+        auto releaseRetained(RetainedQuad& retained) -> void;
+        auto drawRetained(bool screen_space, bool opaque, int max_layer, std::size_t camera) -> bool;
+        auto appendStream(const PendingStream& stream, const Quad& quad) -> PendingStream&;
+        auto drawStreams(bool screen_space, int max_layer, std::size_t camera) -> bool;
+        auto drawLayered(bool screen_space, int max_layer, std::size_t camera) -> bool;
+        auto drawStatic(bool opaque, int max_layer, std::size_t camera) -> bool;
+        auto getCameraSlot(const glm::mat4& mvp) -> std::size_t;
+        auto ensureIndices(std::size_t quad_count) -> void;
+        auto drawQuads(std::size_t first_quad, std::size_t quad_count) -> void;
+        auto uploadCameras(const FramePacket& packet) -> void;
+        auto nextLayer(bool screen_space, int max_layer) const -> std::optional<int>;
+
+        std::vector<RenderItem> m_items{};
+        int                     m_batch_capacity{default_batch_quads};
+        bool                    m_adaptive_batching{true};
+        std::size_t             m_frame_queued{0};     // Quads queued since the last flushFrame()
+        bool                    m_frame_overflow{false};// Whether the queue filled up since then
+
+        // Recording, on the game thread
+        FramePacket  m_immediate_packet{};
+        FramePacket* m_packet{&m_immediate_packet};
+
+        // Execution, on the thread that owns the context, with a batch and a stream buffer per vertex format
+        std::array<GLuint, vertex_format_count> m_vaos{};
+        std::array<GLuint, vertex_format_count> m_vbos{};
+        std::array<GLuint, vertex_format_count> m_stream_vaos{};
+        std::array<GLuint, vertex_format_count> m_stream_vbos{};
+        GLuint                                  m_ibo{0};
+        std::size_t                             m_index_quads{0};
+        GLuint                                  m_camera_ubo{0};
+        GLsizeiptr                              m_camera_stride{0};
 
-        std::vector<Renderable> m_renderables{};
+        std::vector<unsigned char> m_camera_staging{};
 
-        Vertex* m_vertex_buffer;
-        Vertex* m_vertex_buffer_ptr;
-        GLuint  m_vao;
-        GLuint  m_vbo;
-        GLuint  m_ibo;
+        GpuTimer m_gpu_timer{};
 
-        int                                   m_index_count{0};
-        std::array<uint32_t, max_index_count> m_indices;
+        std::unique_ptr<ThreadPool> m_thread_pool{};
 
-        uint32_t                           m_texture_count{0};
-        std::array<uint32_t, max_textures> m_textures;
+        TextureBindings m_bindings{};
+
+        // Set once opaque geometry has written depth, until it is next cleared
+        bool m_depth_written{false};
+        bool m_screen_depth_written{false};
+
+        // Screen space commands of the frame so far, recorded after the world by flushFrame()
+        std::vector<RenderCommand> m_screen_commands{};
 
         uint32_t m_empty_tex_id{0};
 
@@ -143,7 +516,34 @@ namespace rosa {
         glm::mat4 m_view_matrix;
         glm::mat4 m_projection_matrix;
 
-        std::vector<std::unique_ptr<ShaderProgram>> m_shaders{};
+        std::unordered_map<std::pair<Uuid, Uuid>, std::unique_ptr<ShaderProgram>, ShaderPairHash> m_shaders{};
+        ProgramCache                                                                              m_program_cache{};
+        std::unique_ptr<ShaderProgram>                                                            m_fallback_program{};
+        PendingShaderPolicy                                                                       m_pending_shader_policy{PendingShaderPolicy::Fallback};
+
+        // Declared after the programs and cache it uses, so its worker stops first
+        ShaderCompiler m_shader_compiler{m_program_cache};
+
+        std::vector<RetainedGroup>             m_retained_groups{};
+        std::unordered_map<Uuid, RetainedQuad> m_retained{};
+        std::uint64_t                          m_frame{1};
+        std::vector<std::size_t>               m_retained_pending{};
+        bool                                   m_draw_retained{false};
+        int                                    m_retained_draws{0};
+        int                                    m_retained_updates{0};
+
+        std::vector<PendingStream> m_streams{};
+        int                        m_particle_draws{0};
+        int                        m_mesh_draws{0};
+
+        std::vector<PendingStatic>               m_static{};
+        std::vector<std::shared_ptr<QuadBuffer>> m_static_buffers{};
+        int                                      m_static_draws{0};
+
+        // Static buffers nothing else holds, freed at the end of a later execute()
+        std::vector<std::shared_ptr<QuadBuffer>> m_retiring_buffers{};
+        std::vector<std::shared_ptr<QuadBuffer>> m_released_buffers{};
+        std::mutex                               m_released_mutex{};
 
         static std::unique_ptr<Renderer> s_instance;
     };
@@ -0,0 +1,79 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief Bounds and pacing for dynamic resolution
+     */
+    struct DynamicResolution {
+        bool        enabled{false};
+        float       min_scale{0.5F};       // Smallest fraction of the window size to draw the world at
+        float       max_scale{1.F};        // Clamped to 1, the world is never drawn above native resolution
+        float       target_ms{1000.F / 60.F};
+        float       step{0.1F};            // Change in scale each time the average crosses a threshold
+        std::size_t average_frames{30};    // Frames in the moving average, restarted after every change
+    };
+
+    /**
+     * \brief Picks a resolution scale from a moving average of frame times
+     *
+     * The scale drops by a step when the average is more than 5% over the target, and
+     * rises again when it is more than 20% under, leaving a band in between where it holds
+     * steady. After every change the average starts over, so each decision is made on
+     * frames drawn at the current scale.
+     *
+     * Frame times are added on the thread owning the context while settings may be changed
+     * from any thread.
+     */
+    class ResolutionScaler {
+    public:
+        auto setSettings(const DynamicResolution& settings) -> void;
+        auto getSettings() const -> DynamicResolution;
+
+        /**
+         * \brief Add the time taken by a frame
+         */
+        auto addFrame(float frame_ms) -> void;
+
+        /**
+         * \brief Get the scale to draw the next frame at, 1 when disabled
+         */
+        auto getScale() const -> float;
+
+        /**
+         * \brief Get the average frame time collected at the current scale
+         */
+        auto getAverage() const -> float;
+
+    private:
+        mutable std::mutex m_mutex{};
+        DynamicResolution  m_settings{};
+        float              m_scale{1.F};
+        std::vector<float> m_samples{};
+        std::size_t        m_next{0};
+        float              m_sum{0.F};
+    };
+
+}// namespace rosa
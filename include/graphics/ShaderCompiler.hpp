@@ -0,0 +1,139 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <graphics/ProgramCache.hpp>
+#include <graphics/ShaderProgram.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief How a ShaderCompiler gets programs built
+     */
+    enum class ShaderCompileMode {
+        Synchronous,// Compiled in full when enqueued
+        Parallel,   // Handed to the driver with GL_KHR_parallel_shader_compile and polled each frame
+        Worker,     // Compiled on a thread with its own shared context
+    };
+
+    /**
+     * \brief What the Renderer does with renderables whose program is still compiling
+     */
+    enum class PendingShaderPolicy {
+        Skip,    // Leave them out until the program is ready
+        Fallback,// Draw them with the default shaders meanwhile
+    };
+
+    /**
+     * \brief Builds shader programs without stalling the frame that requested them
+     *
+     * Until start() is called, or when neither parallel compilation nor a worker context is
+     * available, programs are compiled as soon as they are enqueued. Otherwise enqueue()
+     * returns straight away and ShaderProgram::isCompiled() turns true once the program can
+     * be used from any context sharing objects with the one it was built on.
+     *
+     * A program that fails to compile asynchronously is logged rather than thrown, as there
+     * is no caller left to catch it, and stays uncompiled with ShaderProgram::hasFailed() set.
+     */
+    class ShaderCompiler {
+    public:
+        explicit ShaderCompiler(ProgramCache& cache);
+
+        /**
+         * \brief Finish anything still queued, then stop the worker
+         */
+        ~ShaderCompiler();
+
+        ShaderCompiler(const ShaderCompiler&)                    = delete;
+        auto operator=(const ShaderCompiler&) -> ShaderCompiler& = delete;
+        ShaderCompiler(ShaderCompiler&&)                         = delete;
+        auto operator=(ShaderCompiler&&) -> ShaderCompiler&      = delete;
+
+        /**
+         * \brief Check whether the current context supports GL_KHR_parallel_shader_compile
+         */
+        static auto isParallelSupported() -> bool;
+
+        /**
+         * \brief Start compiling asynchronously
+         *
+         * Parallel compilation is used where the driver supports it, otherwise a worker thread
+         * is started on the given context.
+         *
+         * \param worker_context Hidden context sharing objects with the window, or nullptr for none
+         */
+        auto start(GLFWwindow* worker_context) -> void;
+
+        /**
+         * \brief Finish every queued program and return to compiling synchronously
+         */
+        auto stop() -> void;
+
+        /**
+         * \brief Queue a program for compilation
+         *
+         * Must be called on a thread with a current context sharing objects with the window.
+         */
+        auto enqueue(ShaderProgram& program) -> void;
+
+        /**
+         * \brief Finish parallel compiles the driver is done with, call once per frame
+         *
+         * Must be called on the thread that enqueues programs.
+         */
+        auto update() -> void;
+
+        auto getMode() const -> ShaderCompileMode {
+            return m_mode;
+        }
+
+        /**
+         * \brief Number of programs enqueued but not yet compiled
+         */
+        auto getPending() const -> std::size_t;
+
+    private:
+        auto run() -> void;
+        auto complete(ShaderProgram& program) -> bool;
+
+        ProgramCache&     m_cache;
+        ShaderCompileMode m_mode{ShaderCompileMode::Synchronous};
+        GLFWwindow*       m_context{nullptr};
+
+        // Handed to the driver, waiting for the link to complete
+        std::vector<ShaderProgram*> m_linking{};
+
+        // Waiting for, or being compiled by, the worker
+        std::deque<ShaderProgram*> m_queue{};
+        std::size_t                m_in_progress{0};
+        bool                       m_stopping{false};
+
+        mutable std::mutex      m_mutex{};
+        std::condition_variable m_condition{};
+        std::thread             m_thread{};
+    };
+
+}// namespace rosa
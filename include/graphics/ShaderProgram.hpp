@@ -16,7 +16,14 @@
 #pragma once
 
 #include <core/Uuid.hpp>
+#include <graphics/ProgramCache.hpp>
 #include <graphics/Shader.hpp>
+#include <graphics/VertexFormat.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+constexpr unsigned int camera_uniform_binding{0};
 
 namespace rosa {
 
@@ -29,6 +36,14 @@ namespace rosa {
      *
      * On compilation, the shaders will be sent to the GPU and linked into a program
      * which can then be used when rendering.
+     *
+     * A vertex shader receives its matrix from a std140 uniform block named Camera,
+     * holding a single mat4 mvp, which is bound to camera_uniform_binding and shared by
+     * every program. Shaders declaring a plain mvp uniform instead still work, at the
+     * cost of a uniform upload whenever the matrix changes.
+     *
+     * Programs built through a ShaderCompiler may finish compiling later, on another
+     * thread or in the driver. isCompiled() may be polled from any thread.
      */
     class ShaderProgram {
     public:
@@ -54,8 +69,9 @@ namespace rosa {
 
         /**
          * \brief Compile and link the program
+         * \param cache Restore the program from here if possible, and store it after linking
          */
-        auto compile() -> void;
+        auto compile(ProgramCache* cache = nullptr) -> void;
 
         /**
          * \brief Comparison operator so we can sort by ID
@@ -74,12 +90,19 @@ namespace rosa {
         }
 
         /**
-         * \brief Get the uniform ID for the MVP
+         * \brief Get the uniform ID for the MVP, -1 if the shader uses the Camera block
          */
         auto getMvpId() const -> int {
             return m_mvp_id;
         }
 
+        /**
+         * \brief Get the uniform ID for the alpha test threshold, -1 if the shader has none
+         */
+        auto getAlphaCutoffId() const -> int {
+            return m_alpha_cutoff_id;
+        }
+
         /**
          * \brief Check if the program has been compiled
          */
@@ -87,6 +110,32 @@ namespace rosa {
             return m_compiled;
         }
 
+        /**
+         * \brief Check if compiling or linking the program failed
+         */
+        auto hasFailed() const -> bool {
+            return m_failed;
+        }
+
+        /**
+         * \brief Choose the vertex layout the vertex shader reads
+         *
+         * Without this the format is picked once the program is linked: VertexFormat::Compact
+         * when the attribute at location 3 is a uint, as in the default shaders, otherwise
+         * VertexFormat::Full. Compact clamps texture coordinates to 0-1, so shaders that
+         * repeat textures through coordinates outside that range need Full. Set it before the
+         * program is first drawn with, as retained and static buffers keep the format they
+         * were created with.
+         */
+        auto setVertexFormat(VertexFormat format) -> void {
+            m_vertex_format     = format;
+            m_vertex_format_set = true;
+        }
+
+        auto getVertexFormat() const -> VertexFormat {
+            return m_vertex_format;
+        }
+
         /**
          * \brief Get the Uuid of the vertex shader
          */
@@ -102,13 +151,50 @@ namespace rosa {
         }
 
     private:
-        unsigned int m_program_id{0};
-        Shader*      m_vertex_shader{nullptr};
-        Shader*      m_fragment_shader{nullptr};
-        int          m_mvp_id{-1};
-        Uuid         m_vertex_shader_id{};
-        Uuid         m_fragment_shader_id{};
-        bool         m_compiled{false};
+        friend class ShaderCompiler;
+
+        /**
+         * \brief Start compiling and linking without waiting for the driver
+         * \param cache Restore the program from here if possible
+         * \return True if the program was restored from the cache, otherwise finish() must follow
+         */
+        auto begin(ProgramCache* cache = nullptr) -> bool;
+
+        /**
+         * \brief Check whether the driver is done linking, without blocking
+         *
+         * Only meaningful when GL_KHR_parallel_shader_compile is supported.
+         */
+        auto isLinkComplete() const -> bool;
+
+        /**
+         * \brief Wait for the driver, check the results and store the program in the cache
+         *
+         * The program still isn't marked compiled, that is left to the caller.
+         */
+        auto finish(ProgramCache* cache = nullptr) -> void;
+
+        auto findUniforms() -> void;
+
+        /**
+         * \brief Pick the vertex format from the linked attributes, unless one was set
+         */
+        auto detectVertexFormat() -> void;
+
+        unsigned int      m_program_id{0};
+        unsigned int      m_vertex_shader_gl_id{0};
+        unsigned int      m_fragment_shader_gl_id{0};
+        Shader*           m_vertex_shader{nullptr};
+        Shader*           m_fragment_shader{nullptr};
+        int               m_mvp_id{-1};
+        int               m_alpha_cutoff_id{-1};
+        Uuid              m_vertex_shader_id{};
+        Uuid              m_fragment_shader_id{};
+        std::uint64_t     m_cache_key{0};
+        VertexFormat      m_vertex_format{VertexFormat::Compact};
+        bool              m_vertex_format_set{false};
+        std::atomic<bool> m_compiled{false};
+        std::atomic<bool> m_failed{false};
     };
 
 }// namespace rosa
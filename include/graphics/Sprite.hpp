@@ -17,6 +17,7 @@
 
 #include <core/Uuid.hpp>
 #include <cstddef>
+#include <graphics/BlendMode.hpp>
 #include <graphics/Drawable.hpp>
 #include <graphics/Quad.hpp>
 #include <graphics/Rect.hpp>
@@ -47,12 +48,39 @@ namespace rosa {
             auto setScreenSpace(bool screen_space) -> void;
             auto getScreenSpace() -> bool;
 
+            /**
+             * \brief Set the draw layer, higher layers are drawn over lower ones
+             */
+            auto setLayer(int layer) -> void;
+            auto getLayer() const -> int;
+
+            /**
+             * \brief Mark the sprite as opaque or alpha tested to draw it early with depth testing
+             *
+             * Opaque sprites hide whatever is behind them in lower layers without it being
+             * shaded, which suits solid backgrounds and tiles.
+             */
+            auto setBlendMode(BlendMode blend_mode) -> void;
+            auto getBlendMode() const -> BlendMode;
+
             auto setShaders(const Uuid& vertex, const Uuid& fragment) -> void;
             auto getVertexShader() -> const Uuid&;
             auto getFragmentShader() -> const Uuid&;
 
+            /**
+             * \brief Get the world-space bounds of the sprite under a transform
+             *
+             * The result is cached and only recalculated when the transform or size changes.
+             */
+            auto getBounds(const glm::mat4& transform) -> const Rect&;
+
         protected:
             auto draw(glm::mat4 transform) -> void override;
+
+            /**
+             * \brief Draw through the renderer's retained path, keyed by the owning entity
+             */
+            auto drawRetained(const Uuid& key, glm::mat4 transform) -> void;
             Texture* m_texture{nullptr};
 
         private:
@@ -60,8 +88,17 @@ namespace rosa {
             friend class NativeScriptEntity;
             friend class Scene;
 
-            Quad m_quad;
-            bool m_screen_space{false};
+            Quad      m_quad;
+            bool      m_screen_space{false};
+            int       m_layer{0};
+            BlendMode m_blend_mode{BlendMode::Transparent};
+
+            Rect      m_bounds{};
+            glm::mat4 m_bounds_transform{0.F};
+            glm::vec2 m_bounds_size{-1.F, -1.F};
+
+            // Entity the current bounds were last given to the spatial index under
+            Uuid m_indexed_as{};
 
             rosa::Uuid     m_vertex_shader{"00000000-0000-0000-0000-000000000001"};
             rosa::Uuid     m_fragment_shader{"00000000-0000-0000-0000-000000000002"};
@@ -0,0 +1,134 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <core/Resource.hpp>
+#include <glm/glm.hpp>
+#include <graphics/Rect.hpp>
+#include <graphics/Texture.hpp>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace rosa {
+
+    /**
+     * \brief What a clip does after its last frame
+     */
+    enum class AnimationLoop {
+        Once,    // Stop on the last frame
+        Loop,    // Start again from the first frame
+        PingPong,// Play backwards to the first frame, then forwards again
+    };
+
+    struct AnimationFrame {
+        Rect  rect{};        // Region of the texture in pixels
+        float duration{0.1F};// Seconds
+    };
+
+    /**
+     * \brief A frame's texture rect, already normalised and remapped for a texture
+     */
+    struct AnimationFrameUv {
+        glm::vec2 position{0.F};
+        glm::vec2 size{1.F};
+        glm::vec2 pixel_size{0.F};
+    };
+
+    struct AnimationClip {
+        std::string                 name{};
+        AnimationLoop               loop{AnimationLoop::Loop};
+        std::vector<AnimationFrame> frames{};
+    };
+
+    /**
+     * \brief A set of named sprite sheet clips
+     *
+     * Clips are read from a YAML file given by the asset's path, or written inline under
+     * `clips` in the manifest entry itself:
+     *
+     *     clips:
+     *       - name: walk
+     *         loop: ping_pong       # once, loop or ping_pong
+     *         frame_duration: 0.1   # for frames without their own duration
+     *         frames:
+     *           - rect: [0, 0, 32, 32]
+     *             duration: 0.2
+     *           - rect: [32, 0, 32, 32]
+     *       - name: run
+     *         grid: {origin: [0, 32], size: [32, 32], columns: 4, count: 8}
+     *
+     * Frame rects are in pixels. Normalised UVs are worked out once per texture the clips
+     * are used with, so stepping an animation never divides by the texture size.
+     */
+    class SpriteAnimation : public ::rosa::Resource {
+    public:
+        /**
+         * \brief Load clips from a file in an asset pack
+         * \param name Filename relative to it's asset pack
+         * \param uuid Uuid to associate with the animation
+         * \param pack Mount point of the asset pack
+         */
+        SpriteAnimation(const std::string& name, const Uuid& uuid, const std::string& pack);
+
+        /**
+         * \brief Create from clips that are already parsed, such as inline in a manifest
+         */
+        SpriteAnimation(const std::string& name, const Uuid& uuid, const std::string& pack, const YAML::Node& clips);
+
+        /**
+         * \brief Parse a sequence of clips
+         * \throws Exception if a clip is malformed
+         */
+        static auto parseClips(const YAML::Node& clips) -> std::vector<AnimationClip>;
+
+        /**
+         * \brief Find the index of a clip by name
+         */
+        auto findClip(std::string_view name) const -> std::optional<std::size_t>;
+
+        auto getClip(std::size_t index) const -> const AnimationClip& {
+            return m_clips[index].clip;
+        }
+
+        auto getClipCount() const -> std::size_t {
+            return m_clips.size();
+        }
+
+        /**
+         * \brief Get the texture rect of a frame for a particular texture
+         */
+        auto getFrameUv(std::size_t clip, std::size_t frame, const Texture& texture) const -> const AnimationFrameUv&;
+
+    private:
+        struct ClipData {
+            AnimationClip clip{};
+
+            // UVs for the texture they were last worked out for
+            mutable const Texture*                texture{nullptr};
+            mutable std::vector<AnimationFrameUv> uvs{};
+        };
+
+        std::vector<ClipData> m_clips{};
+    };
+
+}// namespace rosa
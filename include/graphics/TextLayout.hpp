@@ -0,0 +1,93 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/Colour.hpp>
+#include <graphics/Quad.hpp>
+#include <graphics/Rect.hpp>
+#include <graphics/Vertex.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief A line of text laid out by a BitmapFont, ready to be submitted as a mesh
+     *
+     * Glyphs are laid out from the origin, with the first one centred on it. Laying out a
+     * new string into an existing layout only regenerates the glyphs from the first changed
+     * character onward, reusing the storage of the previous string.
+     */
+    struct TextLayout {
+        std::string         text{};
+        Colour              colour{};
+        std::vector<Vertex> vertices{};// Four per glyph, as Renderer::bakeQuad() writes them
+        Quad                texture{}; // Font page, for submitting the vertices
+        Rect                bounds{};  // Union of the glyph cells
+    };
+
+    /**
+     * \brief Live layouts of one font, so that identical labels can share their geometry
+     *
+     * Only weak references are kept, a layout drops out once the last label using it lets
+     * go. A layout has to be removed before it is changed and inserted again afterwards,
+     * which reuses its entry instead of allocating a new one.
+     */
+    class TextLayoutCache {
+    public:
+        /**
+         * \brief Find a live layout of a string in a colour
+         */
+        auto find(std::string_view text, Colour colour) const -> std::shared_ptr<TextLayout>;
+
+        /**
+         * \brief Make a layout available to other labels under its current text and colour
+         */
+        auto insert(const std::shared_ptr<TextLayout>& layout) -> void;
+
+        /**
+         * \brief Withdraw a layout, before it is changed in place
+         */
+        auto remove(const TextLayout& layout) -> void;
+
+        /**
+         * \brief Number of entries, including those whose layout has expired but not been swept yet
+         */
+        auto size() const -> std::size_t {
+            return m_layouts.size();
+        }
+
+    private:
+        using LayoutMap = std::unordered_multimap<std::size_t, std::weak_ptr<TextLayout>>;
+
+        // Expired entries are swept once the map grows past this
+        static constexpr std::size_t min_sweep_size{64};
+
+        auto sweep() -> void;
+
+        LayoutMap                         m_layouts{};
+        std::vector<LayoutMap::node_type> m_spare_nodes{};
+        std::size_t                       m_sweep_size{min_sweep_size};
+    };
+
+}// namespace rosa
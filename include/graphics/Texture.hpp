@@ -20,11 +20,16 @@
 #include <core/Resource.hpp>
 #include <core/Uuid.hpp>
 #include <glm/glm.hpp>
+#include <functional>
+#include <graphics/AtlasAllocator.hpp>
 #include <graphics/gl.hpp>
 #include <string>
+#include <vector>
 
 namespace rosa {
 
+    class TextureAtlas;
+
     /**
      * \brief All available texture filter modes for OpenGL
      */
@@ -64,6 +69,13 @@ namespace rosa {
      *
      * It is possible to load a texture with specific TextureFilterParams but it will
      * default to NearestMipMapLinear & Linear
+     *
+     * Textures marked for pooling keep their decoded data until the ResourceManager
+     * places them into a TexturePool layer, after which getOpenGlId() returns the id of
+     * the pool's array texture and getLayer() the layer within it.
+     *
+     * Similarly a small texture may be copied into a TextureAtlas, in which case
+     * getUvOffset() and getUvScale() describe where it sits within the atlas.
      */
     class Texture : public Resource {
     public:
@@ -73,11 +85,16 @@ namespace rosa {
          * \param uuid Uuid to associate with the texture
          * \param pack Mountpoint of the asset pack
          * \param filter_params Filtering parameters
+         * \param defer_upload Keep the decoded data in memory instead of uploading, used for pooling
          */
-        Texture(const std::string& name, const Uuid& uuid, const std::string& pack, TextureFilterParams filter_params = {});
+        Texture(const std::string& name, const Uuid& uuid, const std::string& pack, TextureFilterParams filter_params = {}, bool defer_upload = false);
+
+        ~Texture() override;
 
         /**
          * \brief Get the OpenGL Id of the texture on the GPU
+         *
+         * For pooled textures this is the Id of the pool's array texture.
          */
         auto getOpenGlId() const -> unsigned int {
             return m_texture_id;
@@ -87,10 +104,67 @@ namespace rosa {
             return m_size;
         }
 
+        /**
+         * \brief Get the layer within the texture pool, or -1 if the texture isn't pooled
+         */
+        auto getLayer() const -> int {
+            return m_layer;
+        }
+
+        /**
+         * \brief Get the compressed OpenGL format of the texture
+         */
+        auto getFormat() const -> unsigned int {
+            return m_format;
+        }
+
+        /**
+         * \brief Get the number of mipmap levels in the texture
+         */
+        auto getMipMapCount() const -> unsigned int {
+            return m_mip_map_count;
+        }
+
+        auto getFilterParams() const -> const TextureFilterParams& {
+            return m_filter_params;
+        }
+
+        /**
+         * \brief Get the normalised position of the texture within its atlas, or zero
+         */
+        auto getUvOffset() const -> glm::vec2 {
+            return m_uv_offset;
+        }
+
+        /**
+         * \brief Get the normalised size of the texture within its atlas, or one
+         */
+        auto getUvScale() const -> glm::vec2 {
+            return m_uv_scale;
+        }
+
     private:
-        unsigned int        m_texture_id{0};
-        glm::vec2           m_size{0.F, 0.F};
-        TextureFilterParams m_filter_params;
+        // Upload the decoded data to a texture of our own
+        auto upload() -> void;
+
+        // Call func for each mipmap level in the decoded data
+        auto forEachLevel(const std::function<void(int level, int width, int height, int size, const unsigned char* data)>& func) const -> void;
+
+        unsigned int               m_texture_id{0};
+        glm::vec2                  m_size{0.F, 0.F};
+        TextureFilterParams        m_filter_params;
+        unsigned int               m_format{0};
+        unsigned int               m_mip_map_count{0};
+        int                        m_layer{-1};
+        std::vector<unsigned char> m_pixel_data{};
+        TextureAtlas*              m_atlas{nullptr};
+        AtlasRegion                m_atlas_region{};
+        glm::vec2                  m_uv_offset{0.F, 0.F};
+        glm::vec2                  m_uv_scale{1.F, 1.F};
+
+        friend class ResourceManager;
+        friend class TexturePool;
+        friend class TextureAtlas;
     };
 
 }// namespace rosa
@@ -0,0 +1,137 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/AtlasAllocator.hpp>
+#include <graphics/Texture.hpp>
+
+#include <optional>
+
+namespace rosa {
+
+    /**
+     * \brief Controls which textures are copied into atlases at load time
+     */
+    struct AtlasSettings {
+        bool enabled{false};    // Opt-in, as atlases carry no mipmaps
+        int  atlas_size{2048};  // Width and height of each atlas texture
+        int  max_dimension{512};// Textures larger than this in either axis are left alone
+        int  padding{4};        // Gutter between regions to stop filtering bleed
+    };
+
+    /**
+     * \brief Combined usage figures for all atlases
+     */
+    struct AtlasStats {
+        int   atlases{0};
+        int   regions{0};
+        float fill_ratio{0.F};
+        int   evictions{0};
+    };
+
+    /**
+     * \brief A large texture that smaller textures are copied into at runtime
+     *
+     * Every atlas holds a single format. Block compressed atlases take DDS textures
+     * whose dimensions are a multiple of the 4x4 block size and copy the top mipmap level
+     * directly, uncompressed atlases take RGBA8 pixel data such as BitmapFont pages.
+     *
+     * Once copied in, a texture refers to the atlas by id and carries the UV offset and
+     * scale of its region, so sprites and fonts can remap their coordinates. Releasing
+     * a region, for example when an asset pack is unloaded, counts as an eviction.
+     */
+    class TextureAtlas {
+    public:
+        /**
+         * \brief Create an empty atlas
+         * \param size Width and height in pixels
+         * \param format GL_RGBA8 or one of the S3TC compressed formats
+         * \param filter_params Filtering, mipmap modes are reduced to their base mode
+         * \param padding Gutter to leave between regions
+         */
+        TextureAtlas(int size, unsigned int format, TextureFilterParams filter_params, int padding = 4);
+        ~TextureAtlas();
+
+        TextureAtlas(const TextureAtlas&)                    = delete;
+        auto operator=(const TextureAtlas&) -> TextureAtlas& = delete;
+        TextureAtlas(TextureAtlas&&)                         = delete;
+        auto operator=(TextureAtlas&&) -> TextureAtlas&      = delete;
+
+        /**
+         * \brief Copy a decoded DDS texture into the atlas
+         * \return False if the texture doesn't fit or doesn't match the atlas
+         */
+        auto insert(Texture& texture) -> bool;
+
+        /**
+         * \brief Copy RGBA8 pixel data into the atlas
+         * \return The region used, or nothing if there is no room
+         */
+        auto insert(int width, int height, const unsigned char* pixels) -> std::optional<AtlasRegion>;
+
+        /**
+         * \brief Free a region for reuse
+         */
+        auto release(const AtlasRegion& region) -> void;
+
+        /**
+         * \brief Check whether a texture with this format and filtering belongs here
+         */
+        auto accepts(unsigned int format, TextureFilterParams filter_params) const -> bool;
+
+        /**
+         * \brief Get the normalised position of a region
+         */
+        auto getUvOffset(const AtlasRegion& region) const -> glm::vec2;
+
+        /**
+         * \brief Get the normalised size of a region
+         */
+        auto getUvScale(const AtlasRegion& region) const -> glm::vec2;
+
+        auto getOpenGlId() const -> unsigned int {
+            return m_texture_id;
+        }
+
+        auto getFormat() const -> unsigned int {
+            return m_format;
+        }
+
+        auto getAllocator() const -> const AtlasAllocator& {
+            return m_allocator;
+        }
+
+        /**
+         * \brief Number of regions released since the atlas was created
+         */
+        auto getEvictions() const -> int {
+            return m_evictions;
+        }
+
+    private:
+        auto isCompressed() const -> bool;
+
+        unsigned int        m_texture_id{0};
+        int                 m_size;
+        unsigned int        m_format;
+        TextureFilterParams m_filter_params;
+        AtlasAllocator      m_allocator;
+        int                 m_evictions{0};
+    };
+
+}// namespace rosa
@@ -0,0 +1,120 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+/*! \file */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <graphics/Texture.hpp>
+#include <string>
+
+namespace rosa {
+
+    /**
+     * \brief A texture doesn't match the pool it is being added to
+     *
+     * Throw when the size, format or mipmap count of a texture differs from the pool,
+     * or the pool has no free layers.
+     */
+    class TexturePoolMismatchException : public Exception {
+    public:
+        explicit TexturePoolMismatchException(const std::string& msg)
+            : Exception(msg) {}
+    };
+
+    /**
+     * \brief A GL_TEXTURE_2D_ARRAY holding many same-sized textures
+     *
+     * Textures sharing dimensions, compression format and mipmap count can be packed into
+     * the layers of a single array texture. Sprites using any layer of the pool then share
+     * one texture binding, so a full tile or character set can be drawn without running out
+     * of texture slots.
+     *
+     * Pools are built by the ResourceManager from the `pool` hint in the asset manifest.
+     */
+    class TexturePool {
+    public:
+        /**
+         * \brief Allocate storage for a texture pool
+         * \param name Name of the pool as given in the manifest
+         * \param size Dimensions of every layer
+         * \param format Compressed OpenGL format of every layer
+         * \param mip_map_count Number of mipmap levels in every layer
+         * \param layer_count Number of layers to allocate
+         * \param filter_params Filtering parameters shared by all layers
+         */
+        TexturePool(const std::string& name, glm::vec2 size, unsigned int format, unsigned int mip_map_count, int layer_count, TextureFilterParams filter_params = {});
+        ~TexturePool();
+
+        TexturePool(const TexturePool&)                    = delete;
+        auto operator=(const TexturePool&) -> TexturePool& = delete;
+        TexturePool(TexturePool&&)                         = delete;
+        auto operator=(TexturePool&&) -> TexturePool&      = delete;
+
+        /**
+         * \brief Upload a texture into the next free layer
+         *
+         * The texture will be pointed at the pool and released from CPU memory.
+         *
+         * \return The layer the texture was placed in
+         */
+        auto addLayer(Texture& texture) -> int;
+
+        /**
+         * \brief Get the OpenGL Id of the array texture
+         */
+        auto getOpenGlId() const -> unsigned int {
+            return m_texture_id;
+        }
+
+        /**
+         * \brief Get the name of the pool as given in the manifest
+         */
+        auto getName() const -> const std::string& {
+            return m_name;
+        }
+
+        /**
+         * \brief Get the number of layers currently in use
+         */
+        auto getLayerCount() const -> int {
+            return m_layer_count;
+        }
+
+        /**
+         * \brief Get the number of layers allocated
+         */
+        auto getCapacity() const -> int {
+            return m_capacity;
+        }
+
+        /**
+         * \brief Get the maximum number of layers supported by the driver
+         */
+        static auto getMaxLayers() -> int;
+
+    private:
+        std::string         m_name;
+        unsigned int        m_texture_id{0};
+        glm::vec2           m_size{0.F, 0.F};
+        unsigned int        m_format{0};
+        unsigned int        m_mip_map_count{0};
+        int                 m_capacity{0};
+        int                 m_layer_count{0};
+        TextureFilterParams m_filter_params;
+    };
+
+}// namespace rosa
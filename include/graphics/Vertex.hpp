@@ -34,6 +34,8 @@ namespace rosa {
         glm::vec2 texture_coords{0, 0};
         Colour colour{255, 255, 255, 255};
         float texture_slot{0.F};
+        float texture_layer{0.F};
+        float depth{0.F};
     };
 
 } // namespace rosa
\ No newline at end of file
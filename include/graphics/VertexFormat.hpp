@@ -0,0 +1,127 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*! \file */
+
+#pragma once
+
+#include <graphics/Vertex.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace rosa {
+
+    /**
+     * \brief Layout of the vertices a shader program reads
+     *
+     * The renderer writes batched and streamed quads straight into the format of the program
+     * drawing them. Retained and static buffers keep Vertex on the CPU side and pack the
+     * quads they upload. Attribute locations are the same in both formats, only their types
+     * differ.
+     */
+    enum class VertexFormat : std::uint8_t {
+        Full,   // Vertex as it is, every attribute a float
+        Compact,// CompactVertex, the default
+    };
+
+    constexpr std::size_t vertex_format_count{2};
+
+    /**
+     * \brief A Vertex packed for upload, a little over half the size
+     *
+     * Texture coordinates are 16 bit normalised, the colour is 8 bit normalised RGBA. The
+     * texture slot and layer are integer attributes, read with glVertexAttribIPointer, so
+     * shaders take them as uint.
+     *
+     * Packing clamps texture coordinates to 0-1 without a warning, so coordinates that
+     * repeat a texture come out stretched from its edge. Programs drawing those need
+     * VertexFormat::Full, see ShaderProgram::setVertexFormat.
+     */
+    struct CompactVertex {
+        glm::vec2                    position{0.F, 0.F};
+        std::array<std::uint16_t, 2> texture_coords{};
+        std::array<std::uint8_t, 4>  colour{};
+        float                        depth{0.F};
+        std::uint16_t                texture_layer{0};
+        std::uint8_t                 texture_slot{0};
+        std::uint8_t                 padding{0};
+    };
+
+    namespace detail {
+        // Round to the nearest step of an unsigned normalised integer
+        template<typename T>
+        inline auto normalise(float value) -> T {
+            constexpr auto max = static_cast<float>(std::numeric_limits<T>::max());
+            return static_cast<T>(std::lround(value * max));
+        }
+    }// namespace detail
+
+    /**
+     * \brief Pack texture coordinates for a CompactVertex, clamping them to 0-1
+     */
+    inline auto packTextureCoords(glm::vec2 texture_coords) -> std::array<std::uint16_t, 2> {
+        texture_coords = glm::clamp(texture_coords, glm::vec2(0.F), glm::vec2(1.F));
+        return {detail::normalise<std::uint16_t>(texture_coords.x), detail::normalise<std::uint16_t>(texture_coords.y)};
+    }
+
+    /**
+     * \brief Pack a colour for a CompactVertex, clamping each channel to 0-1
+     */
+    inline auto packColour(const Colour& colour) -> std::array<std::uint8_t, 4> {
+        return {detail::normalise<std::uint8_t>(std::clamp(colour.r, 0.F, 1.F)), detail::normalise<std::uint8_t>(std::clamp(colour.g, 0.F, 1.F)),
+                detail::normalise<std::uint8_t>(std::clamp(colour.b, 0.F, 1.F)), detail::normalise<std::uint8_t>(std::clamp(colour.a, 0.F, 1.F))};
+    }
+
+    /**
+     * \brief Pack a single vertex
+     */
+    inline auto packVertex(const Vertex& vertex) -> CompactVertex {
+        return {.position       = vertex.position,
+                .texture_coords = packTextureCoords(vertex.texture_coords),
+                .colour         = packColour(vertex.colour),
+                .depth          = vertex.depth,
+                .texture_layer  = static_cast<std::uint16_t>(vertex.texture_layer),
+                .texture_slot   = static_cast<std::uint8_t>(vertex.texture_slot)};
+    }
+
+    /**
+     * \brief Size in bytes of one vertex in a format
+     */
+    auto getVertexSize(VertexFormat format) -> std::size_t;
+
+    /**
+     * \brief Set up the attribute layout of a format on the bound vertex array and buffer
+     */
+    auto setupVertexLayout(VertexFormat format) -> void;
+
+    /**
+     * \brief Get vertices ready for upload in a format
+     *
+     * The renderer builds the vertices it streams in their final format, this is for
+     * buffers that keep theirs as Vertex, like QuadBuffer.
+     *
+     * \param staging Holds packed vertices, reused between calls
+     * \return The data to upload, either the vertices themselves or the staging storage
+     */
+    auto stageVertices(const Vertex* vertices, std::size_t count, VertexFormat format, std::vector<CompactVertex>& staging) -> const void*;
+
+}// namespace rosa
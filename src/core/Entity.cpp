@@ -23,6 +23,7 @@
 #include <core/components/SpriteComponent.hpp>
 #include <core/components/TextComponent.hpp>
 #include <core/components/TransformComponent.hpp>
+#include <type_traits>
 
 namespace rosa {
 
@@ -52,6 +53,7 @@ namespace rosa {
         m_parent = parent_id;
         // Set us as a new child
         new_parent.m_children.push_back(getUuid());
+        m_scene->markIndexDirty(getUuid());
         return true;
     }
 
@@ -70,15 +72,28 @@ namespace rosa {
             }
 
             m_parent = Uuid();
+            m_scene->markIndexDirty(getUuid());
             return true;
         }
 
         return false;
     }
 
+    namespace {
+        // Components that can move or resize an entity's bounds in the scene's spatial index
+        template<typename T>
+        constexpr bool affects_bounds = std::is_same_v<T, TransformComponent> || std::is_same_v<T, SpriteComponent> || std::is_same_v<T, TextComponent>;
+    } // namespace
+
     template<typename T>
     auto Entity::getComponent() -> T& {
         assert(hasComponent<T>());
+
+        // The caller may change it, so its bounds are looked at again on the next update
+        if constexpr (affects_bounds<T>) {
+            m_scene->markIndexDirty(getUuid());
+        }
+
         return m_scene->getRegistry().getComponent<T>(getUuid());
     }
 
@@ -107,6 +122,11 @@ namespace rosa {
     template<typename T>
     auto Entity::addComponent() -> T& {
         assert(!hasComponent<T>());
+
+        if constexpr (affects_bounds<T>) {
+            m_scene->markIndexDirty(getUuid());
+        }
+
         return m_scene->getRegistry().addComponent<T>(getUuid());
     }
 
@@ -121,6 +141,11 @@ namespace rosa {
     template<typename T>
     auto Entity::addComponent(T& data) -> T& {
         assert(!hasComponent<T>());
+
+        if constexpr (affects_bounds<T>) {
+            m_scene->markIndexDirty(getUuid());
+        }
+
         return m_scene->getRegistry().addComponent<T>(getUuid(), data);
     }
 
@@ -136,6 +161,12 @@ namespace rosa {
     auto Entity::removeComponent() -> bool {
         if (hasComponent<T>()) {
             m_scene->getRegistry().removeComponent<T>(getUuid());
+
+            // The entity's bounds no longer include the removed component
+            if constexpr (std::is_same_v<T, SpriteComponent> || std::is_same_v<T, TextComponent>) {
+                m_scene->unindexEntity(getUuid());
+            }
+
             return true;
         }
 
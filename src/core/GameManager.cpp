@@ -14,11 +14,15 @@
  */
 
 #include <ProfilerSections.hpp>
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <core/EventManager.hpp>
 #include <core/GameManager.hpp>
 #include <core/Scene.hpp>
 #include <core/SceneSerialiser.hpp>
+#include <graphics/GlState.hpp>
+#include <graphics/RenderThread.hpp>
 #include <memory>
 #include <spdlog/spdlog.h>
 #include <tracy/Tracy.hpp>
@@ -27,7 +31,7 @@
 namespace rosa {
 
     GameManager::GameManager(int window_width, int window_height, const std::string &window_title, int msaa,
-                             bool window_hidden) {
+                             bool window_hidden, WindowBackend backend, PresentMode present_mode) {
 
 #if (DEBUG)
         spdlog::set_level(spdlog::level::debug);
@@ -36,7 +40,7 @@ namespace rosa {
 #endif
 
         try {
-            m_render_window = std::make_unique<RenderWindow>(window_width, window_height, window_title, msaa, window_hidden);
+            m_render_window = std::make_unique<RenderWindow>(window_width, window_height, window_title, msaa, window_hidden, backend, present_mode);
 
             spdlog::info("Initialising resource management");
             [[maybe_unused]]auto &res = ResourceManager::getInstance();
@@ -67,6 +71,21 @@ namespace rosa {
         ImGui::DestroyContext();
         Renderer::shutdown();
         ResourceManager::shutdown();
+
+        // The shader compiler has stopped with the renderer, so its context can go
+        m_render_window->destroyCompilerContext();
+    }
+
+    auto GameManager::setAsyncShaders(bool enabled) -> void {
+        auto& compiler = Renderer::getInstance().getShaderCompiler();
+
+        compiler.stop();
+        m_render_window->destroyCompilerContext();
+
+        if (enabled) {
+            // A worker context is only needed when the driver can't compile in parallel itself
+            compiler.start(ShaderCompiler::isParallelSupported() ? nullptr : m_render_window->createCompilerContext());
+        }
     }
 
     auto GameManager::addScene(const std::string &key, std::unique_ptr<Scene> scene) -> bool {
@@ -79,6 +98,14 @@ namespace rosa {
 
         m_frame_count = 0;
 
+        std::unique_ptr<RenderThread> render_thread{};
+        if (m_use_render_thread) {
+            m_render_window->createLoaderContext();
+            render_thread = std::make_unique<RenderThread>(m_render_window->getGlWindowPtr(), [this](FramePacket& packet) {
+                executeFrame(packet);
+            });
+        }
+
         while (m_render_window->isOpen()) {
 
             ZoneScopedN("FrameLoop");
@@ -131,35 +158,162 @@ namespace rosa {
             {
                 ZoneScopedNC("Render", profiler::detail::tracy_colour_render);
 
-                m_render_window->getFrameBuffer().bind();
-                m_render_window->clearWindow(m_clear_colour);
+                auto& packet = render_thread ? render_thread->acquire() : m_frame_packet;
+                auto  size   = m_render_window->getWindowSize();
+
+                packet.clear_colour     = m_clear_colour;
+                packet.window_size      = {static_cast<int>(size.x), static_cast<int>(size.y)};
+                packet.framebuffer_size = m_render_window->takeFramebufferResize();
+
+                Renderer::getInstance().beginPacket(&packet);
                 m_current_scene->render();
+                Renderer::getInstance().endPacket();
 
                 {
                     ZoneScopedNC("Render::ImGui", profiler::detail::tracy_colour_imgui);
                     ImGui::Render();
-                    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-                }
 
-                m_render_window->getFrameBuffer().update();
-                m_render_window->getFrameBuffer().unbind();
+                    // The render thread draws after the next ImGui frame has started
+                    packet.imgui.capture(ImGui::GetDrawData(), render_thread != nullptr);
+                }
 
-                auto size = m_render_window->getWindowSize();
-                assert(m_render_window->getFrameBuffer().getWidth() == size.x);
-                m_render_window->getFrameBuffer().blitColorTo(0, 0, 0, static_cast<int>(size.x), static_cast<int>(size.y));
-                m_render_window->getFrameBuffer().blitDepthTo(0, 0, 0, static_cast<int>(size.x), static_cast<int>(size.y));
+                packet.viewport = m_render_window->updateView(m_current_scene->m_active_camera_pos);
 
-                m_render_window->display(m_current_scene->m_active_camera_pos);
+                if (render_thread) {
+                    // Make this frame's uploads from the loader context visible to the render thread
+                    packet.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                    glFlush();
+                    render_thread->submit();
+                } else {
+                    executeFrame(packet);
+                    packet.clear();
+                }
             }
 
 #ifdef TRACY_ENABLE
             FrameMark;
 #endif
 
-            TracyGpuCollect
-
             m_frame_count++;
         }
+
+        if (render_thread) {
+            render_thread->finish();
+            render_thread.reset();
+            m_render_window->destroyLoaderContext();
+        }
+
+        // Hand over whatever is still in flight
+        m_render_window->getFrameReader().finish();
+    }
+
+    auto GameManager::executeFrame(FramePacket& packet) -> void {
+        ZoneScopedNC("Render:ExecuteFrame", profiler::detail::tracy_colour_render);
+
+        auto& framebuffer = m_render_window->getFrameBuffer();
+        auto& gpu_timer   = Renderer::getInstance().getGpuTimer();
+
+        if (packet.framebuffer_size) {
+            framebuffer.init((*packet.framebuffer_size)[0], (*packet.framebuffer_size)[1]);
+        }
+
+        if (packet.fence != nullptr) {
+            glWaitSync(packet.fence, 0, GL_TIMEOUT_IGNORED);
+            glDeleteSync(packet.fence);
+            packet.fence = nullptr;
+        }
+
+        // Prefer GPU time, which isn't capped by vsync, and fall back to the frame interval
+        auto now = std::chrono::steady_clock::now();
+        if (m_last_execute != std::chrono::steady_clock::time_point{}) {
+            auto gpu_ms      = gpu_timer.getTimings().frame_ms;
+            auto interval_ms = std::chrono::duration<float, std::milli>(now - m_last_execute).count();
+            m_render_window->getResolutionScaler().addFrame(gpu_ms > 0.F ? gpu_ms : interval_ms);
+        }
+        m_last_execute = now;
+
+        // World space goes into part of the FrameBuffer, then is stretched over the window
+        auto scale  = m_render_window->getFrameScale();
+        auto scaled = scale < 1.F;
+
+        // In direct presentation the window's own framebuffer is drawn to whenever possible
+        auto offscreen = m_render_window->needsOffscreen();
+        if (offscreen || scaled) {
+            framebuffer.bind();
+        } else {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        m_render_window->clearWindow(packet.clear_colour);
+
+        std::array<GLint, 4> viewport{};
+        auto                 scaled_width  = std::max(1, static_cast<int>(static_cast<float>(framebuffer.getWidth()) * scale));
+        auto                 scaled_height = std::max(1, static_cast<int>(static_cast<float>(framebuffer.getHeight()) * scale));
+        bool                 upscaled{!scaled};
+
+        if (scaled) {
+            glGetIntegerv(GL_VIEWPORT, viewport.data());
+            glViewport(0, 0, scaled_width, scaled_height);
+        }
+
+        auto upscale = [&]() {
+            if (upscaled) {
+                return;
+            }
+            upscaled = true;
+
+            {
+                GpuTimerZone gpu_zone(gpu_timer, GpuPass::Blit);
+
+                auto [width, height] = packet.window_size;
+                framebuffer.upscaleTo(0, scaled_width, scaled_height, width, height);
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+            // Screen space starts on fresh depth in the window
+            GlState::current().setDepthMask(true);
+            glClear(GL_DEPTH_BUFFER_BIT);
+        };
+
+        Renderer::getInstance().execute(packet, upscale);
+
+        // Nothing was drawn in screen space
+        upscale();
+
+        if (auto* draw_data = packet.imgui.getDrawData()) {
+            ZoneScopedNC("Render::ImGui", profiler::detail::tracy_colour_imgui);
+            GpuTimerZone gpu_zone(gpu_timer, GpuPass::ImGui);
+            ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+        }
+
+        // A scaled frame has already been stretched into the window
+        if (offscreen && !scaled) {
+            {
+                GpuTimerZone gpu_zone(gpu_timer, GpuPass::Resolve);
+                framebuffer.update();
+            }
+
+            m_render_window->getFrameReader().capture(framebuffer);
+
+            framebuffer.unbind();
+        }
+
+        // A headless window has no default framebuffer to copy to
+        if (offscreen && !scaled && !m_render_window->isHeadless()) {
+            GpuTimerZone gpu_zone(gpu_timer, GpuPass::Blit);
+
+            auto [width, height] = packet.window_size;
+            assert(framebuffer.getWidth() == width);
+            framebuffer.blitColorTo(0, 0, 0, width, height);
+            framebuffer.blitDepthTo(0, 0, 0, width, height);
+        }
+
+        m_render_window->present(packet.viewport);
+        gpu_timer.endFrame();
+
+        TracyGpuCollect
     }
 
     auto GameManager::changeScene(const std::string &key) -> bool {
@@ -26,8 +26,11 @@
 #include <fmt/format.h>
 #include <graphics/BitmapFont.hpp>
 #include <graphics/Shader.hpp>
+#include <graphics/SpriteAnimation.hpp>
+#include <map>
 #include <physfs.h>
 #include <string>
+#include <tuple>
 
 #if defined(_WIN32)
 #include <stdlib.h>
@@ -99,6 +102,8 @@ namespace rosa {
         for (const auto& asset: manifest["assets"]) {
             load_resource(path, asset);
         }
+
+        build_texture_pools(path);
     }
 
     auto ResourceManager::unregisterAssetPack(const std::string& path) -> void {
@@ -116,6 +121,8 @@ namespace rosa {
             }
         }
 
+        m_texture_pools.erase(path);
+
         if (PHYSFS_unmount(real_path.c_str()) == 0) {
             auto error = PHYSFS_getLastErrorCode();
 
@@ -145,12 +152,23 @@ namespace rosa {
         }
     }
 
+    auto ResourceManager::getTexturePools(const std::string& path) const -> const std::vector<std::unique_ptr<TexturePool>>& {
+        static const std::vector<std::unique_ptr<TexturePool>> no_pools{};
+
+        auto pools = m_texture_pools.find(path);
+        if (pools == m_texture_pools.end()) {
+            return no_pools;
+        }
+
+        return pools->second;
+    }
+
     std::unique_ptr<ResourceManager> ResourceManager::s_instance{nullptr};
 
     auto ResourceManager::load_resource(const std::string& path, const YAML::Node& node) -> void {
         auto uuid     = node["uuid"].as<Uuid>();
         auto type     = static_cast<ResourceType>(node["type"].as<int>());
-        auto filename = node["path"].as<std::string>();
+        auto filename = node["path"] ? node["path"].as<std::string>() : std::string{};
 
         switch (type) {
             case ResourceType::ResourceTexture: {
@@ -165,10 +183,33 @@ namespace rosa {
                     }
                 }
 
+                std::string pool{};
+                if (node["pool"]) {
+                    pool = node["pool"].as<std::string>();
+                }
+
                 spdlog::debug(
                         "ResourceManager: Loading texture {} from /{} (filter min: {:#x}, filter mag: {:#x})",
                         uuid.toString(), filename, static_cast<int>(params.minify), static_cast<int>(params.magnify));
-                m_resources[uuid] = std::make_unique<Texture>(filename, uuid, path, params);
+                auto texture      = std::make_unique<Texture>(filename, uuid, path, params, true);
+                auto texture_ptr  = texture.get();
+                m_resources[uuid] = std::move(texture);
+
+                if (!pool.empty()) {
+                    m_pending_pool_textures.emplace_back(pool, texture_ptr);
+                    break;
+                }
+
+                auto size = texture_ptr->getSize();
+                if (m_atlas_settings.enabled &&
+                    size.x <= static_cast<float>(m_atlas_settings.max_dimension) &&
+                    size.y <= static_cast<float>(m_atlas_settings.max_dimension) &&
+                    insert_into_atlas(texture_ptr->getFormat(), params, [texture_ptr](TextureAtlas& atlas) { return atlas.insert(*texture_ptr); })) {
+                    spdlog::debug("ResourceManager: Copied texture {} into an atlas", uuid.toString());
+                    break;
+                }
+
+                texture_ptr->upload();
             } break;
             case ResourceType::ResourceVertexShader:
                 spdlog::debug("ResourceManager: Loading vertex shader {} from /{}", uuid.toString(), filename);
@@ -187,11 +228,123 @@ namespace rosa {
                 spdlog::debug("ResourceManager: Loading audio track {} from /{}", uuid.toString(), filename);
                 m_resources[uuid] = std::make_unique<AudioFile>(filename, uuid, path);
                 break;
-            case ResourceType::ResourceFont:
+            case ResourceType::ResourceFont: {
                 spdlog::debug("ResourceManager: Loading font {} from /{}", uuid.toString(), filename);
-                m_resources[uuid] = std::make_unique<BitmapFont>(filename, uuid, path);
+                auto font         = std::make_unique<BitmapFont>(filename, uuid, path, true);
+                auto font_ptr     = font.get();
+                m_resources[uuid] = std::move(font);
+
+                // Glyph pages are drawn at native resolution, so share an unfiltered atlas
+                if (m_atlas_settings.enabled &&
+                    font_ptr->m_image_x <= m_atlas_settings.max_dimension &&
+                    font_ptr->m_image_y <= m_atlas_settings.max_dimension &&
+                    insert_into_atlas(GL_RGBA8, {TextureFilterMode::Nearest, TextureFilterMode::Nearest}, [font_ptr](TextureAtlas& atlas) { return font_ptr->insertIntoAtlas(atlas); })) {
+                    spdlog::debug("ResourceManager: Copied font {} into an atlas", uuid.toString());
+                    break;
+                }
+
+                font_ptr->upload();
+            } break;
+            case ResourceType::ResourceAnimation:
+                if (node["clips"]) {
+                    spdlog::debug("ResourceManager: Loading inline sprite animation {}", uuid.toString());
+                    m_resources[uuid] = std::make_unique<SpriteAnimation>(filename, uuid, path, node["clips"]);
+                    break;
+                }
+
+                spdlog::debug("ResourceManager: Loading sprite animation {} from /{}", uuid.toString(), filename);
+                m_resources[uuid] = std::make_unique<SpriteAnimation>(filename, uuid, path);
                 break;
         }
     }
 
-}// namespace rosa
\ No newline at end of file
+    auto ResourceManager::build_texture_pools(const std::string& path) -> void {
+        ZoneScopedN("Assets:BuildTexturePools");
+
+        // Only textures with identical storage can share an array texture, so a named pool
+        // is split further by size, format, mipmap count and filtering.
+        using PoolKey = std::tuple<std::string, float, float, unsigned int, unsigned int, int, int>;
+        std::map<PoolKey, std::vector<Texture*>> groups{};
+
+        for (auto& [pool, texture]: m_pending_pool_textures) {
+            groups[{pool,
+                    texture->getSize().x, texture->getSize().y,
+                    texture->getFormat(), texture->getMipMapCount(),
+                    static_cast<int>(texture->getFilterParams().minify),
+                    static_cast<int>(texture->getFilterParams().magnify)}]
+                    .push_back(texture);
+        }
+        m_pending_pool_textures.clear();
+
+        auto max_layers = TexturePool::getMaxLayers();
+
+        for (auto& [key, textures]: groups) {
+            // Nothing to gain from an array of one
+            if (textures.size() == 1) {
+                spdlog::debug("ResourceManager: Texture {} is alone in pool {}, uploading standalone", textures[0]->getName(), std::get<0>(key));
+                textures[0]->upload();
+                continue;
+            }
+
+            for (std::size_t first = 0; first < textures.size(); first += static_cast<std::size_t>(max_layers)) {
+                auto count = std::min(textures.size() - first, static_cast<std::size_t>(max_layers));
+                auto pool  = std::make_unique<TexturePool>(
+                        std::get<0>(key), textures[first]->getSize(), textures[first]->getFormat(),
+                        textures[first]->getMipMapCount(), static_cast<int>(count), textures[first]->getFilterParams());
+
+                for (std::size_t i = first; i < first + count; i++) {
+                    pool->addLayer(*textures[i]);
+                }
+
+                spdlog::debug("ResourceManager: Built texture pool {} with {} layers", pool->getName(), pool->getLayerCount());
+                m_texture_pools[path].push_back(std::move(pool));
+            }
+        }
+    }
+
+    auto ResourceManager::setAtlasSettings(const AtlasSettings& settings) -> void {
+        m_atlas_settings = settings;
+    }
+
+    auto ResourceManager::getAtlasSettings() const -> const AtlasSettings& {
+        return m_atlas_settings;
+    }
+
+    auto ResourceManager::getAtlasStats() const -> AtlasStats {
+        AtlasStats stats{};
+        float      total_fill{0.F};
+
+        for (const auto& atlas: m_texture_atlases) {
+            stats.atlases++;
+            stats.regions += atlas->getAllocator().getAllocationCount();
+            stats.evictions += atlas->getEvictions();
+            total_fill += atlas->getAllocator().getFillRatio();
+        }
+
+        if (stats.atlases > 0) {
+            stats.fill_ratio = total_fill / static_cast<float>(stats.atlases);
+        }
+
+        return stats;
+    }
+
+    auto ResourceManager::insert_into_atlas(unsigned int format, TextureFilterParams filter_params, const std::function<bool(TextureAtlas&)>& insert) -> bool {
+        ZoneScopedN("Assets:InsertIntoAtlas");
+
+        for (auto& atlas: m_texture_atlases) {
+            if (atlas->accepts(format, filter_params) && insert(*atlas)) {
+                return true;
+            }
+        }
+
+        // Everything suitable is full, start another
+        auto atlas = std::make_unique<TextureAtlas>(m_atlas_settings.atlas_size, format, filter_params, m_atlas_settings.padding);
+        if (!insert(*atlas)) {
+            return false;
+        }
+
+        m_texture_atlases.push_back(std::move(atlas));
+        return true;
+    }
+
+}// namespace rosa
@@ -26,12 +26,16 @@
 #include <core/components/CameraComponent.hpp>
 #include <core/components/MusicPlayerComponent.hpp>
 #include <core/components/NativeScriptComponent.hpp>
+#include <core/components/ParticleEmitterComponent.hpp>
 #include <core/components/SoundPlayerComponent.hpp>
+#include <core/components/SpriteAnimationComponent.hpp>
 #include <core/components/SpriteComponent.hpp>
 #include <core/components/TextComponent.hpp>
+#include <core/components/TilemapComponent.hpp>
 #include <core/components/TransformComponent.hpp>
 #include <functional>
 #include <stack>
+#include <type_traits>
 
 #include <ProfilerSections.hpp>
 #include <core/Entity.hpp>
@@ -50,6 +54,9 @@ namespace rosa {
         m_registry.registerComponent<TextComponent>();
         m_registry.registerComponent<SoundPlayerComponent>();
         m_registry.registerComponent<MusicPlayerComponent>();
+        m_registry.registerComponent<SpriteAnimationComponent>();
+        m_registry.registerComponent<ParticleEmitterComponent>();
+        m_registry.registerComponent<TilemapComponent>();
     }
 
     auto Scene::createEntity() -> Entity& {
@@ -179,6 +186,36 @@ namespace rosa {
             }
         }
 
+        {
+            ZoneScopedNC("Updates:SpriteAnimation", profiler::detail::tracy_colour_updates);
+
+            // Step every animation in one pass over the packed array, sprites are only looked up
+            // when their frame actually changes
+            auto& animations = m_registry.getComponents<SpriteAnimationComponent>();
+            for (std::size_t i{0}; i < animations.size(); i++) {
+                auto& animation = animations.getAtIndex(i);
+                if (!animation.step(delta_time)) {
+                    continue;
+                }
+
+                const auto& uuid = animations.getUuidAtIndex(i);
+                if (!m_registry.hasComponent<SpriteComponent>(uuid)) {
+                    continue;
+                }
+
+                auto& sprite = m_registry.getComponent<SpriteComponent>(uuid);
+                if (sprite.m_texture == nullptr || animation.getClip() == nullptr) {
+                    continue;
+                }
+
+                const auto& frame               = animation.getFrameUv(*sprite.m_texture);
+                sprite.m_quad.texture_rect_pos  = frame.position;
+                sprite.m_quad.texture_rect_size = frame.size;
+                sprite.m_quad.size              = frame.pixel_size;
+                markIndexDirty(uuid);
+            }
+        }
+
         {
             ZoneScopedNC("Updates:TransformUpdate", profiler::detail::tracy_colour_updates);
 
@@ -222,6 +259,9 @@ namespace rosa {
                         nsc.on_destroy_function(nsc.instance);
                         nsc.destroy_instance_function();
                     }
+                    m_spatial_index.remove(entity.getUuid());
+                    m_index_pending.erase(entity.getUuid());
+                    m_screen_space_dirty |= m_screen_space_set.erase(entity.getUuid()) != 0;
                     m_registry.removeEntity(entity.getUuid());
                 }
             }
@@ -246,7 +286,152 @@ namespace rosa {
                 }
             }
         }
-        
+
+        {
+            ZoneScopedNC("Updates:Particles", profiler::detail::tracy_colour_updates);
+
+            // Emitters spawn from where their entity ended up this frame
+            auto& emitters = m_registry.getComponents<ParticleEmitterComponent>();
+            for (std::size_t i{0}; i < emitters.size(); i++) {
+                const auto& uuid = emitters.getUuidAtIndex(i);
+                if (!m_registry.getEntity(uuid).isActive()) {
+                    continue;
+                }
+
+                auto  global_transform = m_registry.getComponent<TransformComponent>(uuid).getGlobalTransform();
+                auto& emitter          = emitters.getAtIndex(i);
+                emitter.update(delta_time, {global_transform[3].x, global_transform[3].y}, m_particle_pool.get());
+            }
+        }
+
+        updateSpatialIndex();
+    }
+
+    auto Scene::setParticleThreads(std::size_t thread_count) -> void {
+        if (thread_count == 0) {
+            m_particle_pool.reset();
+            return;
+        }
+
+        if (!m_particle_pool || m_particle_pool->getThreadCount() != thread_count) {
+            m_particle_pool = std::make_unique<ThreadPool>(thread_count);
+        }
+    }
+
+    auto Scene::markIndexDirty(const Uuid& uuid) -> void {
+        if (m_index_pending.insert(uuid).second) {
+            m_index_dirty.push_back(uuid);
+        }
+    }
+
+    auto Scene::updateSpatialIndex() -> void {
+        ZoneScopedNC("Updates:SpatialIndex", profiler::detail::tracy_colour_updates);
+
+        // Only entities marked since the last update are looked at. A moved parent moves its
+        // children too, so they are appended as each entity is visited. Entries whose entity was
+        // deleted in the meantime are no longer pending and are skipped.
+        for (std::size_t i{0}; i < m_index_dirty.size(); i++) {
+            const Uuid uuid = m_index_dirty[i];
+            if (m_index_pending.erase(uuid) == 0) {
+                continue;
+            }
+
+            auto& entity = m_registry.getEntity(uuid);
+            for (const auto& child: entity.getChildren()) {
+                markIndexDirty(child);
+            }
+
+            const bool has_sprite = m_registry.hasComponent<SpriteComponent>(uuid);
+            const bool has_text   = m_registry.hasComponent<TextComponent>(uuid);
+            if (!has_sprite && !has_text) {
+                continue;
+            }
+
+            auto global_transform = m_registry.getComponent<TransformComponent>(uuid).getGlobalTransform();
+
+            std::optional<Rect> bounds{};
+            bool                changed{false};
+            bool                screen_space{false};
+
+            // Only components whose cached bounds were recalculated, or which have changed space,
+            // need to go back into the index
+            auto accumulate = [&](auto& component) {
+                if (component.getScreenSpace()) {
+                    screen_space = true;
+                    changed |= component.m_indexed_as == uuid;
+                    component.m_indexed_as = Uuid();
+                    return;
+                }
+
+                const auto& component_bounds = component.getBounds(global_transform);
+                changed |= component.m_indexed_as != uuid;
+                component.m_indexed_as = uuid;
+
+                if (!bounds) {
+                    bounds = component_bounds;
+                    return;
+                }
+
+                auto min_corner = glm::min(bounds->position, component_bounds.position);
+                auto max_corner = glm::max(bounds->position + bounds->size, component_bounds.position + component_bounds.size);
+                bounds          = Rect{min_corner, max_corner - min_corner};
+            };
+
+            if (has_sprite) {
+                accumulate(m_registry.getComponent<SpriteComponent>(uuid));
+            }
+
+            if (has_text) {
+                accumulate(m_registry.getComponent<TextComponent>(uuid));
+            }
+
+            if (screen_space) {
+                m_screen_space_dirty |= m_screen_space_set.insert(uuid).second;
+            } else {
+                m_screen_space_dirty |= m_screen_space_set.erase(uuid) != 0;
+            }
+
+            if (!changed) {
+                continue;
+            }
+
+            if (bounds) {
+                m_spatial_index.update(uuid, *bounds);
+            } else {
+                m_spatial_index.remove(uuid);
+            }
+        }
+
+        m_index_dirty.clear();
+        m_spatial_index.commit();
+
+        // Screen-space renderables draw in registry order, so the list is only rebuilt when an
+        // entity joins or leaves it
+        if (m_screen_space_dirty) {
+            m_screen_space_entities.clear();
+            for (auto& entity: ecs::RegistryView<Entity, SpriteComponent, TextComponent>(m_registry)) {
+                if (m_screen_space_set.contains(entity.getUuid())) {
+                    m_screen_space_entities.push_back(entity.getUuid());
+                }
+            }
+            m_screen_space_dirty = false;
+        }
+    }
+
+    auto Scene::unindexEntity(const Uuid& uuid) -> void {
+        m_spatial_index.remove(uuid);
+        m_screen_space_dirty |= m_screen_space_set.erase(uuid) != 0;
+
+        // Whatever is left goes back in with its own bounds on the next update
+        if (m_registry.hasComponent<SpriteComponent>(uuid)) {
+            m_registry.getComponent<SpriteComponent>(uuid).m_indexed_as = Uuid();
+        }
+
+        if (m_registry.hasComponent<TextComponent>(uuid)) {
+            m_registry.getComponent<TextComponent>(uuid).m_indexed_as = Uuid();
+        }
+
+        markIndexDirty(uuid);
     }
 
     auto Scene::render() -> void {
@@ -256,35 +441,108 @@ namespace rosa {
             return;
         }
 
+        Rect view_rect{};
+
         {
             ZoneScopedNC("Render:Setup", profiler::detail::tracy_colour_render);
             Renderer::getInstance().clearStats();
             Renderer::getInstance().updateVp(getRenderWindow().getView(), getRenderWindow().getProjection());
+            view_rect = getRenderWindow().getViewRect();
         }
 
-        {
-            ZoneScopedNC("Render:Sprites", profiler::detail::tracy_colour_render);
+        if (!m_culling) {
+            ZoneScopedNC("Render:Unculled", profiler::detail::tracy_colour_render);
 
-            // For every entity with a SpriteComponent, draw it.
             for (const auto& entity: ecs::RegistryView<Entity, SpriteComponent>(m_registry)) {
                 auto& sprite_comp = m_registry.getComponent<SpriteComponent>(entity.getUuid());
                 auto& transform   = m_registry.getComponent<TransformComponent>(entity.getUuid());
-                sprite_comp.draw(transform.getGlobalTransform());
+                sprite_comp.drawRetained(entity.getUuid(), transform.getGlobalTransform());
             };
-        }
-
-        {
-            ZoneScopedNC("Render:Text", profiler::detail::tracy_colour_render);
 
-            // For every entity with a TextComponent, draw it.
             for (const auto& entity: ecs::RegistryView<Entity, TextComponent>(m_registry)) {
                 auto& text_comp = m_registry.getComponent<TextComponent>(entity.getUuid());
                 auto& transform = m_registry.getComponent<TransformComponent>(entity.getUuid());
                 text_comp.draw(transform.getGlobalTransform());
             };
+
+            drawTilemaps(std::nullopt);
+            drawParticles();
+            Renderer::getInstance().flushFrame();
+            return;
+        }
+
+        {
+            ZoneScopedNC("Render:Query", profiler::detail::tracy_colour_render);
+            m_spatial_index.queryRect(view_rect, m_visible_entities);
+        }
+
+        // Draw the world-space components of everything the index says is on screen, then the
+        // screen-space components which are never culled
+        auto draw_entities = [this](const std::vector<Uuid>& entities, bool screen_space, auto component_tag) {
+            using ComponentType = typename decltype(component_tag)::type;
+
+            for (const auto& uuid: entities) {
+                if (!m_registry.hasComponent<ComponentType>(uuid)) {
+                    continue;
+                }
+
+                auto& component = m_registry.getComponent<ComponentType>(uuid);
+                if (component.getScreenSpace() != screen_space) {
+                    continue;
+                }
+
+                auto global_transform = m_registry.getComponent<TransformComponent>(uuid).getGlobalTransform();
+
+                // Sprites keep their geometry on the GPU between frames, text is rebuilt
+                if constexpr (std::is_same_v<ComponentType, SpriteComponent>) {
+                    component.drawRetained(uuid, global_transform);
+                } else {
+                    component.draw(global_transform);
+                }
+            }
+        };
+
+        drawTilemaps(view_rect);
+
+        {
+            ZoneScopedNC("Render:Sprites", profiler::detail::tracy_colour_render);
+            draw_entities(m_visible_entities, false, std::type_identity<SpriteComponent>{});
+            draw_entities(m_screen_space_entities, true, std::type_identity<SpriteComponent>{});
         }
 
-        Renderer::getInstance().flushBatch();
+        {
+            ZoneScopedNC("Render:Text", profiler::detail::tracy_colour_render);
+            draw_entities(m_visible_entities, false, std::type_identity<TextComponent>{});
+            draw_entities(m_screen_space_entities, true, std::type_identity<TextComponent>{});
+        }
+
+        drawParticles();
+        Renderer::getInstance().flushFrame();
+    }
+
+    auto Scene::drawTilemaps(const std::optional<Rect>& view) -> void {
+        ZoneScopedNC("Render:Tilemaps", profiler::detail::tracy_colour_render);
+
+        // Tilemaps cull their own chunks against the view
+        auto& tilemaps = m_registry.getComponents<TilemapComponent>();
+        for (std::size_t i{0}; i < tilemaps.size(); i++) {
+            const auto& uuid = tilemaps.getUuidAtIndex(i);
+            if (m_registry.getEntity(uuid).isActive()) {
+                tilemaps.getAtIndex(i).draw(m_registry.getComponent<TransformComponent>(uuid).getGlobalTransform(), view);
+            }
+        }
+    }
+
+    auto Scene::drawParticles() -> void {
+        ZoneScopedNC("Render:Particles", profiler::detail::tracy_colour_render);
+
+        // Particles wander away from their emitter, so emitters aren't culled
+        auto& emitters = m_registry.getComponents<ParticleEmitterComponent>();
+        for (std::size_t i{0}; i < emitters.size(); i++) {
+            if (m_registry.getEntity(emitters.getUuidAtIndex(i)).isActive()) {
+                emitters.getAtIndex(i).draw();
+            }
+        }
     }
 
     auto Scene::getEntity(const Uuid& uuid) -> Entity& {
@@ -21,8 +21,11 @@
 #include <core/components/CameraComponent.hpp>
 #include <core/components/MusicPlayerComponent.hpp>
 #include <core/components/NativeScriptComponent.hpp>
+#include <core/components/ParticleEmitterComponent.hpp>
 #include <core/components/SoundPlayerComponent.hpp>
+#include <core/components/SpriteAnimationComponent.hpp>
 #include <core/components/SpriteComponent.hpp>
+#include <core/components/TilemapComponent.hpp>
 #include <core/components/TransformComponent.hpp>
 #include <ecs/RegistryView.hpp>
 #include <fstream>
@@ -71,6 +74,21 @@ namespace rosa {
                     out << sprite;
                 }
 
+                if (entity.hasComponent<SpriteAnimationComponent>()) {
+                    auto& animation = entity.getComponent<SpriteAnimationComponent>();
+                    out << animation;
+                }
+
+                if (entity.hasComponent<TilemapComponent>()) {
+                    auto& tilemap = entity.getComponent<TilemapComponent>();
+                    out << tilemap;
+                }
+
+                if (entity.hasComponent<ParticleEmitterComponent>()) {
+                    auto& emitter = entity.getComponent<ParticleEmitterComponent>();
+                    out << emitter;
+                }
+
                 if (entity.hasComponent<SoundPlayerComponent>()) {
                     auto& player = entity.getComponent<SoundPlayerComponent>();
                     out << player;
@@ -150,6 +168,15 @@ namespace rosa {
                 } else if (type == "sprite") {
                     auto& sprite = new_entity.addComponent<SpriteComponent>();
                     sprite = comp.as<SpriteComponent>();
+                } else if (type == "sprite_animation") {
+                    auto& animation = new_entity.addComponent<SpriteAnimationComponent>();
+                    YAML::convert<SpriteAnimationComponent>::decode(comp, animation);
+                } else if (type == "tilemap") {
+                    auto& tilemap = new_entity.addComponent<TilemapComponent>();
+                    YAML::convert<TilemapComponent>::decode(comp, tilemap);
+                } else if (type == "particle_emitter") {
+                    auto& emitter = new_entity.addComponent<ParticleEmitterComponent>();
+                    YAML::convert<ParticleEmitterComponent>::decode(comp, emitter);
                 } else if (type == "sound") {
                     auto& player = new_entity.addComponent<SoundPlayerComponent>();
                     YAML::convert<SoundPlayerComponent>::decode(comp, player);
@@ -13,10 +13,33 @@
  *  see <https://www.gnu.org/licenses/>.
  */
 
+#include <core/Exception.hpp>
 #include <core/SerialiserTypes.hpp>
 
+#include <fmt/format.h>
+
+#include <array>
+#include <string>
+#include <utility>
+
 namespace rosa {
 
+    constexpr std::array<std::pair<BlendMode, const char*>, 3> blend_mode_names{{
+        {BlendMode::Transparent, "transparent"},
+        {BlendMode::Opaque, "opaque"},
+        {BlendMode::AlphaTested, "alpha_tested"},
+    }};
+
+    static auto blendModeName(BlendMode blend_mode) -> const char* {
+        for (const auto& [mode, name]: blend_mode_names) {
+            if (mode == blend_mode) {
+                return name;
+            }
+        }
+
+        throw Exception(fmt::format("Unknown blend mode {}", static_cast<int>(blend_mode)));
+    }
+
     auto operator<<(YAML::Emitter& out, const glm::vec2& vec) -> YAML::Emitter& {
         out << YAML::Flow;
         out << YAML::BeginSeq << vec.x << vec.y << YAML::EndSeq;
@@ -29,4 +52,33 @@ namespace rosa {
         return out;
     }
 
-} // namespace rosa
\ No newline at end of file
+    auto operator<<(YAML::Emitter& out, BlendMode blend_mode) -> YAML::Emitter& {
+        out << blendModeName(blend_mode);
+        return out;
+    }
+
+} // namespace rosa
+
+namespace YAML {
+
+    auto convert<rosa::BlendMode>::decode(const Node& node, rosa::BlendMode& rhs) -> bool {
+        if (!node.IsScalar()) {
+            return false;
+        }
+
+        auto name = node.as<std::string>();
+        for (const auto& [mode, mode_name]: rosa::blend_mode_names) {
+            if (name == mode_name) {
+                rhs = mode;
+                return true;
+            }
+        }
+
+        throw rosa::Exception(fmt::format("Unknown blend mode {}", name));
+    }
+
+    auto convert<rosa::BlendMode>::encode(const rosa::BlendMode& rhs) -> Node {
+        return Node(rosa::blendModeName(rhs));
+    }
+
+} // namespace YAML
\ No newline at end of file
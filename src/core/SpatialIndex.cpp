@@ -0,0 +1,289 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <core/SpatialIndex.hpp>
+
+#include <ProfilerSections.hpp>
+#include <algorithm>
+#include <cmath>
+#include <tracy/Tracy.hpp>
+
+namespace rosa {
+
+    // Furthest cell from the origin in either axis
+    constexpr float max_cell_coordinate{16777216.F};
+
+    SpatialIndex::SpatialIndex(float cell_size)
+        : m_cell_size(cell_size > 0.F ? cell_size : 256.F) {}
+
+    auto SpatialIndex::update(const Uuid& handle, const Rect& bounds) -> void {
+        m_pending.push_back({handle, bounds, false});
+    }
+
+    auto SpatialIndex::remove(const Uuid& handle) -> void {
+        m_pending.push_back({handle, {}, true});
+    }
+
+    auto SpatialIndex::commit() -> void {
+        ZoneScopedNC("SpatialIndex:Commit", profiler::detail::tracy_colour_updates);
+
+        for (const auto& change: m_pending) {
+            auto existing = m_lookup.find(change.handle);
+
+            if (change.removal) {
+                if (existing != m_lookup.end()) {
+                    unlink(existing->second);
+                    m_entries[existing->second].handle = Uuid();
+                    m_free_entries.push_back(existing->second);
+                    m_lookup.erase(existing);
+                }
+                continue;
+            }
+
+            if (existing != m_lookup.end()) {
+                auto& entry = m_entries[existing->second];
+
+                // Moving within the same cells only needs the bounds refreshing
+                auto cells = getCellRange(change.bounds);
+                if (cells == entry.cells) {
+                    entry.bounds = change.bounds;
+                    continue;
+                }
+
+                unlink(existing->second);
+                entry.bounds = change.bounds;
+                entry.cells  = cells;
+                link(existing->second);
+                continue;
+            }
+
+            std::uint32_t index{0};
+            if (m_free_entries.empty()) {
+                index = static_cast<std::uint32_t>(m_entries.size());
+                m_entries.emplace_back();
+            } else {
+                index = m_free_entries.back();
+                m_free_entries.pop_back();
+            }
+
+            auto& entry    = m_entries[index];
+            entry.handle   = change.handle;
+            entry.bounds   = change.bounds;
+            entry.cells    = getCellRange(change.bounds);
+            entry.sequence = m_next_sequence++;
+
+            m_lookup[change.handle] = index;
+            link(index);
+        }
+
+        m_pending.clear();
+    }
+
+    auto SpatialIndex::clear() -> void {
+        m_entries.clear();
+        m_free_entries.clear();
+        m_lookup.clear();
+        m_cells.clear();
+        m_oversized.clear();
+        m_pending.clear();
+    }
+
+    auto SpatialIndex::queryRect(const Rect& area, std::vector<Uuid>& results) const -> void {
+        std::vector<std::uint32_t> candidates{};
+        collect(area, candidates);
+
+        // Drop near misses from the coarse cell test
+        std::erase_if(candidates, [this, &area](std::uint32_t index) {
+            return !m_entries[index].bounds.intersects(area);
+        });
+
+        toHandles(candidates, results);
+    }
+
+    auto SpatialIndex::queryRect(const Rect& area) const -> std::vector<Uuid> {
+        std::vector<Uuid> results{};
+        queryRect(area, results);
+        return results;
+    }
+
+    auto SpatialIndex::queryRadius(glm::vec2 centre, float radius) const -> std::vector<Uuid> {
+        std::vector<std::uint32_t> candidates{};
+        collect({centre - glm::vec2(radius), glm::vec2(radius * 2.F)}, candidates);
+
+        std::erase_if(candidates, [this, centre, radius](std::uint32_t index) {
+            const auto& bounds  = m_entries[index].bounds;
+            auto        nearest = glm::clamp(centre, bounds.position, bounds.position + bounds.size);
+            auto        delta   = nearest - centre;
+            return (delta.x * delta.x + delta.y * delta.y) > radius * radius;
+        });
+
+        std::vector<Uuid> results{};
+        toHandles(candidates, results);
+        return results;
+    }
+
+    auto SpatialIndex::queryPoint(glm::vec2 point) const -> std::vector<Uuid> {
+        std::vector<std::uint32_t> candidates{};
+        collect({point, glm::vec2(0.F)}, candidates);
+
+        std::erase_if(candidates, [this, point](std::uint32_t index) {
+            return !m_entries[index].bounds.contains(point);
+        });
+
+        std::vector<Uuid> results{};
+        toHandles(candidates, results);
+        return results;
+    }
+
+    auto SpatialIndex::getBounds(const Uuid& handle) const -> std::optional<Rect> {
+        auto existing = m_lookup.find(handle);
+        if (existing == m_lookup.end()) {
+            return std::nullopt;
+        }
+
+        return m_entries[existing->second].bounds;
+    }
+
+    auto SpatialIndex::contains(const Uuid& handle) const -> bool {
+        return m_lookup.contains(handle);
+    }
+
+    auto SpatialIndex::getCellRange(const Rect& bounds) const -> CellRange {
+        // Converting NaN or huge values to int is undefined, so cells are kept within a range
+        // no real bounds reach. A NaN edge spans the whole range, which makes the entry oversized.
+        auto to_cell = [this](float position, float nan_cell) {
+            auto cell = std::floor(position / m_cell_size);
+            if (std::isnan(cell)) {
+                cell = nan_cell;
+            }
+
+            return static_cast<int>(std::clamp(cell, -max_cell_coordinate, max_cell_coordinate));
+        };
+
+        return {to_cell(bounds.position.x, -max_cell_coordinate),
+                to_cell(bounds.position.y, -max_cell_coordinate),
+                to_cell(bounds.position.x + bounds.size.x, max_cell_coordinate),
+                to_cell(bounds.position.y + bounds.size.y, max_cell_coordinate)};
+    }
+
+    auto SpatialIndex::link(std::uint32_t entry_index) -> void {
+        auto& entry = m_entries[entry_index];
+
+        entry.oversized = (entry.cells.max_x - entry.cells.min_x) >= max_cells_per_axis ||
+                          (entry.cells.max_y - entry.cells.min_y) >= max_cells_per_axis;
+
+        if (entry.oversized) {
+            m_oversized.push_back(entry_index);
+            return;
+        }
+
+        for (int cell_y = entry.cells.min_y; cell_y <= entry.cells.max_y; cell_y++) {
+            for (int cell_x = entry.cells.min_x; cell_x <= entry.cells.max_x; cell_x++) {
+                m_cells[cellKey(cell_x, cell_y)].push_back(entry_index);
+            }
+        }
+    }
+
+    auto SpatialIndex::unlink(std::uint32_t entry_index) -> void {
+        const auto& entry = m_entries[entry_index];
+
+        if (entry.oversized) {
+            std::erase(m_oversized, entry_index);
+            return;
+        }
+
+        for (int cell_y = entry.cells.min_y; cell_y <= entry.cells.max_y; cell_y++) {
+            for (int cell_x = entry.cells.min_x; cell_x <= entry.cells.max_x; cell_x++) {
+                auto cell = m_cells.find(cellKey(cell_x, cell_y));
+                if (cell == m_cells.end()) {
+                    continue;
+                }
+
+                // Order within a cell doesn't matter, so swap and pop
+                auto& members = cell->second;
+                auto  member  = std::find(members.begin(), members.end(), entry_index);
+                if (member != members.end()) {
+                    *member = members.back();
+                    members.pop_back();
+                }
+
+                if (members.empty()) {
+                    m_cells.erase(cell);
+                }
+            }
+        }
+    }
+
+    auto SpatialIndex::collect(const Rect& area, std::vector<std::uint32_t>& candidates) const -> void {
+        // Entries spanning several cells are seen more than once, the stamp filters repeats
+        m_query_stamp++;
+
+        auto visit = [this, &candidates](std::uint32_t index) {
+            if (m_entries[index].query_stamp != m_query_stamp) {
+                m_entries[index].query_stamp = m_query_stamp;
+                candidates.push_back(index);
+            }
+        };
+
+        auto range = getCellRange(area);
+
+        // A huge query is cheaper as a walk over the occupied cells
+        auto range_cells = static_cast<std::uint64_t>(range.max_x - range.min_x + 1) * static_cast<std::uint64_t>(range.max_y - range.min_y + 1);
+        if (range_cells > m_cells.size()) {
+            for (const auto& [key, members]: m_cells) {
+                for (auto index: members) {
+                    const auto& cells = m_entries[index].cells;
+                    if (cells.max_x >= range.min_x && cells.min_x <= range.max_x && cells.max_y >= range.min_y && cells.min_y <= range.max_y) {
+                        visit(index);
+                    }
+                }
+            }
+        } else {
+            for (int cell_y = range.min_y; cell_y <= range.max_y; cell_y++) {
+                for (int cell_x = range.min_x; cell_x <= range.max_x; cell_x++) {
+                    auto cell = m_cells.find(cellKey(cell_x, cell_y));
+                    if (cell == m_cells.end()) {
+                        continue;
+                    }
+
+                    for (auto index: cell->second) {
+                        visit(index);
+                    }
+                }
+            }
+        }
+
+        for (auto index: m_oversized) {
+            visit(index);
+        }
+    }
+
+    auto SpatialIndex::toHandles(std::vector<std::uint32_t>& candidates, std::vector<Uuid>& results) const -> void {
+        std::sort(candidates.begin(), candidates.end(), [this](std::uint32_t first, std::uint32_t second) {
+            return m_entries[first].sequence < m_entries[second].sequence;
+        });
+
+        results.clear();
+        results.reserve(candidates.size());
+        for (auto index: candidates) {
+            results.push_back(m_entries[index].handle);
+        }
+    }
+
+    auto SpatialIndex::cellKey(int cell_x, int cell_y) -> std::uint64_t {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell_x)) << 32U) | static_cast<std::uint32_t>(cell_y);
+    }
+
+}// namespace rosa
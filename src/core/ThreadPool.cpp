@@ -0,0 +1,123 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <core/ThreadPool.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace rosa {
+
+    ThreadPool::ThreadPool(std::size_t thread_count) {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        m_threads.reserve(thread_count);
+
+        for (std::size_t i = 0; i < thread_count; i++) {
+            m_threads.emplace_back([this]() { run(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_condition.notify_all();
+
+        for (auto& thread: m_threads) {
+            thread.join();
+        }
+    }
+
+    auto ThreadPool::submit(std::function<void()> job) -> std::future<void> {
+        std::packaged_task<void()> task(std::move(job));
+        auto                       future = task.get_future();
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push(std::move(task));
+        }
+
+        m_condition.notify_one();
+        return future;
+    }
+
+    auto ThreadPool::parallelFor(std::size_t count, std::size_t min_range, const std::function<void(std::size_t, std::size_t)>& job) -> void {
+        min_range = std::max<std::size_t>(min_range, 1);
+
+        auto ranges = std::min(m_threads.size() + 1, (count + min_range - 1) / min_range);
+        if (ranges <= 1) {
+            if (count > 0) {
+                job(0, count);
+            }
+            return;
+        }
+
+        auto range_size = (count + ranges - 1) / ranges;
+
+        std::vector<std::future<void>> pending{};
+        pending.reserve(ranges - 1);
+
+        for (std::size_t begin = range_size; begin < count; begin += range_size) {
+            auto end = std::min(begin + range_size, count);
+            pending.push_back(submit([&job, begin, end]() { job(begin, end); }));
+        }
+
+        // Every range must finish before returning, as they all refer to job
+        std::exception_ptr error{};
+
+        try {
+            job(0, range_size);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        for (auto& future: pending) {
+            try {
+                future.get();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    auto ThreadPool::run() -> void {
+        while (true) {
+            std::packaged_task<void()> task{};
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+                if (m_jobs.empty()) {
+                    return;
+                }
+
+                task = std::move(m_jobs.front());
+                m_jobs.pop();
+            }
+
+            task();
+        }
+    }
+
+}// namespace rosa
@@ -0,0 +1,237 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <core/ResourceManager.hpp>
+#include <core/components/ParticleEmitterComponent.hpp>
+#include <graphics/Renderer.hpp>
+
+#include <ProfilerSections.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <tracy/Tracy.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace rosa {
+
+    ParticleEmitterComponent::ParticleEmitterComponent()
+        : m_shader_program(Renderer::getInstance().makeShaderProgram(m_vertex_shader, m_fragment_shader)) {}
+
+    auto ParticleEmitterComponent::setSettings(const ParticleSettings& settings) -> void {
+        m_settings = settings;
+
+        if (m_position_x.size() > m_settings.max_particles) {
+            clear();
+        }
+    }
+
+    auto ParticleEmitterComponent::setTexture(const Uuid& uuid) -> void {
+        auto& texture            = ResourceManager::getInstance().getAsset<Texture>(uuid);
+        m_texture_uuid           = uuid;
+        m_quad.texture_id        = texture.getOpenGlId();
+        m_quad.texture_layer     = texture.getLayer();
+        m_quad.texture_rect_pos  = texture.getUvOffset();
+        m_quad.texture_rect_size = texture.getUvScale();
+    }
+
+    auto ParticleEmitterComponent::burst(std::uint32_t count, glm::vec2 origin) -> void {
+        spawn(count, origin);
+    }
+
+    auto ParticleEmitterComponent::clear() -> void {
+        m_position_x.clear();
+        m_position_y.clear();
+        m_velocity_x.clear();
+        m_velocity_y.clear();
+        m_age.clear();
+        m_lifetime.clear();
+        m_size.clear();
+        m_colour.clear();
+    }
+
+    auto ParticleEmitterComponent::update(float delta_time, glm::vec2 origin, ThreadPool* pool) -> void {
+        ZoneScopedNC("Particles:Update", profiler::detail::tracy_colour_updates);
+
+        if (m_emitting) {
+            m_spawn_debt += m_settings.rate * delta_time;
+            auto count   = static_cast<std::uint32_t>(m_spawn_debt);
+            m_spawn_debt -= static_cast<float>(count);
+            spawn(count, origin);
+        }
+
+        // Ranges are independent, so workers can each take a slice of the arrays
+        if (pool != nullptr) {
+            pool->parallelFor(m_position_x.size(), min_parallel_particles, [this, delta_time](std::size_t begin, std::size_t end) {
+                simulate(begin, end, delta_time);
+            });
+        } else {
+            simulate(0, m_position_x.size(), delta_time);
+        }
+
+        removeDead();
+    }
+
+    auto ParticleEmitterComponent::draw() -> void {
+        if (m_position_x.empty() || m_shader_program == nullptr || m_texture_uuid == Uuid()) {
+            return;
+        }
+
+        ParticleBatch batch{};
+        batch.position_x     = m_position_x.data();
+        batch.position_y     = m_position_y.data();
+        batch.size           = m_size.data();
+        batch.colour         = m_colour.data();
+        batch.count          = m_position_x.size();
+        batch.quad           = m_quad;
+        batch.shader_program = m_shader_program;
+        batch.layer          = m_layer;
+        batch.blend_mode     = m_blend_mode;
+
+        Renderer::getInstance().submitParticles(batch);
+    }
+
+    auto ParticleEmitterComponent::spawn(std::uint32_t count, glm::vec2 origin) -> void {
+        auto alive = static_cast<std::uint32_t>(m_position_x.size());
+        count      = std::min(count, m_settings.max_particles > alive ? m_settings.max_particles - alive : 0U);
+        if (count == 0) {
+            return;
+        }
+
+        if (!m_seeded) {
+            m_random.seed(std::random_device{}());
+            m_seeded = true;
+        }
+
+        auto range = [this](float min, float max) {
+            return std::uniform_real_distribution<float>(std::min(min, max), std::max(min, max))(m_random);
+        };
+
+        auto direction = m_settings.direction * std::numbers::pi_v<float> / 180.F;
+        auto spread    = m_settings.spread * std::numbers::pi_v<float> / 180.F;
+
+        for (std::uint32_t i = 0; i < count; i++) {
+            auto angle = direction + range(-spread, spread);
+            auto speed = range(m_settings.speed.x, m_settings.speed.y);
+
+            m_position_x.push_back(origin.x);
+            m_position_y.push_back(origin.y);
+            m_velocity_x.push_back(std::cos(angle) * speed);
+            m_velocity_y.push_back(std::sin(angle) * speed);
+            m_age.push_back(0.F);
+            m_lifetime.push_back(std::max(range(m_settings.lifetime.x, m_settings.lifetime.y), 0.001F));
+            m_size.push_back(m_settings.start_size);
+            m_colour.push_back(m_settings.start_colour);
+        }
+    }
+
+    auto ParticleEmitterComponent::simulate(std::size_t begin, std::size_t end, float delta_time) -> void {
+        auto damping = std::max(1.F - m_settings.drag * delta_time, 0.F);
+        auto gravity = m_settings.gravity * delta_time;
+
+        auto* position_x = m_position_x.data();
+        auto* position_y = m_position_y.data();
+        auto* velocity_x = m_velocity_x.data();
+        auto* velocity_y = m_velocity_y.data();
+        auto* age        = m_age.data();
+
+        // Each loop touches a couple of arrays, so they stay simple enough to vectorise
+        for (std::size_t i = begin; i < end; i++) {
+            velocity_x[i] = velocity_x[i] * damping + gravity.x;
+            velocity_y[i] = velocity_y[i] * damping + gravity.y;
+        }
+
+        for (std::size_t i = begin; i < end; i++) {
+            position_x[i] += velocity_x[i] * delta_time;
+            position_y[i] += velocity_y[i] * delta_time;
+            age[i] += delta_time;
+        }
+
+        const auto* lifetime = m_lifetime.data();
+        auto*       size     = m_size.data();
+        auto*       colour   = m_colour.data();
+        const auto& start    = m_settings.start_colour;
+        const auto& finish   = m_settings.end_colour;
+
+        for (std::size_t i = begin; i < end; i++) {
+            auto progress = std::min(age[i] / lifetime[i], 1.F);
+
+            size[i]     = m_settings.start_size + (m_settings.end_size - m_settings.start_size) * progress;
+            colour[i].r = start.r + (finish.r - start.r) * progress;
+            colour[i].g = start.g + (finish.g - start.g) * progress;
+            colour[i].b = start.b + (finish.b - start.b) * progress;
+            colour[i].a = start.a + (finish.a - start.a) * progress;
+        }
+    }
+
+    auto ParticleEmitterComponent::removeDead() -> void {
+        auto count = m_position_x.size();
+
+        // Fill each gap with the last particle, order doesn't matter
+        for (std::size_t i = 0; i < count;) {
+            if (m_age[i] < m_lifetime[i]) {
+                i++;
+                continue;
+            }
+
+            count--;
+            m_position_x[i] = m_position_x[count];
+            m_position_y[i] = m_position_y[count];
+            m_velocity_x[i] = m_velocity_x[count];
+            m_velocity_y[i] = m_velocity_y[count];
+            m_age[i]        = m_age[count];
+            m_lifetime[i]   = m_lifetime[count];
+            m_size[i]       = m_size[count];
+            m_colour[i]     = m_colour[count];
+        }
+
+        m_position_x.resize(count);
+        m_position_y.resize(count);
+        m_velocity_x.resize(count);
+        m_velocity_y.resize(count);
+        m_age.resize(count);
+        m_lifetime.resize(count);
+        m_size.resize(count);
+        m_colour.resize(count);
+    }
+
+    auto operator<<(YAML::Emitter& out, const ParticleEmitterComponent& component) -> YAML::Emitter& {
+        const auto& settings = component.getSettings();
+
+        out << YAML::BeginMap;
+        out << YAML::Key << "type" << YAML::Value << "particle_emitter";
+        out << YAML::Key << "rate" << YAML::Value << settings.rate;
+        out << YAML::Key << "max_particles" << YAML::Value << settings.max_particles;
+        out << YAML::Key << "lifetime" << YAML::Value << settings.lifetime;
+        out << YAML::Key << "speed" << YAML::Value << settings.speed;
+        out << YAML::Key << "direction" << YAML::Value << settings.direction;
+        out << YAML::Key << "spread" << YAML::Value << settings.spread;
+        out << YAML::Key << "gravity" << YAML::Value << settings.gravity;
+        out << YAML::Key << "drag" << YAML::Value << settings.drag;
+        out << YAML::Key << "start_size" << YAML::Value << settings.start_size;
+        out << YAML::Key << "end_size" << YAML::Value << settings.end_size;
+        out << YAML::Key << "start_colour" << YAML::Value << settings.start_colour;
+        out << YAML::Key << "end_colour" << YAML::Value << settings.end_colour;
+        if (component.getTextureUuid() != Uuid()) {
+            out << YAML::Key << "texture" << YAML::Value << static_cast<std::string>(component.getTextureUuid());
+        }
+        out << YAML::Key << "emitting" << YAML::Value << component.isEmitting();
+        out << YAML::Key << "layer" << YAML::Value << component.getLayer();
+        out << YAML::Key << "blend_mode" << YAML::Value << component.getBlendMode();
+        out << YAML::EndMap;
+        return out;
+    }
+
+}// namespace rosa
@@ -0,0 +1,167 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <core/ResourceManager.hpp>
+#include <core/components/SpriteAnimationComponent.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace rosa {
+
+    auto SpriteAnimationComponent::setAnimation(const Uuid& uuid) -> void {
+        setAnimation(ResourceManager::getInstance().getAsset<SpriteAnimation>(uuid));
+    }
+
+    auto SpriteAnimationComponent::setAnimation(const SpriteAnimation& animation) -> void {
+        m_animation = &animation;
+        m_uuid      = animation.getUuid();
+        m_clip      = 0;
+        m_frame     = 0;
+        m_time      = 0.F;
+        m_playing   = false;
+        m_finished  = false;
+        m_reverse   = false;
+    }
+
+    auto SpriteAnimationComponent::play(std::string_view clip, bool restart) -> bool {
+        if (m_animation == nullptr) {
+            return false;
+        }
+
+        auto index = m_animation->findClip(clip);
+        if (!index) {
+            return false;
+        }
+
+        if (!restart && m_playing && m_clip == *index) {
+            return true;
+        }
+
+        m_clip     = static_cast<std::uint32_t>(*index);
+        m_frame    = 0;
+        m_time     = 0.F;
+        m_playing  = true;
+        m_finished = false;
+        m_reverse  = false;
+        m_dirty    = true;
+
+        return true;
+    }
+
+    auto SpriteAnimationComponent::stop() -> void {
+        m_playing = false;
+    }
+
+    auto SpriteAnimationComponent::resume() -> void {
+        if (m_animation != nullptr && !m_finished) {
+            m_playing = true;
+        }
+    }
+
+    auto SpriteAnimationComponent::setSpeed(float speed) -> void {
+        m_speed = std::max(speed, 0.F);
+    }
+
+    auto SpriteAnimationComponent::getClip() const -> const AnimationClip* {
+        if (m_animation == nullptr || m_clip >= m_animation->getClipCount()) {
+            return nullptr;
+        }
+
+        return &m_animation->getClip(m_clip);
+    }
+
+    auto SpriteAnimationComponent::step(float delta_time) -> bool {
+        auto changed = m_dirty;
+        m_dirty      = false;
+
+        if (!m_playing) {
+            return changed;
+        }
+
+        const auto& frames = m_animation->getClip(m_clip).frames;
+
+        m_time += delta_time * m_speed;
+
+        // Skip whole cycles after a long hitch rather than walking through them
+        if (m_animation->getClip(m_clip).loop == AnimationLoop::Loop && m_time > frames[m_frame].duration) {
+            float total{0.F};
+            for (const auto& frame: frames) {
+                total += frame.duration;
+            }
+
+            if (m_time > total) {
+                m_time = std::fmod(m_time, total);
+            }
+        }
+
+        while (m_playing && m_time >= frames[m_frame].duration) {
+            m_time -= frames[m_frame].duration;
+            advance(frames.size());
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    auto SpriteAnimationComponent::getFrameUv(const Texture& texture) const -> const AnimationFrameUv& {
+        return m_animation->getFrameUv(m_clip, m_frame, texture);
+    }
+
+    auto SpriteAnimationComponent::advance(std::size_t frame_count) -> void {
+        auto last = static_cast<std::uint32_t>(frame_count - 1);
+
+        switch (m_animation->getClip(m_clip).loop) {
+            case AnimationLoop::Once:
+                if (m_frame < last) {
+                    m_frame++;
+                } else {
+                    m_playing  = false;
+                    m_finished = true;
+                    m_time     = 0.F;
+                }
+                break;
+            case AnimationLoop::Loop:
+                m_frame = m_frame < last ? m_frame + 1 : 0;
+                break;
+            case AnimationLoop::PingPong:
+                if (last == 0) {
+                    break;
+                }
+
+                if (m_reverse ? m_frame == 0 : m_frame == last) {
+                    m_reverse = !m_reverse;
+                }
+
+                m_frame = m_reverse ? m_frame - 1 : m_frame + 1;
+                break;
+        }
+    }
+
+    auto operator<<(YAML::Emitter& out, const SpriteAnimationComponent& component) -> YAML::Emitter& {
+        out << YAML::BeginMap;
+        out << YAML::Key << "type" << YAML::Value << "sprite_animation";
+        out << YAML::Key << "animation" << YAML::Value << static_cast<std::string>(component.getAnimationUuid());
+        out << YAML::Key << "speed" << YAML::Value << component.getSpeed();
+        if (const auto* clip = component.getClip()) {
+            out << YAML::Key << "clip" << YAML::Value << clip->name;
+            out << YAML::Key << "playing" << YAML::Value << component.isPlaying();
+        }
+        out << YAML::EndMap;
+        return out;
+    }
+
+}// namespace rosa
@@ -23,6 +23,8 @@ namespace rosa {
         out << YAML::Key << "type" << YAML::Value << "sprite";
         out << YAML::Key << "texture" << YAML::Value << static_cast<std::string>(component.getTextureUuid());
         out << YAML::Key << "colour" << YAML::Value << component.getColour();
+        out << YAML::Key << "layer" << YAML::Value << component.getLayer();
+        out << YAML::Key << "blend_mode" << YAML::Value << component.getBlendMode();
         out << YAML::EndMap;
         return out;
     }
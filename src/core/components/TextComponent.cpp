@@ -18,25 +18,71 @@
 
 namespace rosa {
 
-    auto TextComponent::setText(const std::string& text) -> void {
-        m_quad_cache.clear();
-        m_text = text;
+    auto TextComponent::setText(std::string_view text) -> void {
+        if (text == m_text) {
+            return;
+        }
+
+        m_text.assign(text);
+        m_layout_dirty = true;
     }
 
-    auto TextComponent::draw(glm::mat4 transform) -> void {
+    auto TextComponent::updateLayout() -> void {
+        if (!m_layout_dirty || m_font == nullptr) {
+            return;
+        }
+
+        m_layout_dirty = false;
+        m_bounds_dirty = true;
+
+        // Identical labels share one layout
+        auto& cache = m_font->getLayoutCache();
+        if (auto shared = cache.find(m_text, m_colour)) {
+            m_layout = shared;
+            return;
+        }
+
+        // Nobody else draws our layout, so it can be changed in place
+        if (m_layout && m_layout.use_count() == 1) {
+            cache.remove(*m_layout);
+        } else {
+            m_layout = std::make_shared<TextLayout>();
+        }
+
+        m_font->layout(*m_layout, m_text, m_colour);
+        cache.insert(m_layout);
+    }
+
+    auto TextComponent::getBounds(const glm::mat4& transform) -> const Rect& {
+        updateLayout();
+
+        if (m_bounds_dirty || transform != m_bounds_transform) {
+            auto local = m_layout ? Rect{m_layout->bounds.position + m_offset, m_layout->bounds.size} : Rect{};
 
-        if (m_quad_cache.empty()) {
-            m_quad_cache = m_font->print(m_text, 0, 0, m_colour);
+            m_bounds           = transformRect(transform, local);
+            m_bounds_transform = transform;
+            m_bounds_dirty     = false;
+            m_indexed_as       = Uuid();
         }
 
-        for (const auto& quad: m_quad_cache) {
-            Renderable renderable{
-                    quad,
-                    glm::translate(transform, glm::vec3(quad.pos.x + m_offset.x, quad.pos.y + m_offset.y, 0.F)),
-                    m_shader_program,
-                    m_screen_space};
-            Renderer::getInstance().submit(renderable);
+        return m_bounds;
+    }
+
+    auto TextComponent::draw(glm::mat4 transform) -> void {
+
+        updateLayout();
+
+        if (!m_layout) {
+            return;
         }
+
+        Renderer::getInstance().submitMesh({m_layout->vertices.data(),
+                                            m_layout->vertices.size() / 4,
+                                            glm::translate(transform, glm::vec3(m_offset.x, m_offset.y, 0.F)),
+                                            m_layout->texture,
+                                            m_shader_program,
+                                            m_screen_space,
+                                            m_layer});
     }
 
     auto TextComponent::getText() const -> const std::string& {
@@ -51,17 +97,34 @@ namespace rosa {
         return m_screen_space;
     }
 
+    auto TextComponent::setLayer(int layer) -> void {
+        m_layer = layer;
+    }
+
+    auto TextComponent::getLayer() const -> int {
+        return m_layer;
+    }
+
     auto TextComponent::getFont() const -> const Uuid& {
         return m_font_uuid;
     }
 
     auto TextComponent::setFont(const Uuid& uuid) -> void {
-        m_font      = &ResourceManager::getInstance().getAsset<BitmapFont>(uuid);
-        m_font_uuid = uuid;
+        m_font         = &ResourceManager::getInstance().getAsset<BitmapFont>(uuid);
+        m_font_uuid    = uuid;
+        m_layout_dirty = true;
+
+        // Layouts belong to the font that made them
+        m_layout.reset();
     }
 
     auto TextComponent::setColour(Colour colour) -> void {
-        m_colour = colour;
+        if (colour == m_colour) {
+            return;
+        }
+
+        m_colour       = colour;
+        m_layout_dirty = true;
     }
 
     auto TextComponent::getColour() -> Colour {
@@ -69,7 +132,8 @@ namespace rosa {
     }
 
     auto TextComponent::setOffset(glm::vec2 offset) -> void {
-        m_offset = offset;
+        m_offset       = offset;
+        m_bounds_dirty = true;
     }
 
     auto TextComponent::getOffset() -> glm::vec2 {
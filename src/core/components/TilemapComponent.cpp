@@ -0,0 +1,229 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <core/ResourceManager.hpp>
+#include <core/components/TilemapComponent.hpp>
+#include <graphics/Renderer.hpp>
+
+#include <ProfilerSections.hpp>
+#include <algorithm>
+#include <cmath>
+#include <tracy/Tracy.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace rosa {
+
+    TilemapComponent::TilemapComponent()
+        : m_shader_program(Renderer::getInstance().makeShaderProgram(m_vertex_shader, m_fragment_shader)) {}
+
+    auto TilemapComponent::setTileset(const Uuid& uuid, glm::vec2 tile_size) -> void {
+        m_tileset_uuid    = uuid;
+        m_tileset         = &ResourceManager::getInstance().getAsset<Texture>(uuid);
+        m_tile_size       = glm::max(tile_size, glm::vec2(1.F));
+        m_tileset_columns = std::max(static_cast<int>(m_tileset->getSize().x / m_tile_size.x), 1);
+        rebuildAll();
+    }
+
+    auto TilemapComponent::resize(int width, int height) -> void {
+        m_width    = std::max(width, 0);
+        m_height   = std::max(height, 0);
+        m_chunks_x = (m_width + tilemap_chunk_size - 1) / tilemap_chunk_size;
+        m_chunks_y = (m_height + tilemap_chunk_size - 1) / tilemap_chunk_size;
+
+        m_chunks.clear();
+        m_chunks.resize(static_cast<std::size_t>(m_chunks_x) * static_cast<std::size_t>(m_chunks_y));
+        for (auto& chunk: m_chunks) {
+            chunk.tiles.fill(empty_tile);
+        }
+    }
+
+    auto TilemapComponent::setTile(int x, int y, int tile) -> void {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+            return;
+        }
+
+        auto& chunk = m_chunks[static_cast<std::size_t>(y / tilemap_chunk_size * m_chunks_x + x / tilemap_chunk_size)];
+        auto  index = (y % tilemap_chunk_size) * tilemap_chunk_size + x % tilemap_chunk_size;
+
+        if (chunk.tiles[static_cast<std::size_t>(index)] == tile) {
+            return;
+        }
+
+        chunk.tiles[static_cast<std::size_t>(index)] = tile;
+        if (chunk.rebuild) {
+            return;
+        }
+
+        // An off screen chunk keeps collecting changes, animated tiles repeating the same ones,
+        // so past a point it is cheaper to bake it whole when it comes into view
+        if (chunk.dirty.size() >= static_cast<std::size_t>(tilemap_dirty_limit)) {
+            chunk.dirty.clear();
+            chunk.rebuild = true;
+            return;
+        }
+
+        chunk.dirty.push_back(static_cast<std::uint16_t>(index));
+    }
+
+    auto TilemapComponent::getTile(int x, int y) const -> int {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+            return empty_tile;
+        }
+
+        const auto& chunk = m_chunks[static_cast<std::size_t>(y / tilemap_chunk_size * m_chunks_x + x / tilemap_chunk_size)];
+        return chunk.tiles[static_cast<std::size_t>((y % tilemap_chunk_size) * tilemap_chunk_size + x % tilemap_chunk_size)];
+    }
+
+    auto TilemapComponent::setColour(const Colour& colour) -> void {
+        m_colour = colour;
+        rebuildAll();
+    }
+
+    auto TilemapComponent::setLayer(int layer) -> void {
+        m_layer = layer;
+        rebuildAll();
+    }
+
+    auto TilemapComponent::getVisibleChunks(const glm::mat4& transform, const Rect& view) const -> std::pair<glm::ivec2, glm::ivec2> {
+        // Bring the view into map space, where chunks are axis aligned
+        auto local      = transformRect(glm::inverse(transform), view);
+        auto chunk_size = m_tile_size * static_cast<float>(tilemap_chunk_size);
+
+        glm::ivec2 first{static_cast<int>(std::floor(local.position.x / chunk_size.x)),
+                         static_cast<int>(std::floor(local.position.y / chunk_size.y))};
+        glm::ivec2 last{static_cast<int>(std::floor((local.position.x + local.size.x) / chunk_size.x)) + 1,
+                        static_cast<int>(std::floor((local.position.y + local.size.y) / chunk_size.y)) + 1};
+
+        first = glm::clamp(first, glm::ivec2(0), glm::ivec2(m_chunks_x, m_chunks_y));
+        last  = glm::clamp(last, first, glm::ivec2(m_chunks_x, m_chunks_y));
+
+        return {first, last};
+    }
+
+    auto TilemapComponent::draw(const glm::mat4& transform, const std::optional<Rect>& view) -> void {
+        ZoneScopedNC("Tilemap:Draw", profiler::detail::tracy_colour_render);
+
+        if (m_shader_program == nullptr || m_tileset == nullptr || m_chunks.empty()) {
+            return;
+        }
+
+        if (transform != m_baked_transform) {
+            m_baked_transform = transform;
+            rebuildAll();
+        }
+
+        auto [first, last] = view ? getVisibleChunks(transform, *view) : std::pair{glm::ivec2(0), glm::ivec2(m_chunks_x, m_chunks_y)};
+
+        StaticBatch batch{};
+        batch.quad.texture_id    = m_tileset->getOpenGlId();
+        batch.quad.texture_layer = m_tileset->getLayer();
+        batch.shader_program     = m_shader_program;
+        batch.layer              = m_layer;
+        batch.blend_mode         = m_blend_mode;
+
+        auto& renderer = Renderer::getInstance();
+
+        for (int chunk_y = first.y; chunk_y < last.y; chunk_y++) {
+            for (int chunk_x = first.x; chunk_x < last.x; chunk_x++) {
+                auto& chunk = m_chunks[static_cast<std::size_t>(chunk_y * m_chunks_x + chunk_x)];
+
+                // Chunks are only given a buffer once they have been seen, in the layout of the program
+                if (!chunk.buffer || chunk.buffer->getVertexFormat() != m_shader_program->getVertexFormat()) {
+                    chunk.buffer = renderer.createStaticBuffer(tilemap_chunk_size * tilemap_chunk_size, m_shader_program->getVertexFormat());
+                    while (chunk.buffer->allocate()) {}
+                    chunk.rebuild = true;
+                }
+
+                if (chunk.rebuild) {
+                    for (int index = 0; index < tilemap_chunk_size * tilemap_chunk_size; index++) {
+                        bakeTile(chunk, chunk_x, chunk_y, index);
+                    }
+                } else {
+                    for (auto index: chunk.dirty) {
+                        bakeTile(chunk, chunk_x, chunk_y, index);
+                    }
+                }
+
+                chunk.rebuild = false;
+                chunk.dirty.clear();
+
+                batch.buffer = chunk.buffer.get();
+                renderer.submitStatic(batch);
+            }
+        }
+    }
+
+    auto TilemapComponent::bakeTile(Chunk& chunk, int chunk_x, int chunk_y, int index) -> void {
+        auto* vertices = chunk.buffer->getVertices(index);
+        auto  tile     = chunk.tiles[static_cast<std::size_t>(index)];
+
+        // Empty tiles keep their slot, collapsed to nothing
+        if (tile < 0) {
+            std::fill_n(vertices, 4, Vertex());
+            return;
+        }
+
+        auto tile_x = chunk_x * tilemap_chunk_size + index % tilemap_chunk_size;
+        auto tile_y = chunk_y * tilemap_chunk_size + index / tilemap_chunk_size;
+
+        auto texture_size = m_tileset->getSize();
+        auto source       = glm::vec2(static_cast<float>(tile % m_tileset_columns), static_cast<float>(tile / m_tileset_columns)) * m_tile_size;
+
+        Renderable renderable{};
+        renderable.quad.size              = m_tile_size;
+        renderable.quad.colour            = m_colour;
+        renderable.quad.texture_layer     = m_tileset->getLayer();
+        renderable.quad.texture_rect_pos  = m_tileset->getUvOffset() + (source / texture_size) * m_tileset->getUvScale();
+        renderable.quad.texture_rect_size = (m_tile_size / texture_size) * m_tileset->getUvScale();
+        renderable.layer                  = m_layer;
+
+        // Quads are centred on their transform
+        glm::mat4 offset{1.F};
+        offset[3]            = glm::vec4((static_cast<float>(tile_x) + 0.5F) * m_tile_size.x, (static_cast<float>(tile_y) + 0.5F) * m_tile_size.y, 0.F, 1.F);
+        renderable.transform = m_baked_transform * offset;
+
+        Renderer::bakeQuad(vertices, renderable);
+    }
+
+    auto TilemapComponent::rebuildAll() -> void {
+        for (auto& chunk: m_chunks) {
+            chunk.rebuild = true;
+            chunk.dirty.clear();
+        }
+    }
+
+    auto operator<<(YAML::Emitter& out, const TilemapComponent& component) -> YAML::Emitter& {
+        out << YAML::BeginMap;
+        out << YAML::Key << "type" << YAML::Value << "tilemap";
+        out << YAML::Key << "width" << YAML::Value << component.getWidth();
+        out << YAML::Key << "height" << YAML::Value << component.getHeight();
+        out << YAML::Key << "tileset" << YAML::Value << static_cast<std::string>(component.getTilesetUuid());
+        out << YAML::Key << "tile_size" << YAML::Value << component.getTileSize();
+        out << YAML::Key << "colour" << YAML::Value << component.getColour();
+        out << YAML::Key << "layer" << YAML::Value << component.getLayer();
+        out << YAML::Key << "blend_mode" << YAML::Value << component.getBlendMode();
+        out << YAML::Key << "tiles" << YAML::Value << YAML::Flow << YAML::BeginSeq;
+        for (int y = 0; y < component.getHeight(); y++) {
+            for (int x = 0; x < component.getWidth(); x++) {
+                out << component.getTile(x, y);
+            }
+        }
+        out << YAML::EndSeq;
+        out << YAML::EndMap;
+        return out;
+    }
+
+}// namespace rosa
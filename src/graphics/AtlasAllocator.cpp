@@ -0,0 +1,165 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <graphics/AtlasAllocator.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace rosa {
+
+    AtlasAllocator::AtlasAllocator(int width, int height, int alignment, int padding)
+        : m_width(width), m_height(height), m_alignment(std::max(alignment, 1)), m_padding(std::max(padding, 0)) {
+        reset();
+    }
+
+    auto AtlasAllocator::allocate(int width, int height) -> std::optional<AtlasRegion> {
+        if (width <= 0 || height <= 0) {
+            return std::nullopt;
+        }
+
+        // The footprint includes the padding so neighbours never touch
+        auto footprint_width  = align(width + m_padding);
+        auto footprint_height = align(height + m_padding);
+
+        // Best area fit
+        std::size_t  best{m_free_regions.size()};
+        std::int64_t best_leftover{std::numeric_limits<std::int64_t>::max()};
+
+        for (std::size_t i = 0; i < m_free_regions.size(); i++) {
+            const auto& free = m_free_regions[i];
+            if (free.width < footprint_width || free.height < footprint_height) {
+                continue;
+            }
+
+            auto leftover = static_cast<std::int64_t>(free.width) * free.height -
+                            static_cast<std::int64_t>(footprint_width) * footprint_height;
+            if (leftover < best_leftover) {
+                best          = i;
+                best_leftover = leftover;
+            }
+        }
+
+        if (best == m_free_regions.size()) {
+            return std::nullopt;
+        }
+
+        auto free = m_free_regions[best];
+        m_free_regions.erase(m_free_regions.begin() + static_cast<std::ptrdiff_t>(best));
+
+        // Split the remainder along the shorter leftover axis
+        AtlasRegion right{};
+        AtlasRegion below{};
+        if (free.width - footprint_width < free.height - footprint_height) {
+            right = {free.x + footprint_width, free.y, free.width - footprint_width, footprint_height};
+            below = {free.x, free.y + footprint_height, free.width, free.height - footprint_height};
+        } else {
+            right = {free.x + footprint_width, free.y, free.width - footprint_width, free.height};
+            below = {free.x, free.y + footprint_height, footprint_width, free.height - footprint_height};
+        }
+
+        if (right.width > 0 && right.height > 0) {
+            m_free_regions.push_back(right);
+        }
+
+        if (below.width > 0 && below.height > 0) {
+            m_free_regions.push_back(below);
+        }
+
+        m_used_area += static_cast<std::int64_t>(footprint_width) * footprint_height;
+        m_allocations++;
+
+        return AtlasRegion{free.x, free.y, width, height};
+    }
+
+    auto AtlasAllocator::release(const AtlasRegion& region) -> void {
+        if (m_allocations == 0) {
+            return;
+        }
+
+        // Recover the footprint the same way it was allocated
+        AtlasRegion footprint{region.x, region.y, align(region.width + m_padding), align(region.height + m_padding)};
+
+        m_used_area -= static_cast<std::int64_t>(footprint.width) * footprint.height;
+        m_allocations--;
+
+        if (m_allocations == 0) {
+            reset();
+            return;
+        }
+
+        m_free_regions.push_back(footprint);
+        merge();
+    }
+
+    auto AtlasAllocator::reset() -> void {
+        m_free_regions.clear();
+        m_free_regions.push_back({0, 0, m_width, m_height});
+        m_used_area   = 0;
+        m_allocations = 0;
+    }
+
+    auto AtlasAllocator::getFillRatio() const -> float {
+        if (m_width <= 0 || m_height <= 0) {
+            return 0.F;
+        }
+
+        return static_cast<float>(static_cast<double>(m_used_area) / (static_cast<double>(m_width) * m_height));
+    }
+
+    auto AtlasAllocator::align(int value) const -> int {
+        return ((value + m_alignment - 1) / m_alignment) * m_alignment;
+    }
+
+    auto AtlasAllocator::merge() -> void {
+        bool merged{true};
+
+        while (merged) {
+            merged = false;
+
+            for (std::size_t i = 0; i < m_free_regions.size() && !merged; i++) {
+                for (std::size_t j = i + 1; j < m_free_regions.size() && !merged; j++) {
+                    auto& first  = m_free_regions[i];
+                    auto& second = m_free_regions[j];
+
+                    if (first.x == second.x && first.width == second.width) {
+                        if (first.y + first.height == second.y) {
+                            first.height += second.height;
+                            merged = true;
+                        } else if (second.y + second.height == first.y) {
+                            first.y = second.y;
+                            first.height += second.height;
+                            merged = true;
+                        }
+                    } else if (first.y == second.y && first.height == second.height) {
+                        if (first.x + first.width == second.x) {
+                            first.width += second.width;
+                            merged = true;
+                        } else if (second.x + second.width == first.x) {
+                            first.x = second.x;
+                            first.width += second.width;
+                            merged = true;
+                        }
+                    }
+
+                    if (merged) {
+                        m_free_regions.erase(m_free_regions.begin() + static_cast<std::ptrdiff_t>(j));
+                    }
+                }
+            }
+        }
+    }
+
+}// namespace rosa
@@ -14,10 +14,15 @@
  */
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <cassert>
 #include <core/ResourceManager.hpp>
 #include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
 #include <graphics/BitmapFont.hpp>
+#include <graphics/GlState.hpp>
+#include <graphics/Renderer.hpp>
+#include <graphics/TextureAtlas.hpp>
 #include <graphics/gl.hpp>
 #include <physfs.h>
 #include <vector>
@@ -31,7 +36,7 @@ enum BlendFlags {
 
 namespace rosa {
 
-    BitmapFont::BitmapFont(const std::string& name, const rosa::Uuid& uuid, const std::string& pack)
+    BitmapFont::BitmapFont(const std::string& name, const rosa::Uuid& uuid, const std::string& pack, bool defer_upload)
         : Resource(name, uuid, pack) {
 
         if (PHYSFS_exists(name.c_str()) == 0) {
@@ -94,8 +99,7 @@ namespace rosa {
                          static_cast<std::uint64_t>(m_image_y) *
                          (static_cast<std::uint64_t>(bpp) / 8);
 
-        std::vector<char> image_data;
-        image_data.resize(data_size);
+        m_image_data.resize(data_size);
 
 
         // Grab char widths
@@ -103,10 +107,22 @@ namespace rosa {
 
         // Grab image data
         std::memcpy(
-                image_data.data(),
+                m_image_data.data(),
                 &data[bf_map_data_offset],
                 data_size);
 
+        if (!defer_upload) {
+            upload();
+        }
+    }
+
+    BitmapFont::~BitmapFont() {
+        if (m_atlas != nullptr) {
+            m_atlas->release(m_atlas_region);
+        }
+    }
+
+    auto BitmapFont::upload() -> void {
         if (glfwGetCurrentContext() == nullptr) {
             return;
         }
@@ -124,21 +140,67 @@ namespace rosa {
         // Tex creation params are dependent on BPP
         switch (m_render_style) {
             case BlendAlpha:
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, m_image_x, m_image_y, 0, GL_RED, GL_UNSIGNED_BYTE, image_data.data());
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, m_image_x, m_image_y, 0, GL_RED, GL_UNSIGNED_BYTE, m_image_data.data());
                 break;
 
             case BlendRgb:
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_image_x, m_image_y, 0, GL_RGB, GL_UNSIGNED_BYTE, image_data.data());
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_image_x, m_image_y, 0, GL_RGB, GL_UNSIGNED_BYTE, m_image_data.data());
                 break;
 
             case BlendRgba:
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_image_x, m_image_y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data.data());
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_image_x, m_image_y, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_image_data.data());
                 break;
 
             case BlendNone:
             default:
                 break;
         }
+
+        m_image_data.clear();
+        m_image_data.shrink_to_fit();
+    }
+
+    auto BitmapFont::insertIntoAtlas(TextureAtlas& atlas) -> bool {
+        if (m_render_style == BlendNone) {
+            return false;
+        }
+
+        // Expand to RGBA the way GL would when sampling a RED or RGB texture
+        auto                       pixel_count = static_cast<std::size_t>(m_image_x) * static_cast<std::size_t>(m_image_y);
+        std::vector<unsigned char> rgba(pixel_count * 4, 0);
+
+        for (std::size_t i = 0; i < pixel_count; i++) {
+            switch (m_render_style) {
+                case BlendAlpha:
+                    rgba[i * 4 + 0] = static_cast<unsigned char>(m_image_data[i]);
+                    rgba[i * 4 + 3] = 255;
+                    break;
+                case BlendRgb:
+                    std::memcpy(&rgba[i * 4], &m_image_data[i * 3], 3);
+                    rgba[i * 4 + 3] = 255;
+                    break;
+                case BlendRgba:
+                default:
+                    std::memcpy(&rgba[i * 4], &m_image_data[i * 4], 4);
+                    break;
+            }
+        }
+
+        auto region = atlas.insert(m_image_x, m_image_y, rgba.data());
+        if (!region) {
+            return false;
+        }
+
+        m_texture_id   = atlas.getOpenGlId();
+        m_atlas        = &atlas;
+        m_atlas_region = *region;
+        m_uv_offset    = atlas.getUvOffset(*region);
+        m_uv_scale     = atlas.getUvScale(*region);
+
+        m_image_data.clear();
+        m_image_data.shrink_to_fit();
+
+        return true;
     }
 
     auto BitmapFont::print(const std::string& text, int pos_x, int pos_y, Colour colour) -> std::vector<Quad> {
@@ -176,17 +238,17 @@ namespace rosa {
     auto BitmapFont::setBlending() -> void {
         switch (m_render_style) {
             case BlendAlpha:// 8Bit
-                glBlendFunc(GL_SRC_ALPHA, GL_SRC_ALPHA);
-                glEnable(GL_BLEND);
+                GlState::current().setBlendFunc(GL_SRC_ALPHA, GL_SRC_ALPHA);
+                GlState::current().setBlend(true);
                 break;
 
             case BlendRgb:// 24Bit
-                glDisable(GL_BLEND);
+                GlState::current().setBlend(false);
                 break;
 
             case BlendRgba:// 32Bit
-                glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-                glEnable(GL_BLEND);
+                GlState::current().setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                GlState::current().setBlend(true);
                 break;
 
             case BlendNone:
@@ -215,33 +277,85 @@ namespace rosa {
         std::vector<Quad> quads{};
 
         for (const auto character: text) {
+            quads.push_back(makeCharQuad(character, m_cursor_x, m_cursor_y, colour));
+            m_cursor_x += m_widths.at(static_cast<std::uint64_t>(character));
+        }
 
-            int row = static_cast<int>(character - m_base_char) / m_row_pitch;
-            int col = static_cast<int>(character - m_base_char) - row * m_row_pitch;
+        return quads;
+    }
 
-            Quad new_quad{};
+    auto BitmapFont::makeCharQuad(char character, int pos_x, int pos_y, Colour colour) const -> Quad {
 
-            new_quad.size.x = static_cast<float>(m_cell_x);
-            new_quad.size.y = static_cast<float>(m_cell_y);
+        int row = static_cast<int>(character - m_base_char) / m_row_pitch;
+        int col = static_cast<int>(character - m_base_char) - row * m_row_pitch;
 
-            new_quad.pos.x = static_cast<float>(m_cursor_x);
-            new_quad.pos.y = static_cast<float>(m_cursor_y);
+        Quad new_quad{};
 
-            new_quad.colour = colour;
+        new_quad.size.x = static_cast<float>(m_cell_x);
+        new_quad.size.y = static_cast<float>(m_cell_y);
 
-            new_quad.texture_id = m_texture_id;
+        new_quad.pos.x = static_cast<float>(pos_x);
+        new_quad.pos.y = static_cast<float>(pos_y);
 
-            new_quad.texture_rect_size.x = static_cast<float>(m_cell_x) / static_cast<float>(m_image_x);
-            new_quad.texture_rect_size.y = static_cast<float>(m_cell_y) / static_cast<float>(m_image_y);
+        new_quad.colour = colour;
 
-            new_quad.texture_rect_pos.x = (static_cast<float>(col) * static_cast<float>(m_cell_x)) / static_cast<float>(m_image_x);
-            new_quad.texture_rect_pos.y = (static_cast<float>(row) * static_cast<float>(m_cell_y)) / static_cast<float>(m_image_y);
+        new_quad.texture_id = m_texture_id;
 
-            quads.push_back(new_quad);
-            m_cursor_x += m_widths.at(static_cast<std::uint64_t>(character));
+        new_quad.texture_rect_size.x = static_cast<float>(m_cell_x) / static_cast<float>(m_image_x);
+        new_quad.texture_rect_size.y = static_cast<float>(m_cell_y) / static_cast<float>(m_image_y);
+
+        new_quad.texture_rect_pos.x = (static_cast<float>(col) * static_cast<float>(m_cell_x)) / static_cast<float>(m_image_x);
+        new_quad.texture_rect_pos.y = (static_cast<float>(row) * static_cast<float>(m_cell_y)) / static_cast<float>(m_image_y);
+
+        // Remap into the atlas, a no-op for standalone pages
+        new_quad.texture_rect_pos  = m_uv_offset + new_quad.texture_rect_pos * m_uv_scale;
+        new_quad.texture_rect_size = new_quad.texture_rect_size * m_uv_scale;
+
+        return new_quad;
+    }
+
+    auto BitmapFont::layout(TextLayout& layout, std::string_view text, Colour colour) -> void {
+        if (text.length() > bf_max_layout_length) {
+            throw Exception("Error printing text, string exceeds max length");
         }
 
-        return quads;
+        // Glyphs before the first changed character keep their place, unless the colour changed
+        std::size_t first{0};
+        if (layout.colour == colour && layout.vertices.size() == layout.text.size() * 4) {
+            auto common = std::min(layout.text.size(), text.size());
+            while (first < common && layout.text[first] == text[first]) {
+                first++;
+            }
+        }
+
+        int cursor_x{0};
+        for (std::size_t i = 0; i < first; i++) {
+            cursor_x += m_widths.at(static_cast<std::uint64_t>(text[i]));
+        }
+
+        layout.text.assign(text);
+        layout.colour             = colour;
+        layout.texture            = Quad{};
+        layout.texture.texture_id = m_texture_id;
+        layout.vertices.resize(text.size() * 4);
+
+        for (std::size_t i = first; i < text.size(); i++) {
+            auto quad = makeCharQuad(text[i], cursor_x, 0, colour);
+            Renderer::bakeQuad(&layout.vertices[i * 4], {quad, glm::translate(glm::mat4{1.F}, glm::vec3(quad.pos.x, quad.pos.y, 0.F))});
+            cursor_x += m_widths.at(static_cast<std::uint64_t>(text[i]));
+        }
+
+        // Union of the glyph cells, from the corners of every one
+        glm::vec2 min_corner{0.F};
+        glm::vec2 max_corner{0.F};
+        for (std::size_t i = 0; i < layout.vertices.size(); i++) {
+            const auto& position = layout.vertices[i].position;
+
+            min_corner = i == 0 ? position : glm::min(min_corner, position);
+            max_corner = i == 0 ? position : glm::max(max_corner, position);
+        }
+
+        layout.bounds = {min_corner, max_corner - min_corner};
     }
 
 }// namespace rosa
\ No newline at end of file
@@ -21,6 +21,8 @@
 #include <ProfilerSections.hpp>
 #include <cstdint>
 #include <graphics/FrameBuffer.hpp>
+#include <graphics/GlState.hpp>
+#include <spdlog/spdlog.h>
 #include <sstream>
 
 namespace {
@@ -46,6 +48,25 @@ namespace {
     constexpr unsigned int GL_INTENSITY8 = 0x804B;
     constexpr unsigned int GL_INTENSITY12 = 0x804C;
     constexpr unsigned int GL_INTENSITY16 = 0x804D;
+
+    // A single triangle covering the viewport, with the drawn area of the colour buffer
+    // stretched over it
+    constexpr const char* upscale_vertex_source = R"(#version 330 core
+uniform vec2 uvScale;
+out vec2 uv;
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv          = corner * uvScale;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+    constexpr const char* upscale_fragment_source = R"(#version 330 core
+uniform sampler2D frame;
+in vec2 uv;
+out vec4 colour;
+void main() {
+    colour = texture(frame, uv);
+})";
 } // namespace
 
 
@@ -53,6 +74,12 @@ namespace rosa {
 
     FrameBuffer::~FrameBuffer() {
         delete_buffers();
+
+        if (m_upscale_program > 0) {
+            glDeleteProgram(m_upscale_program);
+            glDeleteVertexArrays(1, &m_upscale_vao);
+            glDeleteSamplers(1, &m_upscale_sampler);
+        }
     }
 
     auto FrameBuffer::init(int width, int height, int msaa) -> bool {
@@ -239,6 +266,88 @@ namespace rosa {
                           GL_LINEAR);                       // scale filter
     }
 
+    auto FrameBuffer::upscaleTo(GLuint fbo_id, int source_width, int source_height, int width, int height) -> void {
+        ZoneScopedNC("Framebuffer:Upscale", profiler::detail::tracy_colour_framebuffer);
+
+        // A multisampled source can't be scaled, so resolve the drawn area at its own size
+        if (m_msaa > 0) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_msaa_id);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_fbo_id);
+            glBlitFramebuffer(0, 0, source_width, source_height,
+                              0, 0, source_width, source_height,
+                              GL_COLOR_BUFFER_BIT,
+                              GL_NEAREST);
+        }
+
+        // A scaling blit is refused by a multisampled destination, so draw the stretch instead
+        if (m_upscale_program == 0 && !create_upscale_program()) {
+            return;
+        }
+
+        auto& state = GlState::current();
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo_id);
+        glViewport(0, 0, width, height);
+        state.setBlend(false);
+        state.setDepthTest(false);
+        state.useProgram(m_upscale_program);
+        state.bindVertexArray(m_upscale_vao);
+        state.bindTexture(0, GL_TEXTURE_2D, m_texture_id);
+
+        // The sampler skips the colour buffer's mipmaps, which are only generated by update()
+        glBindSampler(0, m_upscale_sampler);
+        glUniform2f(m_upscale_scale_id,
+                    static_cast<float>(source_width) / static_cast<float>(m_width),
+                    static_cast<float>(source_height) / static_cast<float>(m_height));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindSampler(0, 0);
+
+        state.setBlend(true);
+    }
+
+    auto FrameBuffer::create_upscale_program() -> bool {
+        auto compile = [](GLenum type, const char* source) {
+            auto shader = glCreateShader(type);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+            return shader;
+        };
+
+        auto vertex_shader   = compile(GL_VERTEX_SHADER, upscale_vertex_source);
+        auto fragment_shader = compile(GL_FRAGMENT_SHADER, upscale_fragment_source);
+
+        m_upscale_program = glCreateProgram();
+        glAttachShader(m_upscale_program, vertex_shader);
+        glAttachShader(m_upscale_program, fragment_shader);
+        glLinkProgram(m_upscale_program);
+        glDetachShader(m_upscale_program, vertex_shader);
+        glDetachShader(m_upscale_program, fragment_shader);
+        glDeleteShader(vertex_shader);
+        glDeleteShader(fragment_shader);
+
+        GLint linked{GL_FALSE};
+        glGetProgramiv(m_upscale_program, GL_LINK_STATUS, &linked);
+        if (linked != GL_TRUE) {
+            m_error_message = "[ERROR] Failed to link the upscale program.";
+            spdlog::error("FrameBuffer: {}", m_error_message);
+            glDeleteProgram(m_upscale_program);
+            m_upscale_program = 0;
+            return false;
+        }
+
+        m_upscale_scale_id = glGetUniformLocation(m_upscale_program, "uvScale");
+
+        // Core profiles need a vertex array bound, even with no attributes
+        glGenVertexArrays(1, &m_upscale_vao);
+
+        glGenSamplers(1, &m_upscale_sampler);
+        glSamplerParameteri(m_upscale_sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glSamplerParameteri(m_upscale_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glSamplerParameteri(m_upscale_sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glSamplerParameteri(m_upscale_sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        return true;
+    }
+
     auto FrameBuffer::blitDepthTo(GLuint fbo_id, int start_x, int start_y, int width, int height) -> void {
         ZoneScopedNC("Framebuffer:BlitDepth", profiler::detail::tracy_colour_framebuffer);
 
@@ -0,0 +1,85 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <graphics/FramePacket.hpp>
+
+namespace rosa {
+
+    ImGuiFrame::~ImGuiFrame() {
+        clear();
+    }
+
+    auto ImGuiFrame::capture(ImDrawData* draw_data, bool clone) -> void {
+        clear();
+
+        if (draw_data == nullptr || !draw_data->Valid) {
+            return;
+        }
+
+        if (!clone) {
+            m_source = draw_data;
+            return;
+        }
+
+        // The lists belong to ImGui and are rebuilt every frame, so take copies of them
+        m_copy = *draw_data;
+        m_lists.reserve(static_cast<std::size_t>(draw_data->CmdListsCount));
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            m_lists.push_back(draw_data->CmdLists[i]->CloneOutput());
+        }
+
+#if IMGUI_VERSION_NUM >= 18913
+        m_copy.CmdLists.resize(static_cast<int>(m_lists.size()));
+        for (std::size_t i = 0; i < m_lists.size(); i++) {
+            m_copy.CmdLists[static_cast<int>(i)] = m_lists[i];
+        }
+#else
+        m_copy.CmdLists = m_lists.data();
+#endif
+
+        m_cloned = true;
+    }
+
+    auto ImGuiFrame::getDrawData() -> ImDrawData* {
+        if (m_cloned) {
+            return &m_copy;
+        }
+
+        return m_source;
+    }
+
+    auto ImGuiFrame::clear() -> void {
+        for (auto* list: m_lists) {
+            IM_DELETE(list);
+        }
+
+        m_lists.clear();
+        m_source = nullptr;
+        m_cloned = false;
+    }
+
+    auto FramePacket::clear() -> void {
+        vertices.clear();
+        compact_vertices.clear();
+        bindings.clear();
+        commands.clear();
+        cameras.clear();
+        viewport.reset();
+        framebuffer_size.reset();
+        imgui.clear();
+        fence = nullptr;
+    }
+
+}// namespace rosa
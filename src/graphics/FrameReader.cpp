@@ -0,0 +1,212 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/FrameReader.hpp>
+
+#include <GLFW/glfw3.h>
+#include <ProfilerSections.hpp>
+#include <cstring>
+#include <memory>
+#include <tracy/Tracy.hpp>
+
+namespace rosa {
+
+    FrameReader::~FrameReader() {
+        if (glfwGetCurrentContext() == nullptr) {
+            return;
+        }
+
+        try {
+            finish();
+        } catch (...) {
+            // Nobody left to report to
+        }
+
+        for (auto& slot: m_slots) {
+            if (slot.colour_pbo != 0) {
+                glDeleteBuffers(1, &slot.colour_pbo);
+            }
+
+            if (slot.depth_pbo != 0) {
+                glDeleteBuffers(1, &slot.depth_pbo);
+            }
+        }
+    }
+
+    auto FrameReader::request(ReadbackCallback callback, bool depth) -> void {
+        std::lock_guard lock(m_mutex);
+        m_requests.push_back(std::move(callback));
+        m_requests_depth = m_requests_depth || depth;
+    }
+
+    auto FrameReader::request(bool depth) -> std::future<FrameCapture> {
+        auto promise = std::make_shared<std::promise<FrameCapture>>();
+        auto future  = promise->get_future();
+
+        request([promise](const FrameCapture& capture) { promise->set_value(capture); }, depth);
+
+        return future;
+    }
+
+    auto FrameReader::setContinuous(ReadbackCallback callback, bool depth) -> void {
+        std::lock_guard lock(m_mutex);
+        m_continuous       = std::move(callback);
+        m_continuous_depth = depth;
+    }
+
+    auto FrameReader::capture(FrameBuffer& framebuffer) -> void {
+        ZoneScopedNC("FrameReader:Capture", profiler::detail::tracy_colour_framebuffer);
+
+        m_frame++;
+
+        // Oldest first, so callbacks see frames in order
+        for (std::size_t i = 0; i < m_slots.size(); i++) {
+            auto& slot = m_slots[(m_next + i) % m_slots.size()];
+            if (slot.fence != nullptr && slot.frame + readback_latency <= m_frame) {
+                deliver(slot);
+            }
+        }
+
+        std::vector<ReadbackCallback> callbacks{};
+        bool                          depth{false};
+
+        {
+            std::lock_guard lock(m_mutex);
+            callbacks.swap(m_requests);
+            depth            = m_requests_depth;
+            m_requests_depth = false;
+
+            if (m_continuous) {
+                callbacks.push_back(m_continuous);
+                depth = depth || m_continuous_depth;
+            }
+        }
+
+        if (callbacks.empty()) {
+            return;
+        }
+
+        auto& slot = m_slots[m_next];
+        m_next     = (m_next + 1) % m_slots.size();
+
+        slot.callbacks = std::move(callbacks);
+        issue(slot, framebuffer, depth);
+    }
+
+    auto FrameReader::finish() -> void {
+        for (std::size_t i = 0; i < m_slots.size(); i++) {
+            auto& slot = m_slots[(m_next + i) % m_slots.size()];
+            if (slot.fence != nullptr) {
+                deliver(slot);
+            }
+        }
+    }
+
+    auto FrameReader::isCapturing() const -> bool {
+        for (const auto& slot: m_slots) {
+            if (slot.fence != nullptr) {
+                return true;
+            }
+        }
+
+        std::lock_guard lock(m_mutex);
+        return !m_requests.empty() || static_cast<bool>(m_continuous);
+    }
+
+    auto FrameReader::issue(Slot& slot, const FrameBuffer& framebuffer, bool depth) -> void {
+        slot.frame  = m_frame;
+        slot.width  = framebuffer.getWidth();
+        slot.height = framebuffer.getHeight();
+        slot.depth  = depth;
+
+        auto pixels = static_cast<std::size_t>(slot.width) * static_cast<std::size_t>(slot.height);
+
+        // Buffers are only reallocated when the framebuffer changes size
+        auto prepare = [](GLuint& pbo, std::size_t& current_size, std::size_t size) {
+            if (pbo == 0) {
+                glGenBuffers(1, &pbo);
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            if (current_size != size) {
+                glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+                current_size = size;
+            }
+        };
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.getResolvedId());
+
+        prepare(slot.colour_pbo, slot.colour_size, pixels * 4);
+        glReadPixels(0, 0, slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        if (depth) {
+            prepare(slot.depth_pbo, slot.depth_size, pixels * sizeof(float));
+            glReadPixels(0, 0, slot.width, slot.height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    auto FrameReader::deliver(Slot& slot) -> void {
+        ZoneScopedNC("FrameReader:Deliver", profiler::detail::tracy_colour_framebuffer);
+
+        // Normally signalled already, this only waits when the GPU is further behind than readback_latency
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        FrameCapture capture{slot.frame, slot.width, slot.height};
+
+        // GL returns the bottom row first
+        auto copy_rows = [&slot](GLuint pbo, std::size_t size, std::size_t row_size, auto& output) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+
+            const auto* data = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+            if (data == nullptr) {
+                return;
+            }
+
+            output.resize(size / sizeof(output[0]));
+            auto* destination = reinterpret_cast<unsigned char*>(output.data());
+
+            for (int row = 0; row < slot.height; row++) {
+                std::memcpy(destination + static_cast<std::size_t>(row) * row_size, data + static_cast<std::size_t>(slot.height - row - 1) * row_size, row_size);
+            }
+
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        };
+
+        copy_rows(slot.colour_pbo, slot.colour_size, static_cast<std::size_t>(slot.width) * 4, capture.colour);
+
+        if (slot.depth) {
+            copy_rows(slot.depth_pbo, slot.depth_size, static_cast<std::size_t>(slot.width) * sizeof(float), capture.depth);
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        auto callbacks = std::move(slot.callbacks);
+        slot.callbacks.clear();
+
+        for (const auto& callback: callbacks) {
+            callback(capture);
+        }
+    }
+
+}// namespace rosa
@@ -0,0 +1,345 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/FrameRecorder.hpp>
+
+#include <ProfilerSections.hpp>
+#include <algorithm>
+#include <core/Exception.hpp>
+#include <filesystem>
+#include <fmt/format.h>
+#include <lodepng.h>
+#include <spdlog/spdlog.h>
+#include <tracy/Tracy.hpp>
+
+// Windows pipes are text mode unless asked otherwise, POSIX rejects the b
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+constexpr const char* pipe_mode{"wb"};
+#else
+constexpr const char* pipe_mode{"w"};
+#endif
+
+namespace rosa {
+
+    FrameRecorder::~FrameRecorder() {
+        stop();
+    }
+
+    auto FrameRecorder::start(const CaptureSettings& settings) -> void {
+        if (m_pool) {
+            throw Exception("FrameRecorder: Already recording");
+        }
+
+        m_settings            = settings;
+        m_settings.queue_size = std::max<std::size_t>(m_settings.queue_size, 1);
+
+        if (m_settings.format == CaptureFormat::PngSequence) {
+            std::error_code error{};
+            std::filesystem::create_directories(m_settings.path, error);
+            if (error) {
+                throw Exception(fmt::format("FrameRecorder: Unable to create {}: {}", m_settings.path, error.message()));
+            }
+        } else if (m_settings.path.starts_with('|')) {
+            m_file = popen(m_settings.path.substr(1).c_str(), pipe_mode);
+            m_pipe = true;
+        } else {
+            m_file = std::fopen(m_settings.path.c_str(), "wb");
+            m_pipe = false;
+        }
+
+        if (m_settings.format != CaptureFormat::PngSequence && m_file == nullptr) {
+            throw Exception(fmt::format("FrameRecorder: Unable to open {}", m_settings.path));
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.clear();
+            m_next_sequence = 0;
+            m_stream_width  = 0;
+            m_stream_height = 0;
+            m_accepting     = true;
+        }
+
+        m_reorder.clear();
+        m_next_write = 0;
+        m_captured   = 0;
+        m_encoded    = 0;
+        m_dropped    = 0;
+        m_failed     = 0;
+
+        m_pool = std::make_unique<ThreadPool>(std::max<std::size_t>(m_settings.workers, 1));
+
+        spdlog::debug("FrameRecorder: Recording to {}", m_settings.path);
+    }
+
+    auto FrameRecorder::attach(FrameReader& reader) -> void {
+        m_link           = std::make_shared<Link>();
+        m_link->recorder = this;
+        m_reader         = &reader;
+
+        reader.setContinuous([link = m_link](const FrameCapture& capture) {
+            std::lock_guard lock(link->mutex);
+            if (link->recorder != nullptr) {
+                link->recorder->push(capture);
+            }
+        });
+    }
+
+    auto FrameRecorder::push(const FrameCapture& capture) -> bool {
+        ZoneScopedNC("FrameRecorder:Push", profiler::detail::tracy_colour_framebuffer);
+
+        std::unique_lock lock(m_mutex);
+
+        if (!m_accepting) {
+            return false;
+        }
+
+        // A stream can't change size part way through
+        if (m_settings.format != CaptureFormat::PngSequence) {
+            if (m_stream_width == 0) {
+                m_stream_width  = capture.width;
+                m_stream_height = capture.height;
+            } else if (capture.width != m_stream_width || capture.height != m_stream_height) {
+                m_dropped++;
+                return false;
+            }
+        }
+
+        if (m_queue.size() >= m_settings.queue_size) {
+            switch (m_settings.overflow) {
+                case CaptureOverflow::DropNewest:
+                    m_dropped++;
+                    return false;
+                case CaptureOverflow::DropOldest:
+                    m_queue.pop_front();
+                    m_dropped++;
+                    break;
+                case CaptureOverflow::Block:
+                    m_space.wait(lock, [this]() { return m_queue.size() < m_settings.queue_size || !m_accepting; });
+                    if (!m_accepting) {
+                        m_dropped++;
+                        return false;
+                    }
+                    break;
+            }
+        }
+
+        m_queue.push_back({0, capture});
+        m_captured++;
+        lock.unlock();
+
+        // Frames dropped from the front leave a spare job behind, which finds the queue empty
+        m_pool->submit([this]() { encodeNext(); });
+
+        return true;
+    }
+
+    auto FrameRecorder::stop() -> void {
+        if (!m_pool) {
+            return;
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_accepting = false;
+        }
+        m_space.notify_all();
+
+        if (m_link) {
+            std::lock_guard lock(m_link->mutex);
+            m_link->recorder = nullptr;
+        }
+        m_link.reset();
+
+        if (m_reader != nullptr) {
+            m_reader->setContinuous(nullptr);
+            m_reader = nullptr;
+        }
+
+        // Runs whatever is still queued before joining
+        m_pool.reset();
+
+        close();
+
+        auto stats = getStats();
+        spdlog::debug("FrameRecorder: Stopped after {} frames, {} dropped, {} failed", stats.encoded, stats.dropped, stats.failed);
+    }
+
+    auto FrameRecorder::getStats() const -> CaptureStats {
+        return {m_captured, m_encoded, m_dropped, m_failed};
+    }
+
+    auto FrameRecorder::encodeNext() -> void {
+        ZoneScopedNC("FrameRecorder:Encode", profiler::detail::tracy_colour_framebuffer);
+
+        QueuedFrame frame{};
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_queue.empty()) {
+                return;
+            }
+
+            // Numbered as they leave the queue, so dropped frames leave no gaps
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+            frame.sequence = m_next_sequence++;
+        }
+        m_space.notify_one();
+
+        try {
+            encode(frame);
+            m_encoded++;
+        } catch (const std::exception& error) {
+            m_failed++;
+            spdlog::error("FrameRecorder: Frame {} failed: {}", frame.sequence, error.what());
+
+            // Streams wait for every sequence number, so leave an empty placeholder
+            if (m_settings.format != CaptureFormat::PngSequence) {
+                write(frame.sequence, {});
+            }
+        }
+    }
+
+    auto FrameRecorder::encode(QueuedFrame& frame) -> void {
+        const auto& capture = frame.capture;
+
+        switch (m_settings.format) {
+            case CaptureFormat::PngSequence: {
+                std::vector<unsigned char> png{};
+                auto                       width  = static_cast<unsigned>(capture.width);
+                auto                       height = static_cast<unsigned>(capture.height);
+
+                unsigned error = lodepng::encode(png, capture.colour, width, height);
+                if (error == 0) {
+                    auto path = std::filesystem::path(m_settings.path) / fmt::format("frame_{:06}.png", frame.sequence);
+                    error     = lodepng::save_file(png, path.string());
+                }
+
+                if (error != 0) {
+                    throw Exception(fmt::format("PNG encoder error: {} ({})", error, lodepng_error_text(error)));
+                }
+                break;
+            }
+            case CaptureFormat::Raw:
+                write(frame.sequence, std::move(frame.capture.colour));
+                break;
+            case CaptureFormat::Y4m:
+                write(frame.sequence, toY4m(frame));
+                break;
+        }
+    }
+
+    auto FrameRecorder::write(std::uint64_t sequence, std::vector<unsigned char> data) -> void {
+        std::lock_guard lock(m_write_mutex);
+
+        m_reorder.emplace(sequence, std::move(data));
+
+        // Write out everything that is now contiguous
+        for (auto next = m_reorder.begin(); next != m_reorder.end() && next->first == m_next_write; next = m_reorder.begin()) {
+            const auto& bytes = next->second;
+            if (!bytes.empty() && std::fwrite(bytes.data(), 1, bytes.size(), m_file) != bytes.size()) {
+                m_failed++;
+                spdlog::warn("FrameRecorder: Short write of frame {} to {}", next->first, m_settings.path);
+            }
+
+            m_reorder.erase(next);
+            m_next_write++;
+        }
+    }
+
+    auto FrameRecorder::close() -> void {
+        std::lock_guard lock(m_write_mutex);
+
+        if (!m_reorder.empty()) {
+            spdlog::warn("FrameRecorder: {} frames were never written", m_reorder.size());
+            m_reorder.clear();
+        }
+
+        if (m_file == nullptr) {
+            return;
+        }
+
+        if (m_pipe) {
+            pclose(m_file);
+        } else {
+            std::fclose(m_file);
+        }
+
+        m_file = nullptr;
+    }
+
+    auto FrameRecorder::toY4m(const QueuedFrame& frame) const -> std::vector<unsigned char> {
+        const auto& capture = frame.capture;
+
+        auto width         = static_cast<std::size_t>(capture.width);
+        auto height        = static_cast<std::size_t>(capture.height);
+        auto chroma_width  = (width + 1) / 2;
+        auto chroma_height = (height + 1) / 2;
+
+        std::string header{};
+        if (frame.sequence == 0) {
+            header = fmt::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\n", width, height, m_settings.frame_rate);
+        }
+        header += "FRAME\n";
+
+        std::vector<unsigned char> output(header.size() + width * height + chroma_width * chroma_height * 2);
+        std::copy(header.begin(), header.end(), output.begin());
+
+        auto* luma  = output.data() + header.size();
+        auto* blue  = luma + width * height;
+        auto* red   = blue + chroma_width * chroma_height;
+        auto  pixel = [&capture, width](std::size_t x, std::size_t y) { return capture.colour.data() + (y * width + x) * 4; };
+
+        // Full range BT.601 in 8.8 fixed point, which is what C420jpeg describes
+        for (std::size_t y = 0; y < height; y++) {
+            for (std::size_t x = 0; x < width; x++) {
+                const auto* rgba    = pixel(x, y);
+                luma[y * width + x] = static_cast<unsigned char>((77 * rgba[0] + 150 * rgba[1] + 29 * rgba[2] + 128) >> 8);
+            }
+        }
+
+        for (std::size_t y = 0; y < chroma_height; y++) {
+            for (std::size_t x = 0; x < chroma_width; x++) {
+                int r{0};
+                int g{0};
+                int b{0};
+
+                // Average the 2x2 block, repeating the last row or column at odd edges
+                for (std::size_t dy = 0; dy < 2; dy++) {
+                    for (std::size_t dx = 0; dx < 2; dx++) {
+                        const auto* rgba = pixel(std::min(x * 2 + dx, width - 1), std::min(y * 2 + dy, height - 1));
+                        r += rgba[0];
+                        g += rgba[1];
+                        b += rgba[2];
+                    }
+                }
+
+                r /= 4;
+                g /= 4;
+                b /= 4;
+
+                blue[y * chroma_width + x] = static_cast<unsigned char>(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+                red[y * chroma_width + x]  = static_cast<unsigned char>(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+            }
+        }
+
+        return output;
+    }
+
+}// namespace rosa
@@ -0,0 +1,136 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <graphics/GlState.hpp>
+
+namespace rosa {
+
+    auto GlState::current() -> GlState& {
+        thread_local GlState state{};
+        return state;
+    }
+
+    GlState::GlState() {
+        m_textures_2d.fill(unknown);
+        m_texture_arrays.fill(unknown);
+    }
+
+    auto GlState::invalidate() -> void {
+        auto skipped = m_skipped;
+        *this        = GlState();
+        m_skipped    = skipped;
+    }
+
+    auto GlState::useProgram(GLuint program) -> void {
+        if (change(m_program, program)) {
+            glUseProgram(program);
+        }
+    }
+
+    auto GlState::bindVertexArray(GLuint vertex_array) -> void {
+        if (change(m_vertex_array, vertex_array)) {
+            glBindVertexArray(vertex_array);
+        }
+    }
+
+    auto GlState::bindBuffer(GLenum target, GLuint buffer) -> void {
+        if (target == GL_ARRAY_BUFFER) {
+            if (!change(m_array_buffer, buffer)) {
+                return;
+            }
+        } else if (target == GL_UNIFORM_BUFFER) {
+            if (!change(m_uniform_buffer, buffer)) {
+                return;
+            }
+        }
+
+        glBindBuffer(target, buffer);
+    }
+
+    auto GlState::bindUniformRange(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) -> void {
+        if (index < m_uniform_ranges.size()) {
+            auto& range = m_uniform_ranges[index];
+            if (range.buffer == buffer && range.offset == offset && range.size == size) {
+                m_skipped++;
+                return;
+            }
+
+            range = {buffer, offset, size};
+        }
+
+        // Binding a range also binds the generic uniform buffer point
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+        m_uniform_buffer = buffer;
+    }
+
+    auto GlState::bindTexture(GLuint unit, GLenum target, GLuint texture) -> void {
+        if (unit < max_texture_units) {
+            auto& cached = target == GL_TEXTURE_2D_ARRAY ? m_texture_arrays[unit] : m_textures_2d[unit];
+            if (!change(cached, texture)) {
+                return;
+            }
+        }
+
+        if (change(m_active_unit, unit)) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+        }
+
+        glBindTexture(target, texture);
+    }
+
+    auto GlState::setBlend(bool enabled) -> void {
+        if (change(m_blend, static_cast<GLuint>(enabled))) {
+            if (enabled) {
+                glEnable(GL_BLEND);
+            } else {
+                glDisable(GL_BLEND);
+            }
+        }
+    }
+
+    auto GlState::setBlendFunc(GLenum source, GLenum destination) -> void {
+        if (m_blend_source == source && m_blend_destination == destination) {
+            m_skipped++;
+            return;
+        }
+
+        m_blend_source      = source;
+        m_blend_destination = destination;
+        glBlendFunc(source, destination);
+    }
+
+    auto GlState::setDepthTest(bool enabled) -> void {
+        if (change(m_depth_test, static_cast<GLuint>(enabled))) {
+            if (enabled) {
+                glEnable(GL_DEPTH_TEST);
+            } else {
+                glDisable(GL_DEPTH_TEST);
+            }
+        }
+    }
+
+    auto GlState::setDepthMask(bool enabled) -> void {
+        if (change(m_depth_mask, static_cast<GLuint>(enabled))) {
+            glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+        }
+    }
+
+    auto GlState::setDepthFunc(GLenum func) -> void {
+        if (change(m_depth_func, func)) {
+            glDepthFunc(func);
+        }
+    }
+
+}// namespace rosa
@@ -0,0 +1,128 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <graphics/GpuTimer.hpp>
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <limits>
+
+namespace rosa {
+
+    GpuTimer::~GpuTimer() {
+        if (glfwGetCurrentContext() == nullptr) {
+            return;
+        }
+
+        for (auto& frame: m_frames) {
+            if (!frame.queries.empty()) {
+                glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+            }
+        }
+    }
+
+    auto GpuTimer::begin(GpuPass pass) -> int {
+        auto& frame = m_frames[m_current];
+
+        if (!m_enabled || frame.zones >= max_gpu_timer_zones) {
+            return -1;
+        }
+
+        // The pool only grows, queries are reused once their results have been read
+        if (frame.zones * 2 == frame.queries.size()) {
+            frame.queries.resize(frame.queries.size() + 2);
+            glGenQueries(2, &frame.queries[frame.zones * 2]);
+            frame.passes.push_back(pass);
+        } else {
+            frame.passes[frame.zones] = pass;
+        }
+
+        glQueryCounter(frame.queries[frame.zones * 2], GL_TIMESTAMP);
+        return static_cast<int>(frame.zones++);
+    }
+
+    auto GpuTimer::end(int zone) -> void {
+        if (zone < 0) {
+            return;
+        }
+
+        auto& frame = m_frames[m_current];
+        glQueryCounter(frame.queries[static_cast<std::size_t>(zone) * 2 + 1], GL_TIMESTAMP);
+    }
+
+    auto GpuTimer::endFrame() -> void {
+        m_current = (m_current + 1) % m_frames.size();
+
+        // This slot was last filled gpu_timer_latency - 1 frames ago
+        auto& frame = m_frames[m_current];
+        if (frame.zones > 0) {
+            collect(frame);
+            frame.zones = 0;
+        }
+    }
+
+    auto GpuTimer::collect(Frame& frame) -> void {
+        // Timestamps complete in order, so the last one being ready means they all are
+        GLint available{0};
+        glGetQueryObjectiv(frame.queries[frame.zones * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == 0) {
+            return;
+        }
+
+        GpuTimings    timings{};
+        std::uint64_t first{std::numeric_limits<std::uint64_t>::max()};
+        std::uint64_t last{0};
+
+        for (std::size_t i = 0; i < frame.zones; i++) {
+            GLuint64 start{0};
+            GLuint64 finish{0};
+            glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &finish);
+
+            first = std::min<std::uint64_t>(first, start);
+            last  = std::max<std::uint64_t>(last, finish);
+
+            auto elapsed = static_cast<float>(finish > start ? finish - start : 0) / 1000000.F;
+
+            switch (frame.passes[i]) {
+                case GpuPass::Batches:
+                    timings.batches_ms += elapsed;
+                    timings.flush_max_ms = std::max(timings.flush_max_ms, elapsed);
+                    timings.flushes++;
+                    break;
+                case GpuPass::Resolve:
+                    timings.resolve_ms += elapsed;
+                    break;
+                case GpuPass::Blit:
+                    timings.blit_ms += elapsed;
+                    break;
+                case GpuPass::ImGui:
+                    timings.imgui_ms += elapsed;
+                    break;
+            }
+        }
+
+        timings.frame_ms = static_cast<float>(last > first ? last - first : 0) / 1000000.F;
+
+        std::lock_guard lock(m_mutex);
+        m_timings = timings;
+    }
+
+    auto GpuTimer::getTimings() const -> GpuTimings {
+        std::lock_guard lock(m_mutex);
+        return m_timings;
+    }
+
+}// namespace rosa
@@ -0,0 +1,300 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/ProgramCache.hpp>
+
+#include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <fstream>
+#include <graphics/gl.hpp>
+#include <spdlog/spdlog.h>
+#include <system_error>
+#include <utility>
+
+// Program binaries are core in 4.1, above the version the loader is generated for
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace rosa {
+
+    using GetProgramBinaryProc  = void(GLAPIENTRY*)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+    using ProgramBinaryProc     = void(GLAPIENTRY*)(GLuint, GLenum, const void*, GLsizei);
+    using ProgramParameteriProc = void(GLAPIENTRY*)(GLuint, GLenum, GLint);
+
+    static GetProgramBinaryProc  get_program_binary{nullptr};
+    static ProgramBinaryProc     program_binary{nullptr};
+    static ProgramParameteriProc program_parameteri{nullptr};
+
+    // Header written before the binary, all fields in native byte order
+    struct EntryHeader {
+        std::uint32_t magic{program_cache_magic};
+        std::uint32_t version{program_cache_version};
+        std::uint64_t key{0};
+        std::uint32_t format{0};
+        std::uint32_t length{0};
+    };
+
+    ProgramCache::ProgramCache()
+        : m_directory(getDefaultDirectory()) {}
+
+    ProgramCache::ProgramCache(std::filesystem::path directory)
+        : m_directory(std::move(directory)) {}
+
+    auto ProgramCache::getDefaultDirectory() -> std::filesystem::path {
+        if (const auto* xdg_cache = std::getenv("XDG_CACHE_HOME"); xdg_cache != nullptr && *xdg_cache != '\0') {
+            return std::filesystem::path(xdg_cache) / "rosa" / "shaders";
+        }
+
+        if (const auto* local_app_data = std::getenv("LOCALAPPDATA"); local_app_data != nullptr && *local_app_data != '\0') {
+            return std::filesystem::path(local_app_data) / "rosa" / "shaders";
+        }
+
+        if (const auto* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+            return std::filesystem::path(home) / ".cache" / "rosa" / "shaders";
+        }
+
+        std::error_code error{};
+        auto            temp = std::filesystem::temp_directory_path(error);
+        if (error) {
+            return {};
+        }
+
+        return temp / "rosa-shaders";
+    }
+
+    auto ProgramCache::makeKey(std::string_view vertex_source, std::string_view fragment_source, std::string_view driver) -> std::uint64_t {
+        // 64 bit FNV-1a, with a separator so moving text between inputs changes the key
+        std::uint64_t hash{0xcbf29ce484222325ULL};
+
+        auto mix = [&hash](std::string_view text) {
+            for (auto character: text) {
+                hash ^= static_cast<unsigned char>(character);
+                hash *= 0x100000001b3ULL;
+            }
+
+            hash ^= 0xffU;
+            hash *= 0x100000001b3ULL;
+        };
+
+        mix(vertex_source);
+        mix(fragment_source);
+        mix(driver);
+
+        return hash;
+    }
+
+    auto ProgramCache::getDriverString() -> std::string {
+        auto as_string = [](GLenum name) -> std::string {
+            const auto* value = glGetString(name);
+            return value != nullptr ? reinterpret_cast<const char*>(value) : "";
+        };
+
+        return fmt::format("{}\n{}\n{}", as_string(GL_VENDOR), as_string(GL_RENDERER), as_string(GL_VERSION));
+    }
+
+    auto ProgramCache::isSupported() -> bool {
+        std::lock_guard lock(m_mutex);
+        return checkSupport();
+    }
+
+    auto ProgramCache::getHits() const -> int {
+        std::lock_guard lock(m_mutex);
+        return m_hits;
+    }
+
+    auto ProgramCache::getMisses() const -> int {
+        std::lock_guard lock(m_mutex);
+        return m_misses;
+    }
+
+    auto ProgramCache::checkSupport() -> bool {
+        if (m_supported) {
+            return *m_supported;
+        }
+
+        m_supported = false;
+
+        if (m_directory.empty() || glfwGetCurrentContext() == nullptr) {
+            return false;
+        }
+
+        GLint major{0};
+        GLint minor{0};
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+        if ((major < 4 || (major == 4 && minor < 1)) && glfwExtensionSupported("GL_ARB_get_program_binary") == GLFW_FALSE) {
+            spdlog::debug("ProgramCache: Program binaries are not supported by this context");
+            return false;
+        }
+
+        get_program_binary = reinterpret_cast<GetProgramBinaryProc>(glfwGetProcAddress("glGetProgramBinary"));
+        program_binary     = reinterpret_cast<ProgramBinaryProc>(glfwGetProcAddress("glProgramBinary"));
+        program_parameteri = reinterpret_cast<ProgramParameteriProc>(glfwGetProcAddress("glProgramParameteri"));
+
+        // Some drivers advertise the entry points but accept no formats at all
+        GLint formats{0};
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+        m_supported = get_program_binary != nullptr && program_binary != nullptr && program_parameteri != nullptr && formats > 0;
+        return *m_supported;
+    }
+
+    auto ProgramCache::prepare(unsigned int program) -> void {
+        std::lock_guard lock(m_mutex);
+
+        if (checkSupport()) {
+            program_parameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+    }
+
+    auto ProgramCache::load(std::uint64_t key, unsigned int program) -> bool {
+        std::lock_guard lock(m_mutex);
+
+        if (!checkSupport()) {
+            return false;
+        }
+
+        auto binary = read(key);
+        if (!binary) {
+            m_misses++;
+            return false;
+        }
+
+        program_binary(program, binary->format, binary->data.data(), static_cast<GLsizei>(binary->data.size()));
+
+        GLint result{GL_FALSE};
+        glGetProgramiv(program, GL_LINK_STATUS, &result);
+        if (result != GL_TRUE) {
+            spdlog::debug("ProgramCache: Stored binary {:016x} was rejected by the driver", key);
+            m_misses++;
+            return false;
+        }
+
+        m_hits++;
+        return true;
+    }
+
+    auto ProgramCache::store(std::uint64_t key, unsigned int program) -> void {
+        std::lock_guard lock(m_mutex);
+
+        if (!checkSupport()) {
+            return;
+        }
+
+        GLint length{0};
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            return;
+        }
+
+        ProgramBinary binary{};
+        binary.data.resize(static_cast<std::size_t>(length));
+
+        GLenum format{0};
+        get_program_binary(program, length, nullptr, &format, binary.data.data());
+        binary.format = format;
+
+        if (write(key, binary)) {
+            spdlog::debug("ProgramCache: Stored program {:016x}, {} bytes", key, length);
+        }
+    }
+
+    auto ProgramCache::read(std::uint64_t key) const -> std::optional<ProgramBinary> {
+        if (m_directory.empty()) {
+            return std::nullopt;
+        }
+
+        std::ifstream file(getPath(key), std::ios::binary);
+        if (!file) {
+            return std::nullopt;
+        }
+
+        EntryHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file || header.magic != program_cache_magic || header.version != program_cache_version || header.key != key || header.length == 0) {
+            return std::nullopt;
+        }
+
+        ProgramBinary binary{};
+        binary.format = header.format;
+        binary.data.resize(header.length);
+        file.read(reinterpret_cast<char*>(binary.data.data()), static_cast<std::streamsize>(header.length));
+
+        // A short read means the file was truncated
+        if (file.gcount() != static_cast<std::streamsize>(header.length)) {
+            return std::nullopt;
+        }
+
+        return binary;
+    }
+
+    auto ProgramCache::write(std::uint64_t key, const ProgramBinary& binary) const -> bool {
+        if (m_directory.empty() || binary.data.empty()) {
+            return false;
+        }
+
+        std::error_code error{};
+        std::filesystem::create_directories(m_directory, error);
+        if (error) {
+            spdlog::warn("ProgramCache: Unable to create {}: {}", m_directory.string(), error.message());
+            return false;
+        }
+
+        // Write beside the entry and rename over it, so a crash never leaves half a binary
+        auto path      = getPath(key);
+        auto temp_path = path;
+        temp_path += ".tmp";
+
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+
+            EntryHeader header{};
+            header.key    = key;
+            header.format = binary.format;
+            header.length = static_cast<std::uint32_t>(binary.data.size());
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(binary.data.data()), static_cast<std::streamsize>(binary.data.size()));
+
+            if (!file) {
+                spdlog::warn("ProgramCache: Unable to write {}", temp_path.string());
+                file.close();
+                std::filesystem::remove(temp_path, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temp_path, path, error);
+        if (error) {
+            spdlog::warn("ProgramCache: Unable to replace {}: {}", path.string(), error.message());
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    auto ProgramCache::getPath(std::uint64_t key) const -> std::filesystem::path {
+        return m_directory / fmt::format("{:016x}.bin", key);
+    }
+
+}// namespace rosa
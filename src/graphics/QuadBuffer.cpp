@@ -0,0 +1,127 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <GLFW/glfw3.h>
+#include <graphics/GlState.hpp>
+#include <graphics/QuadBuffer.hpp>
+#include <graphics/gl.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace rosa {
+
+    QuadBuffer::QuadBuffer(int capacity, VertexFormat format)
+        : m_capacity(capacity), m_format(format), m_vertices(static_cast<std::size_t>(capacity) * 4) {}
+
+    QuadBuffer::~QuadBuffer() {
+        if (m_vao != 0 && glfwGetCurrentContext() != nullptr) {
+            glDeleteVertexArrays(1, &m_vao);
+            glDeleteBuffers(1, &m_vbo);
+        }
+    }
+
+    auto QuadBuffer::allocate() -> std::optional<int> {
+        int slot{0};
+
+        if (!m_free_slots.empty()) {
+            slot = m_free_slots.back();
+            m_free_slots.pop_back();
+        } else if (m_high_water < m_capacity) {
+            slot = m_high_water++;
+        } else {
+            return std::nullopt;
+        }
+
+        m_count++;
+        return slot;
+    }
+
+    auto QuadBuffer::release(int slot) -> void {
+        std::fill_n(getVertices(slot), 4, Vertex());
+        m_free_slots.push_back(slot);
+        m_count--;
+
+        // Nothing left to draw, start again from the bottom
+        if (m_count == 0) {
+            m_free_slots.clear();
+            m_high_water = 0;
+        }
+    }
+
+    auto QuadBuffer::getVertices(int slot) -> Vertex* {
+        markDirty(slot);
+        return &m_vertices[static_cast<std::size_t>(slot) * 4];
+    }
+
+    auto QuadBuffer::collectDirty(std::vector<Vertex>& vertices) -> std::pair<int, int> {
+        if (m_dirty_end <= m_dirty_begin) {
+            return {0, 0};
+        }
+
+        auto first = m_vertices.begin() + static_cast<std::ptrdiff_t>(m_dirty_begin) * 4;
+        auto last  = m_vertices.begin() + static_cast<std::ptrdiff_t>(m_dirty_end) * 4;
+        vertices.insert(vertices.end(), first, last);
+
+        std::pair<int, int> range{m_dirty_begin, m_dirty_end - m_dirty_begin};
+        m_dirty_begin = 0;
+        m_dirty_end   = 0;
+
+        return range;
+    }
+
+    auto QuadBuffer::uploadRange(int first_quad, int quad_count, const Vertex* vertices, unsigned int index_buffer) -> void {
+        if (m_vao == 0) {
+            glGenVertexArrays(1, &m_vao);
+            glGenBuffers(1, &m_vbo);
+
+            GlState::current().bindVertexArray(m_vao);
+            GlState::current().bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(getVertexSize(m_format) * m_vertices.size()), nullptr, GL_DYNAMIC_DRAW);
+            setupVertexLayout(m_format);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+        }
+
+        auto vertex_count = static_cast<std::size_t>(quad_count) * 4;
+        auto vertex_size  = getVertexSize(m_format);
+
+        GlState::current().bindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(vertex_size * static_cast<std::size_t>(first_quad) * 4),
+                        static_cast<GLsizeiptr>(vertex_size * vertex_count),
+                        stageVertices(vertices, vertex_count, m_format, m_staging));
+    }
+
+    auto QuadBuffer::draw(int quad_count) -> void {
+        if (m_vao == 0 || quad_count == 0) {
+            return;
+        }
+
+        GlState::current().bindVertexArray(m_vao);
+        glDrawElements(GL_TRIANGLES, quad_count * 6, GL_UNSIGNED_SHORT, nullptr);
+    }
+
+    auto QuadBuffer::markDirty(int slot) -> void {
+        if (m_dirty_end <= m_dirty_begin) {
+            m_dirty_begin = slot;
+            m_dirty_end   = slot + 1;
+            return;
+        }
+
+        m_dirty_begin = std::min(m_dirty_begin, slot);
+        m_dirty_end   = std::max(m_dirty_end, slot + 1);
+    }
+
+}// namespace rosa
@@ -14,6 +14,7 @@
  */
 
 #include <algorithm>
+#include <core/ResourceManager.hpp>
 #include <graphics/RenderOverlay.hpp>
 
 namespace rosa {
@@ -48,10 +49,11 @@ namespace rosa {
         std::fill(m_textures.begin(), m_textures.end(), 0);
         std::fill(m_shaders.begin(), m_shaders.end(), 0);
         std::fill(m_fps.begin(), m_fps.end(), 0);
+        std::fill(m_gpu_times.begin(), m_gpu_times.end(), 0);
 
         if (m_visible) {
             ImGui::SetNextWindowPos(ImVec2(0, 0));
-            ImGui::SetNextWindowSize(ImVec2(302, 500));
+            ImGui::SetNextWindowSize(ImVec2(302, 640));
             ImGui::Begin("Renderer Stats", nullptr,
                          ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoBackground);
 
@@ -72,6 +74,7 @@ namespace rosa {
                     m_vertices[index]   = static_cast<float>(entry.vertices);
                     m_textures[index]   = static_cast<float>(entry.textures);
                     m_shaders[index]    = static_cast<float>(entry.shaders);
+                    m_gpu_times[index]  = entry.gpu.frame_ms;
 
                     index++;
                 }
@@ -81,12 +84,23 @@ namespace rosa {
             ImGui::PlotLines("", m_fps.data(), 120, 0, nullptr, 0.F, 1.F, ImVec2(300.F, 50.F));
             ImGui::NewLine();
 
+            ImGui::Text("GPU %.2fms", stats.gpu.frame_ms);
+            ImGui::PlotLines("", m_gpu_times.data(), 120, 0, nullptr, 0.F, 1.F, ImVec2(300.F, 50.F));
+            ImGui::Text("Batches %.2fms (%d draws, slowest %.2fms)", stats.gpu.batches_ms, stats.gpu.flushes, stats.gpu.flush_max_ms);
+            ImGui::Text("Resolve %.2fms Blit %.2fms ImGui %.2fms", stats.gpu.resolve_ms, stats.gpu.blit_ms, stats.gpu.imgui_ms);
+            ImGui::NewLine();
+
             ImGui::Text("Draw Calls %d", stats.draws);
             ImGui::PlotLines("", m_draw_calls.data(), 120, 0, nullptr, 0.F, 1.F, ImVec2(300.F, 50.F));
             ImGui::NewLine();
 
             ImGui::Text("Vertices %d", stats.vertices);
             ImGui::PlotLines("", m_vertices.data(), 120, 0, nullptr, 0.F, 1.F, ImVec2(300.F, 50.F));
+            ImGui::Text("Retained Quads %d (%d updated)", stats.retained, stats.retained_updates);
+            ImGui::Text("Particles %d", stats.particles);
+            ImGui::Text("Static Quads %d", stats.static_quads);
+            ImGui::Text("Mesh Quads %d", stats.meshes);
+            ImGui::Text("Batch Capacity %d", stats.batch_capacity);
             ImGui::NewLine();
 
             ImGui::Text("Texture Binds %d", stats.textures);
@@ -95,6 +109,11 @@ namespace rosa {
 
             ImGui::Text("Shader Binds %d", stats.shaders);
             ImGui::PlotLines("", m_shaders.data(), 120, 0, nullptr, 0.F, 1.F, ImVec2(300.F, 50.F));
+            ImGui::NewLine();
+
+            auto atlas_stats = ResourceManager::getInstance().getAtlasStats();
+            ImGui::Text("Atlases %d (%.1f%% full, %d regions, %d evictions)",
+                        atlas_stats.atlases, atlas_stats.fill_ratio * 100.F, atlas_stats.regions, atlas_stats.evictions);
 
             ImGui::End();
         }
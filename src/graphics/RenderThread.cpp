@@ -0,0 +1,126 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <graphics/RenderThread.hpp>
+
+#include <ProfilerSections.hpp>
+#include <tracy/Tracy.hpp>
+#include <tracy/TracyOpenGL.hpp>
+
+namespace rosa {
+
+    RenderThread::RenderThread(GLFWwindow* context, Executor executor)
+        : m_context(context), m_executor(std::move(executor)) {
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    RenderThread::~RenderThread() {
+        try {
+            finish();
+        } catch (...) {
+            // Nobody left to report to
+        }
+    }
+
+    auto RenderThread::acquire() -> FramePacket& {
+        auto& packet = m_packets[m_recording];
+        packet.clear();
+        return packet;
+    }
+
+    auto RenderThread::submit() -> void {
+        ZoneScopedNC("RenderThread:Submit", profiler::detail::tracy_colour_render);
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() { return !m_in_flight || m_error; });
+            rethrow();
+
+            m_pending   = &m_packets[m_recording];
+            m_in_flight = true;
+        }
+
+        m_condition.notify_all();
+        m_recording = (m_recording + 1) % m_packets.size();
+    }
+
+    auto RenderThread::finish() -> void {
+        if (!m_thread.joinable()) {
+            return;
+        }
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() { return !m_in_flight || m_error; });
+            m_stopping = true;
+        }
+
+        m_condition.notify_all();
+        m_thread.join();
+
+        std::lock_guard lock(m_mutex);
+        rethrow();
+    }
+
+    auto RenderThread::rethrow() -> void {
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+    }
+
+    auto RenderThread::run() -> void {
+        glfwMakeContextCurrent(m_context);
+        TracyGpuContext;
+
+        while (true) {
+            FramePacket* packet{nullptr};
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || m_pending != nullptr; });
+
+                if (m_pending == nullptr) {
+                    break;
+                }
+
+                packet    = m_pending;
+                m_pending = nullptr;
+            }
+
+            std::exception_ptr error{};
+
+            try {
+                m_executor(*packet);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_in_flight = false;
+                m_error     = error;
+            }
+
+            m_condition.notify_all();
+
+            if (error) {
+                break;
+            }
+        }
+
+        glfwMakeContextCurrent(nullptr);
+    }
+
+}// namespace rosa
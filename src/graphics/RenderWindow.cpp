@@ -19,10 +19,13 @@
 #include <core/EventManager.hpp>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <glm/gtc/matrix_transform.hpp>
 #include <graphics/RenderWindow.hpp>
 #include <iostream>
+#include <string_view>
 #include <tracy/TracyOpenGL.hpp>
+#include <utility>
 
 void key_callback(GLFWwindow* /*window*/, int key, int /*scancode*/, int action, int mode) {
     rosa::KeyboardEvent kb_event{};
@@ -66,8 +69,33 @@ void mouse_button_callback(GLFWwindow* /*window*/, int button, int action, int /
 
 namespace rosa {
 
-    RenderWindow::RenderWindow(int width, int height, const std::string& title, int msaa, bool window_hidden) {
-        glfwInit();
+    // Any value other than empty or 0 asks for headless windows
+    static auto headlessRequested() -> bool {
+        const auto* value = std::getenv("ROSA_HEADLESS");
+        return value != nullptr && *value != '\0' && std::string_view(value) != "0";
+    }
+
+    RenderWindow::RenderWindow(int width, int height, const std::string& title, int msaa, bool window_hidden, WindowBackend backend, PresentMode present_mode)
+        : m_backend(headlessRequested() ? WindowBackend::Headless : backend), m_present_mode(present_mode) {
+
+        if (isHeadless()) {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+            throw RenderException("Headless rendering needs GLFW 3.4 or later");
+#endif
+        }
+
+        if (glfwInit() == GLFW_FALSE) {
+            throw RenderException("Failed to initialise GLFW");
+        }
+
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+        // The platform is fixed by whichever window initialised GLFW first
+        if (isHeadless() != (glfwGetPlatform() == GLFW_PLATFORM_NULL)) {
+            throw RenderException("Headless and native windows can't be mixed in one process");
+        }
+#endif
 
         spdlog::debug("RenderWindow: Attempting to create OpenGL context");
 
@@ -75,11 +103,32 @@ namespace rosa {
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-        if (window_hidden) {
+        if (window_hidden || isHeadless()) {
             glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
         }
 
-        m_wnd = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        // Direct presentation draws into the default framebuffer, so it needs the samples as well.
+        // Offscreen frames are blitted and upscaled into it, which a multisampled one would refuse.
+        if (msaa > 1 && !isHeadless() && present_mode == PresentMode::Direct) {
+            glfwWindowHint(GLFW_SAMPLES, msaa);
+        }
+
+        if (isHeadless()) {
+            // Surfaceless EGL first, OSMesa for drivers without it
+            for (auto context_api: {GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API}) {
+                glfwWindowHint(GLFW_CONTEXT_CREATION_API, context_api);
+
+                m_wnd = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+                if (m_wnd != nullptr) {
+                    m_context_api = context_api;
+                    spdlog::debug("RenderWindow: Created headless context with {}", context_api == GLFW_EGL_CONTEXT_API ? "EGL" : "OSMesa");
+                    break;
+                }
+            }
+        } else {
+            m_wnd = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        }
+
         if (m_wnd == nullptr) {
             glfwTerminate();
             throw RenderException("Failed to create the OpenGL context");
@@ -101,8 +150,16 @@ namespace rosa {
             msaa--;
         }
 
+        // Multisample blits to the default framebuffer need matching sample counts
+        if (msaa > 1 && !isHeadless() && present_mode == PresentMode::Direct) {
+            GLint default_samples{0};
+            glGetIntegerv(GL_SAMPLES, &default_samples);
+            if (default_samples > 1) {
+                msaa = default_samples;
+            }
+        }
+
         spdlog::debug("RenderWindow: Multisampling at {}x", msaa);
-        glfwWindowHint(GLFW_SAMPLES, msaa);
 
         TracyGpuContext;
 
@@ -157,7 +214,9 @@ namespace rosa {
         spdlog::debug("RenderWindow: Window resized. New size is {},{}", change_x, change_y);
         m_wnd_size[0] = change_x;
         m_wnd_size[1] = change_y;
-        m_framebuffer.init(change_x, change_y);
+
+        // Rebuilt by whoever owns the context when the next frame is drawn
+        m_framebuffer_resize = m_wnd_size;
 
         m_update_viewport = true;
         m_projection_matrix = glm::ortho(0.F, static_cast<float>(m_wnd_size[0]), static_cast<float>(m_wnd_size[1]), 0.F);
@@ -178,11 +237,21 @@ namespace rosa {
 
     auto RenderWindow::display(glm::vec2 camera_pos) -> void {
         ZoneScopedNC("Render:DisplayWindow", profiler::detail::tracy_colour_render);
+
+        if (auto size = takeFramebufferResize()) {
+            m_framebuffer.init((*size)[0], (*size)[1]);
+        }
+
+        present(updateView(camera_pos));
+    }
+
+    auto RenderWindow::updateView(glm::vec2 camera_pos) -> std::optional<std::array<int, 2>> {
+        std::optional<std::array<int, 2>> viewport{};
+
         if (m_update_viewport) {
-            TracyGpuZone("Update Viewport");
             glfwGetFramebufferSize(m_wnd, &m_vp_size[0], &m_vp_size[1]);
             m_update_viewport = false;
-            glViewport(0, 0, m_vp_size[0], m_vp_size[1]);
+            viewport          = m_vp_size;
         }
 
         if (camera_pos != glm::vec2(0.F, 0.F)) {
@@ -191,17 +260,109 @@ namespace rosa {
 
         m_projection_matrix = glm::ortho(0.F, static_cast<float>(m_wnd_size[0]), static_cast<float>(m_wnd_size[1]), 0.F);
 
+        return viewport;
+    }
+
+    auto RenderWindow::present(std::optional<std::array<int, 2>> viewport) -> void {
+        ZoneScopedNC("Render:Present", profiler::detail::tracy_colour_render);
+
+        if (viewport) {
+            TracyGpuZone("Update Viewport");
+            glViewport(0, 0, (*viewport)[0], (*viewport)[1]);
+        }
+
+        // Without a surface there is nothing to swap
+        if (isHeadless()) {
+            glFlush();
+            return;
+        }
+
         {
             TracyGpuZone("Swap Buffers");
             glfwSwapBuffers(m_wnd);
         }
     }
 
+    auto RenderWindow::needsOffscreen() const -> bool {
+        // Nothing to draw into directly without a surface
+        if (isHeadless() || m_present_mode == PresentMode::Offscreen || m_offscreen_required) {
+            return true;
+        }
+
+        return m_frame_reader.isCapturing();
+    }
+
+    auto RenderWindow::getFrameScale() const -> float {
+        // Anything reading the FrameBuffer expects the whole frame in it at full size
+        if (isHeadless() || m_offscreen_required || m_frame_reader.isCapturing()) {
+            return 1.F;
+        }
+
+        return m_resolution_scaler.getScale();
+    }
+
+    auto RenderWindow::takeFramebufferResize() -> std::optional<std::array<int, 2>> {
+        return std::exchange(m_framebuffer_resize, std::nullopt);
+    }
+
+    auto RenderWindow::createLoaderContext() -> void {
+        if (m_loader != nullptr) {
+            return;
+        }
+
+        m_loader = createSharedContext("loader");
+        glfwMakeContextCurrent(m_loader);
+    }
+
+    auto RenderWindow::destroyLoaderContext() -> void {
+        if (m_loader == nullptr) {
+            return;
+        }
+
+        glfwMakeContextCurrent(m_wnd);
+        glfwDestroyWindow(m_loader);
+        m_loader = nullptr;
+    }
+
+    auto RenderWindow::createCompilerContext() -> GLFWwindow* {
+        if (m_compiler == nullptr) {
+            m_compiler = createSharedContext("compiler");
+        }
+
+        return m_compiler;
+    }
+
+    auto RenderWindow::destroyCompilerContext() -> void {
+        if (m_compiler == nullptr) {
+            return;
+        }
+
+        glfwDestroyWindow(m_compiler);
+        m_compiler = nullptr;
+    }
+
+    auto RenderWindow::createSharedContext(const char* purpose) -> GLFWwindow* {
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, m_context_api);
+
+        auto* context = glfwCreateWindow(1, 1, "", nullptr, m_wnd);
+        if (context == nullptr) {
+            throw RenderException(fmt::format("Failed to create the {} context", purpose));
+        }
+
+        spdlog::debug("RenderWindow: Created shared {} context", purpose);
+        return context;
+    }
+
     auto RenderWindow::clearWindow(Colour colour) -> void {
         ZoneScopedNC("Render:ClearWindow", profiler::detail::tracy_colour_render);
         TracyGpuZone("Clear");
         glClearColor(colour.r, colour.g, colour.b, colour.a);
-        glClear(GL_COLOR_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
     auto RenderWindow::getViewportSize() const -> glm::vec2 {
@@ -243,6 +404,27 @@ namespace rosa {
         return m_view_matrix;
     }
 
+    auto RenderWindow::getViewRect() const -> Rect {
+        // Same combination as Renderer::flushBatch uses for world-space
+        auto world_to_clip = m_view_matrix * m_projection_matrix;
+        auto clip_to_world = glm::inverse(world_to_clip);
+
+        // Renderables sit on the z = 0 plane
+        auto depth = (world_to_clip * glm::vec4(0.F, 0.F, 0.F, 1.F)).z;
+
+        glm::vec2 min_corner{0.F};
+        glm::vec2 max_corner{0.F};
+        for (int corner = 0; corner < 4; corner++) {
+            glm::vec4 point = clip_to_world * glm::vec4((corner & 1) != 0 ? 1.F : -1.F, (corner & 2) != 0 ? 1.F : -1.F, depth, 1.F);
+            glm::vec2 world = glm::vec2(point) / point.w;
+
+            min_corner = corner == 0 ? world : glm::min(min_corner, world);
+            max_corner = corner == 0 ? world : glm::max(max_corner, world);
+        }
+
+        return {min_corner, max_corner - min_corner};
+    }
+
     auto RenderWindow::isKeyDown(Key key) -> bool {
         return glfwGetKey(m_wnd, key);
     }
@@ -15,87 +15,336 @@
 
 #include <GLFW/glfw3.h>
 #include <ProfilerSections.hpp>
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <graphics/GlState.hpp>
 #include <graphics/Renderer.hpp>
 #include <graphics/gl.hpp>
+#include <iterator>
 #include <tracy/Tracy.hpp>
 #include <tracy/TracyOpenGL.hpp>
+#include <utility>
 
 namespace rosa {
 
-    static bool sortByScreenSpace(const Renderable& a, const Renderable& b) {
-        return a.screen_space < b.screen_space;
+    static auto isOpaque(BlendMode blend_mode) -> bool {
+        return blend_mode != BlendMode::Transparent;
     }
 
-    static bool sortByShader(const Renderable& a, const Renderable& b) {
-        return a.shader_program < b.shader_program;
+    // World before screen space, then opaque front to back and transparent back to front,
+    // then by shader. Used with a stable sort, so submission order breaks any tie.
+    static auto drawOrder(const RenderItem& a, const RenderItem& b) -> bool {
+        if (a.screen_space != b.screen_space) {
+            return b.screen_space;
+        }
+
+        if (isOpaque(a.blend_mode) != isOpaque(b.blend_mode)) {
+            return isOpaque(a.blend_mode);
+        }
+
+        if (a.layer != b.layer) {
+            return isOpaque(a.blend_mode) ? a.layer > b.layer : a.layer < b.layer;
+        }
+
+        if (a.blend_mode != b.blend_mode) {
+            return a.blend_mode < b.blend_mode;
+        }
+
+        return a.shader_program->getProgramId() < b.shader_program->getProgramId();
     }
 
-    Renderer::Renderer() {
+    // Opaque draws write depth with blending off, transparent ones only test against it
+    static auto applyBlendState(BlendMode blend_mode, bool depth_test) -> void {
+        auto& state = GlState::current();
 
-        ZoneScopedNC("Renderer:Setup", profiler::detail::tracy_colour_render);
+        state.setBlend(!isOpaque(blend_mode));
+        state.setDepthTest(isOpaque(blend_mode) || depth_test);
+        state.setDepthMask(isOpaque(blend_mode));
 
-        if (glfwGetCurrentContext() == nullptr) {
-            return;
+        // Equal depths pass, so later draws within a layer still cover earlier ones
+        state.setDepthFunc(GL_LEQUAL);
+    }
+
+    // Higher layers are nearer, in normalised device depth
+    static auto layerDepth(int layer) -> float {
+        return -static_cast<float>(layer) / static_cast<float>(max_render_layer + 1);
+    }
+
+    // Find the slot for a texture, assigning the next free one if it isn't bound yet
+    template<std::size_t N>
+    static auto getTextureSlot(std::array<uint32_t, N>& textures, uint32_t& count, uint32_t texture_id) -> uint32_t {
+        for (uint32_t i = 0; i < count; i++) {
+            if (textures[i] == texture_id) {
+                return i;
+            }
         }
 
-        // See destructor for deletion
-        m_vertex_buffer     = new Vertex[max_vertex_count];
-        m_vertex_buffer_ptr = m_vertex_buffer;
+        textures[count] = texture_id;
+        return count++;
+    }
 
-        // Setup opengl
-        glGenVertexArrays(1, &m_vao);
-        glGenBuffers(1, &m_vbo);
+    // Slot for a texture, array textures are offset by max_textures
+    static auto getTextureSlot(TextureBindings& bindings, uint32_t texture_id, int texture_layer) -> float {
+        if (texture_layer < 0) {
+            return static_cast<float>(getTextureSlot(bindings.textures, bindings.texture_count, texture_id));
+        }
 
-        glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        //glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * (m_quads * 4), nullptr, GL_DYNAMIC_DRAW);
+        return static_cast<float>(max_textures + getTextureSlot(bindings.texture_arrays, bindings.texture_array_count, texture_id));
+    }
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, position.x));
+    static auto getTextureSlot(TextureBindings& bindings, const Quad& quad) -> float {
+        return getTextureSlot(bindings, quad.texture_id, quad.texture_layer);
+    }
 
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_TRUE, sizeof(Vertex), (const void*) offsetof(Vertex, texture_coords.x));
+    // Check whether a texture is already bound, or there is a free unit for it
+    static auto hasTextureRoom(const TextureBindings& bindings, uint32_t texture_id, int texture_layer) -> bool {
+        if (texture_layer < 0) {
+            auto end = bindings.textures.begin() + bindings.texture_count;
+            return bindings.texture_count < max_textures || std::find(bindings.textures.begin(), end, texture_id) != end;
+        }
 
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, colour.r));
+        auto end = bindings.texture_arrays.begin() + bindings.texture_array_count;
+        return bindings.texture_array_count < max_texture_arrays || std::find(bindings.texture_arrays.begin(), end, texture_id) != end;
+    }
+
+    static auto hasTextureRoom(const TextureBindings& bindings, const Quad& quad) -> bool {
+        return hasTextureRoom(bindings, quad.texture_id, quad.texture_layer);
+    }
 
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, texture_slot));
+    // Exact comparison, anything that would change the vertices counts as a difference
+    static auto sameRenderable(const Renderable& a, const Renderable& b) -> bool {
+        return a.transform == b.transform &&
+               a.shader_program == b.shader_program &&
+               a.screen_space == b.screen_space &&
+               a.layer == b.layer &&
+               a.blend_mode == b.blend_mode &&
+               a.quad.size == b.quad.size &&
+               a.quad.texture_id == b.quad.texture_id &&
+               a.quad.texture_layer == b.quad.texture_layer &&
+               a.quad.texture_rect_pos == b.quad.texture_rect_pos &&
+               a.quad.texture_rect_size == b.quad.texture_rect_size &&
+               a.quad.colour.r == b.quad.colour.r &&
+               a.quad.colour.g == b.quad.colour.g &&
+               a.quad.colour.b == b.quad.colour.b &&
+               a.quad.colour.a == b.quad.colour.a;
+    }
 
-        // Fill the index array
-        uint32_t offset{0};
-        for (int i = 0; i < max_index_count; i += 6) {
-            m_indices[static_cast<std::uint32_t>(i + 0)] = 0 + offset;
-            m_indices[static_cast<std::uint32_t>(i + 1)] = 1 + offset;
-            m_indices[static_cast<std::uint32_t>(i + 2)] = 2 + offset;
+    // Quads are written straight into the format they are uploaded in, these cover what differs
+    static auto setCorner(Vertex& vertex, glm::vec2 position, glm::vec2 texture_coords) -> void {
+        vertex.position       = position;
+        vertex.texture_coords = texture_coords;
+    }
 
-            m_indices[static_cast<std::uint32_t>(i + 3)] = 1 + offset;
-            m_indices[static_cast<std::uint32_t>(i + 4)] = 2 + offset;
-            m_indices[static_cast<std::uint32_t>(i + 5)] = 3 + offset;
+    static auto setCorner(CompactVertex& vertex, glm::vec2 position, glm::vec2 texture_coords) -> void {
+        vertex.position       = position;
+        vertex.texture_coords = packTextureCoords(texture_coords);
+    }
 
-            offset += 4;
+    // Set what the 4 corners of a quad share
+    static auto setShared(Vertex* quad, const Colour& colour, float texture_slot, float texture_layer, float depth) -> void {
+        for (int corner = 0; corner < 4; corner++) {
+            quad[corner].colour        = colour;
+            quad[corner].texture_slot  = texture_slot;
+            quad[corner].texture_layer = texture_layer;
+            quad[corner].depth         = depth;
         }
+    }
 
-        m_textures.fill(0);
+    static auto setShared(CompactVertex* quad, const Colour& colour, float texture_slot, float texture_layer, float depth) -> void {
+        auto packed = packColour(colour);
+        for (int corner = 0; corner < 4; corner++) {
+            quad[corner].colour        = packed;
+            quad[corner].texture_slot  = static_cast<std::uint8_t>(texture_slot);
+            quad[corner].texture_layer = static_cast<std::uint16_t>(texture_layer);
+            quad[corner].depth         = depth;
+        }
+    }
 
-        glGenBuffers(1, &m_ibo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * max_index_count, m_indices.data(), GL_STATIC_DRAW);
+    static auto storeVertex(Vertex& target, const Vertex& vertex) -> void {
+        target = vertex;
     }
 
+    static auto storeVertex(CompactVertex& target, const Vertex& vertex) -> void {
+        target = packVertex(vertex);
+    }
+
+    // Make room for count vertices in the packet storage of a format and hand build the first of them
+    template<typename Build>
+    static auto appendVertices(FramePacket& packet, VertexFormat format, std::size_t count, Build&& build) -> void {
+        if (format == VertexFormat::Compact) {
+            auto first = packet.compact_vertices.size();
+            packet.compact_vertices.resize(first + count);
+            build(packet.compact_vertices.data() + first);
+        } else {
+            auto first = packet.vertices.size();
+            packet.vertices.resize(first + count);
+            build(packet.vertices.data() + first);
+        }
+    }
+
+    static auto vertexCount(const FramePacket& packet, VertexFormat format) -> std::size_t {
+        return format == VertexFormat::Compact ? packet.compact_vertices.size() : packet.vertices.size();
+    }
+
+    static auto packetVertices(const FramePacket& packet, VertexFormat format, std::size_t first) -> const void* {
+        return format == VertexFormat::Compact ? static_cast<const void*>(&packet.compact_vertices[first]) : static_cast<const void*>(&packet.vertices[first]);
+    }
+
+    // Write the 4 vertices of an item, its axes and origin already carry the object transform
+    template<typename V>
+    static auto writeItem(V* vertices, const RenderItem& item) -> void {
+        auto half_x = item.axis_x * (item.size.x / 2.F);
+        auto half_y = item.axis_y * (item.size.y / 2.F);
+
+        setCorner(vertices[0], item.origin - half_x - half_y, item.texture_rect_pos);
+        setCorner(vertices[1], item.origin + half_x - half_y, {item.texture_rect_pos.x + item.texture_rect_size.x, item.texture_rect_pos.y});
+        setCorner(vertices[2], item.origin - half_x + half_y, {item.texture_rect_pos.x, item.texture_rect_pos.y + item.texture_rect_size.y});
+        setCorner(vertices[3], item.origin + half_x + half_y, item.texture_rect_pos + item.texture_rect_size);
+
+        setShared(vertices, item.colour, static_cast<float>(item.texture_slot), static_cast<float>(std::max<int>(item.texture_layer, 0)), layerDepth(item.layer));
+    }
+
+    // Write the 4 vertices of a renderable, taking the object transform into account
+    static auto writeQuad(Vertex* vertices, const Renderable& renderable) -> void {
+        writeItem(vertices, RenderItem::fromRenderable(renderable));
+    }
+
+    auto RenderItem::fromRenderable(const Renderable& renderable) -> RenderItem {
+        const auto& transform = renderable.transform;
+
+        // Corners are placed at (x, y, 1, 1), so the z column lands in the origin too
+        return {.axis_x            = {transform[0].x, transform[0].y},
+                .axis_y            = {transform[1].x, transform[1].y},
+                .origin            = {transform[2].x + transform[3].x, transform[2].y + transform[3].y},
+                .size              = renderable.quad.size,
+                .texture_rect_pos  = renderable.quad.texture_rect_pos,
+                .texture_rect_size = renderable.quad.texture_rect_size,
+                .colour            = renderable.quad.colour,
+                .shader_program    = renderable.shader_program,
+                .texture_id        = renderable.quad.texture_id,
+                .texture_layer     = static_cast<std::int16_t>(std::max(renderable.quad.texture_layer, -1)),
+                .layer             = static_cast<std::int16_t>(std::clamp(renderable.layer, -max_render_layer, max_render_layer)),
+                .blend_mode        = renderable.blend_mode,
+                .screen_space      = renderable.screen_space,
+                .texture_slot      = static_cast<std::uint8_t>(renderable.texture_index)};
+    }
+
+    Renderer::Renderer() {
+        // The queue never holds more than a batch, so it only grows with the capacity
+        m_items.reserve(m_batch_capacity);
+    }
+
+
     Renderer::~Renderer() {
 
-        if (glfwGetCurrentContext() == nullptr) {
+        m_retained.clear();
+        m_retained_groups.clear();
+
+        if (m_vaos[0] == 0 || glfwGetCurrentContext() == nullptr) {
             return;
         }
 
-        glDeleteVertexArrays(1, &m_vao);
-        glDeleteBuffers(1, &m_vbo);
+        glDeleteVertexArrays(vertex_format_count, m_vaos.data());
+        glDeleteBuffers(vertex_format_count, m_vbos.data());
         glDeleteBuffers(1, &m_ibo);
+        glDeleteBuffers(1, &m_camera_ubo);
+        glDeleteVertexArrays(vertex_format_count, m_stream_vaos.data());
+        glDeleteBuffers(vertex_format_count, m_stream_vbos.data());
+    }
+
+    auto Renderer::createGlObjects() -> void {
+        ZoneScopedNC("Renderer:Setup", profiler::detail::tracy_colour_render);
+
+        // Created on first use rather than in the constructor, as vertex arrays can't be
+        // shared and only the thread executing packets is guaranteed the right context
+        glGenVertexArrays(vertex_format_count, m_vaos.data());
+        glGenBuffers(vertex_format_count, m_vbos.data());
+
+        // Bound through the state cache, like everywhere else, so it stays in step with GL
+        auto& state = GlState::current();
+
+        glGenBuffers(1, &m_ibo);
+        ensureIndices(default_batch_quads);
+
+        // Particle batches and meshes are streamed into their own buffers, sharing the index buffer
+        glGenVertexArrays(vertex_format_count, m_stream_vaos.data());
+        glGenBuffers(vertex_format_count, m_stream_vbos.data());
+
+        for (std::size_t i = 0; i < vertex_format_count; i++) {
+            auto format = static_cast<VertexFormat>(i);
 
-        delete[] m_vertex_buffer;
+            state.bindVertexArray(m_vaos[i]);
+            state.bindBuffer(GL_ARRAY_BUFFER, m_vbos[i]);
+            setupVertexLayout(format);
+            state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+
+            state.bindVertexArray(m_stream_vaos[i]);
+            state.bindBuffer(GL_ARRAY_BUFFER, m_stream_vbos[i]);
+            setupVertexLayout(format);
+            state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+        }
+
+        // Each camera matrix sits at an offset the uniform buffer can be bound at
+        GLint alignment{256};
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        m_camera_stride = ((static_cast<GLsizeiptr>(sizeof(glm::mat4)) + alignment - 1) / alignment) * alignment;
+
+        glGenBuffers(1, &m_camera_ubo);
+    }
+
+    auto Renderer::ensureIndices(std::size_t quad_count) -> void {
+        quad_count = std::min<std::size_t>(quad_count, max_indexed_quads);
+        if (quad_count <= m_index_quads) {
+            return;
+        }
+
+        // Grow in powers of two so a rising batch size doesn't regenerate every frame
+        m_index_quads = std::min<std::size_t>(std::bit_ceil(quad_count), max_indexed_quads);
+
+        // Every quad uses the same pattern, drawn with a base vertex wherever it starts
+        std::vector<uint16_t> indices(m_index_quads * 6);
+        uint16_t              offset{0};
+        for (std::size_t i = 0; i < indices.size(); i += 6) {
+            indices[i + 0] = static_cast<uint16_t>(0 + offset);
+            indices[i + 1] = static_cast<uint16_t>(1 + offset);
+            indices[i + 2] = static_cast<uint16_t>(2 + offset);
+
+            indices[i + 3] = static_cast<uint16_t>(1 + offset);
+            indices[i + 4] = static_cast<uint16_t>(2 + offset);
+            indices[i + 5] = static_cast<uint16_t>(3 + offset);
+
+            offset = static_cast<uint16_t>(offset + 4);
+        }
+
+        // Vertex arrays refer to the buffer by name, so refilling it keeps them all valid
+        GlState::current().bindVertexArray(m_vaos[0]);
+        GlState::current().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(uint16_t) * indices.size()), indices.data(), GL_STATIC_DRAW);
+    }
+
+    auto Renderer::drawQuads(std::size_t first_quad, std::size_t quad_count) -> void {
+        // 16 bit indices only reach max_indexed_quads quads, so long ranges are drawn in slices
+        for (std::size_t drawn = 0; drawn < quad_count; drawn += max_indexed_quads) {
+            auto quads = std::min<std::size_t>(quad_count - drawn, max_indexed_quads);
+            glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(quads * 6), GL_UNSIGNED_SHORT, nullptr, static_cast<GLint>((first_quad + drawn) * 4));
+        }
+    }
+
+    auto Renderer::uploadCameras(const FramePacket& packet) -> void {
+        if (packet.cameras.empty()) {
+            return;
+        }
+
+        m_camera_staging.resize(static_cast<std::size_t>(m_camera_stride) * packet.cameras.size());
+        for (std::size_t i = 0; i < packet.cameras.size(); i++) {
+            std::memcpy(&m_camera_staging[i * static_cast<std::size_t>(m_camera_stride)], &packet.cameras[i][0][0], sizeof(glm::mat4));
+        }
+
+        GlState::current().bindBuffer(GL_UNIFORM_BUFFER, m_camera_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(m_camera_staging.size()), m_camera_staging.data(), GL_STREAM_DRAW);
     }
 
     auto Renderer::makeShaderProgram(const Uuid& vertex_shader, const Uuid& fragment_shader) -> ShaderProgram* {
@@ -105,184 +354,932 @@ namespace rosa {
             return nullptr;
         }
 
-        for (const auto& program: m_shaders) {
-            if (program->getVertexShaderUuid() == vertex_shader && program->getFragmentShaderUuid() == fragment_shader) {
-                return program.get();
-            }
+        auto existing = m_shaders.find({vertex_shader, fragment_shader});
+        if (existing != m_shaders.end()) {
+            return existing->second.get();
         }
 
-        auto program = m_shaders.emplace(m_shaders.end(), std::make_unique<ShaderProgram>(vertex_shader, fragment_shader));
-        program->get()->compile();
+        // Only keep the program once it has compiled, or is compiling in the background
+        auto program = std::make_unique<ShaderProgram>(vertex_shader, fragment_shader);
+        m_shader_compiler.enqueue(*program);
 
-        return program->get();
+        return m_shaders.emplace(std::make_pair(vertex_shader, fragment_shader), std::move(program)).first->second.get();
     }
 
-    auto Renderer::submit(Renderable renderable) -> void {
+    auto Renderer::submit(const Renderable& renderable) -> void {
         ZoneScopedNC("Renderer:Submit", profiler::detail::tracy_colour_render);
 
-        assert(renderable.shader_program->isCompiled());
+        queueItem(RenderItem::fromRenderable(renderable));
+    }
 
-        if (m_renderables.size() >= max_quad_count || m_texture_count > 31) {
+    auto Renderer::submit(std::span<const RenderItem> items) -> void {
+        ZoneScopedNC("Renderer:Submit", profiler::detail::tracy_colour_render);
+
+        for (const auto& item: items) {
+            queueItem(item);
+        }
+    }
+
+    auto Renderer::queueItem(RenderItem item) -> void {
+        if (!resolveShaderProgram(item.shader_program)) {
+            return;
+        }
+
+        if (m_items.size() >= static_cast<std::size_t>(m_batch_capacity)) {
+            m_frame_overflow = true;
+            flushBatch();
+        } else if (!hasTextureRoom(m_bindings, item.texture_id, item.texture_layer)) {
             flushBatch();
         }
 
-        //float texture_index{0.F};
-        for (uint32_t i = 1; i < m_texture_count; i++) {
-            if (m_textures[i] == renderable.quad.texture_id) {
-                renderable.texture_index = static_cast<float>(i);
-                break;
+        item.texture_slot = static_cast<std::uint8_t>(getTextureSlot(m_bindings, item.texture_id, item.texture_layer));
+        item.layer        = static_cast<std::int16_t>(std::clamp<int>(item.layer, -max_render_layer, max_render_layer));
+
+        m_items.push_back(item);
+    }
+
+    auto Renderer::submitRetained(const Uuid& key, Renderable renderable) -> void {
+        ZoneScopedNC("Renderer:SubmitRetained", profiler::detail::tracy_colour_render);
+
+        if (!resolveShaderProgram(renderable.shader_program)) {
+            return;
+        }
+
+        renderable.layer = std::clamp(renderable.layer, -max_render_layer, max_render_layer);
+
+        auto [entry, inserted] = m_retained.try_emplace(key);
+        auto& retained         = entry->second;
+        retained.frame         = m_frame;
+
+        if (!inserted && sameRenderable(retained.renderable, renderable)) {
+            return;
+        }
+
+        placeRetained(renderable, retained);
+    }
+
+    auto Renderer::submitParticles(const ParticleBatch& batch) -> void {
+        ZoneScopedNC("Renderer:SubmitParticles", profiler::detail::tracy_colour_render);
+
+        if (batch.count == 0 || batch.shader_program == nullptr) {
+            return;
+        }
+
+        auto* shader_program = batch.shader_program;
+        if (!resolveShaderProgram(shader_program)) {
+            return;
+        }
+
+        auto& pending = appendStream({.shader_program = shader_program,
+                                      .layer          = std::clamp(batch.layer, -max_render_layer, max_render_layer),
+                                      .blend_mode     = batch.blend_mode,
+                                      .count          = batch.count},
+                                     batch.quad);
+
+        auto texture_slot  = getTextureSlot(pending.bindings, batch.quad);
+        auto texture_layer = static_cast<float>(std::max(batch.quad.texture_layer, 0));
+        auto depth         = layerDepth(pending.layer);
+        auto uv_min        = batch.quad.texture_rect_pos;
+        auto uv_max        = batch.quad.texture_rect_pos + batch.quad.texture_rect_size;
+
+        appendVertices(*m_packet, shader_program->getVertexFormat(), batch.count * 4, [&](auto* vertices) {
+            auto build_range = [&, vertices](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    auto  half   = batch.size[i] / 2.F;
+                    auto  left   = batch.position_x[i] - half;
+                    auto  right  = batch.position_x[i] + half;
+                    auto  top    = batch.position_y[i] - half;
+                    auto  bottom = batch.position_y[i] + half;
+                    auto* quad   = vertices + i * 4;
+
+                    setCorner(quad[0], {left, top}, uv_min);
+                    setCorner(quad[1], {right, top}, {uv_max.x, uv_min.y});
+                    setCorner(quad[2], {left, bottom}, {uv_min.x, uv_max.y});
+                    setCorner(quad[3], {right, bottom}, uv_max);
+
+                    setShared(quad, batch.colour[i], texture_slot, texture_layer, depth);
+                }
+            };
+
+            if (m_thread_pool) {
+                m_thread_pool->parallelFor(batch.count, min_parallel_particles, build_range);
+            } else {
+                build_range(0, batch.count);
+            }
+        });
+    }
+
+    auto Renderer::submitMesh(const MeshBatch& batch) -> void {
+        ZoneScopedNC("Renderer:SubmitMesh", profiler::detail::tracy_colour_render);
+
+        if (batch.count == 0 || batch.shader_program == nullptr) {
+            return;
+        }
+
+        auto* shader_program = batch.shader_program;
+        if (!resolveShaderProgram(shader_program)) {
+            return;
+        }
+
+        auto& pending = appendStream({.shader_program = shader_program,
+                                      .screen_space   = batch.screen_space,
+                                      .mesh           = true,
+                                      .layer          = std::clamp(batch.layer, -max_render_layer, max_render_layer),
+                                      .blend_mode     = batch.blend_mode,
+                                      .count          = batch.count},
+                                     batch.quad);
+
+        auto texture_slot  = getTextureSlot(pending.bindings, batch.quad);
+        auto texture_layer = static_cast<float>(std::max(batch.quad.texture_layer, 0));
+        auto depth         = layerDepth(pending.layer);
+
+        // One transform for the whole block, rather than one per quad
+        appendVertices(*m_packet, shader_program->getVertexFormat(), batch.count * 4, [&](auto* vertices) {
+            auto build_range = [&, vertices](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin * 4; i < end * 4; i++) {
+                    auto vertex          = batch.vertices[i];
+                    vertex.position      = batch.transform * glm::vec4(vertex.position, 1.F, 1.F);
+                    vertex.texture_slot  = texture_slot;
+                    vertex.texture_layer = texture_layer;
+                    vertex.depth         = depth;
+                    storeVertex(vertices[i], vertex);
+                }
+            };
+
+            if (m_thread_pool) {
+                m_thread_pool->parallelFor(batch.count, min_parallel_quads, build_range);
+            } else {
+                build_range(0, batch.count);
             }
+        });
+    }
+
+    auto Renderer::appendStream(const PendingStream& stream, const Quad& quad) -> PendingStream& {
+        // Consecutive labels or emitters drawn the same way share one upload and one draw, as
+        // long as their vertices follow on in the packet
+        auto end = vertexCount(*m_packet, stream.shader_program->getVertexFormat());
+        if (!m_streams.empty()) {
+            auto& last = m_streams.back();
+            if (last.shader_program == stream.shader_program && last.screen_space == stream.screen_space &&
+                last.mesh == stream.mesh && last.layer == stream.layer && last.blend_mode == stream.blend_mode &&
+                last.first_vertex + last.count * 4 == end && hasTextureRoom(last.bindings, quad)) {
+                last.count += stream.count;
+                return last;
+            }
+        }
+
+        auto& pending        = m_streams.emplace_back(stream);
+        pending.first_vertex = end;
+        return pending;
+    }
+
+    auto Renderer::createStaticBuffer(int capacity, VertexFormat format) -> std::shared_ptr<QuadBuffer> {
+        return m_static_buffers.emplace_back(std::make_shared<QuadBuffer>(std::min(capacity, max_indexed_quads), format));
+    }
+
+    auto Renderer::submitStatic(const StaticBatch& batch) -> void {
+        ZoneScopedNC("Renderer:SubmitStatic", profiler::detail::tracy_colour_render);
+
+        if (batch.buffer == nullptr || batch.shader_program == nullptr || batch.buffer->getHighWater() == 0) {
+            return;
+        }
+
+        auto* shader_program = batch.shader_program;
+        if (!resolveShaderProgram(shader_program)) {
+            return;
         }
 
-        if (renderable.texture_index == 0.F) {
-            renderable.texture_index    = static_cast<float>(m_texture_count);
-            m_textures[m_texture_count] = renderable.quad.texture_id;
-            m_texture_count++;
+        // Only quads rewritten since the buffer was last submitted are sent
+        auto source              = m_packet->vertices.size();
+        auto [first, quad_count] = batch.buffer->collectDirty(m_packet->vertices);
+        if (quad_count > 0) {
+            m_packet->commands.push_back({.type   = RenderCommandType::RetainedUpload,
+                                          .first  = static_cast<std::size_t>(first),
+                                          .count  = static_cast<std::size_t>(quad_count),
+                                          .source = source,
+                                          .target = batch.buffer});
         }
 
-        m_renderables.push_back(renderable);
+        // A pending program drawn with the fallback can't read a buffer laid out for another format
+        if (shader_program->getVertexFormat() != batch.buffer->getVertexFormat()) {
+            return;
+        }
+
+        auto& pending          = m_static.emplace_back();
+        pending.buffer         = batch.buffer;
+        pending.shader_program = shader_program;
+        pending.layer          = std::clamp(batch.layer, -max_render_layer, max_render_layer);
+        pending.blend_mode     = batch.blend_mode;
+        getTextureSlot(pending.bindings, batch.quad);
+    }
+
+    auto Renderer::bakeQuad(Vertex* vertices, Renderable renderable) -> void {
+        // A static batch binds nothing but its own texture
+        renderable.texture_index = renderable.quad.texture_layer < 0 ? 0.F : static_cast<float>(max_textures);
+        renderable.layer         = std::clamp(renderable.layer, -max_render_layer, max_render_layer);
+
+        writeQuad(vertices, renderable);
+    }
+
+    auto Renderer::resolveShaderProgram(ShaderProgram*& shader_program) -> bool {
+        if (shader_program->isCompiled()) {
+            return true;
+        }
+
+        if (m_pending_shader_policy == PendingShaderPolicy::Skip) {
+            return false;
+        }
+
+        // The default shaders are tiny, so they are always compiled straight away
+        if (!m_fallback_program) {
+            m_fallback_program = std::make_unique<ShaderProgram>();
+            m_fallback_program->compile(&m_program_cache);
+        }
+
+        shader_program = m_fallback_program.get();
+        return true;
+    }
+
+    auto Renderer::placeRetained(const Renderable& renderable, RetainedQuad& retained) -> void {
+        auto fits = [&renderable](const RetainedGroup& group) {
+            return group.shader_program == renderable.shader_program &&
+                   group.screen_space == renderable.screen_space &&
+                   group.layer == renderable.layer &&
+                   group.blend_mode == renderable.blend_mode &&
+                   hasTextureRoom(group.bindings, renderable.quad);
+        };
+
+        // Stay in the current slot where possible, otherwise move to a group that can take it
+        if (retained.slot >= 0 && !fits(m_retained_groups[retained.group])) {
+            releaseRetained(retained);
+        }
+
+        if (retained.slot < 0) {
+            for (std::size_t i = 0; i < m_retained_groups.size() && retained.slot < 0; i++) {
+                auto& group = m_retained_groups[i];
+                if (!fits(group)) {
+                    continue;
+                }
+
+                if (auto slot = group.buffer->allocate()) {
+                    retained.group = i;
+                    retained.slot  = *slot;
+                }
+            }
+
+            if (retained.slot < 0) {
+                auto& group          = m_retained_groups.emplace_back();
+                group.shader_program = renderable.shader_program;
+                group.screen_space   = renderable.screen_space;
+                group.layer          = renderable.layer;
+                group.blend_mode     = renderable.blend_mode;
+                group.buffer         = std::make_unique<QuadBuffer>(default_batch_quads, renderable.shader_program->getVertexFormat());
+
+                retained.group = m_retained_groups.size() - 1;
+                retained.slot  = *group.buffer->allocate();
+            }
+        }
+
+        auto& group                       = m_retained_groups[retained.group];
+        retained.renderable               = renderable;
+        retained.renderable.texture_index = getTextureSlot(group.bindings, renderable.quad);
+
+        writeQuad(group.buffer->getVertices(retained.slot), retained.renderable);
+        m_retained_updates++;
+    }
+
+    auto Renderer::releaseRetained(RetainedQuad& retained) -> void {
+        auto& group = m_retained_groups[retained.group];
+        group.buffer->release(retained.slot);
+        retained.slot = -1;
+
+        // Textures are only dropped from a group once it empties
+        if (group.buffer->getCount() == 0) {
+            group.bindings = {};
+        }
+    }
+
+    auto Renderer::nextLayer(bool screen_space, int max_layer) const -> std::optional<int> {
+        std::optional<int> layer{};
+        auto               consider = [&](int candidate) {
+            if (candidate <= max_layer && (!layer || candidate < *layer)) {
+                layer = candidate;
+            }
+        };
+
+        for (auto index: m_retained_pending) {
+            const auto& group = m_retained_groups[index];
+            if (group.screen_space == screen_space && !isOpaque(group.blend_mode)) {
+                consider(group.layer);
+            }
+        }
+
+        for (const auto& stream: m_streams) {
+            if (stream.screen_space == screen_space) {
+                consider(stream.layer);
+            }
+        }
+
+        // Static geometry is only ever in world space
+        if (!screen_space) {
+            for (const auto& pending: m_static) {
+                if (!isOpaque(pending.blend_mode)) {
+                    consider(pending.layer);
+                }
+            }
+        }
+
+        return layer;
+    }
+
+    auto Renderer::drawLayered(bool screen_space, int max_layer, std::size_t camera) -> bool {
+        bool drawn{false};
+
+        // Everything on one layer goes before anything on the next, whichever kind it is
+        while (auto layer = nextLayer(screen_space, max_layer)) {
+            drawn = drawRetained(screen_space, false, *layer, camera) || drawn;
+            drawn = (!screen_space && drawStatic(false, *layer, camera)) || drawn;
+            drawn = drawStreams(screen_space, *layer, camera) || drawn;
+        }
+
+        return drawn;
+    }
+
+    auto Renderer::drawRetained(bool screen_space, bool opaque, int max_layer, std::size_t camera) -> bool {
+        bool drawn{false};
+
+        // Pending groups are in ascending layer order, opaque ones are drawn front to back
+        auto draw_group = [&](std::size_t index) {
+            auto& group = m_retained_groups[index];
+            if (group.screen_space != screen_space || isOpaque(group.blend_mode) != opaque || group.layer > max_layer) {
+                return false;
+            }
+
+            bindTextures(group.bindings);
+
+            m_packet->commands.push_back({.type            = RenderCommandType::RetainedDraw,
+                                          .program         = group.shader_program->getProgramId(),
+                                          .mvp_id          = group.shader_program->getMvpId(),
+                                          .alpha_cutoff_id = group.shader_program->getAlphaCutoffId(),
+                                          .camera          = camera,
+                                          .blend_mode      = group.blend_mode,
+                                          .depth_test      = m_depth_written,
+                                          .count           = static_cast<std::size_t>(group.buffer->getHighWater()),
+                                          .target          = group.buffer.get()});
+
+            m_depth_written = m_depth_written || opaque;
+            m_retained_draws += group.buffer->getCount();
+            m_draw_calls++;
+            m_shader_changes++;
+            drawn = true;
+            return true;
+        };
+
+        if (opaque) {
+            std::vector<std::size_t> remaining{};
+            for (auto index = m_retained_pending.rbegin(); index != m_retained_pending.rend(); ++index) {
+                if (!draw_group(*index)) {
+                    remaining.insert(remaining.begin(), *index);
+                }
+            }
+            m_retained_pending = std::move(remaining);
+        } else {
+            std::erase_if(m_retained_pending, draw_group);
+        }
+
+        return drawn;
+    }
+
+    auto Renderer::drawStatic(bool opaque, int max_layer, std::size_t camera) -> bool {
+        auto in_range = [opaque, max_layer](const PendingStatic& pending) {
+            return isOpaque(pending.blend_mode) == opaque && pending.layer <= max_layer;
+        };
+
+        if (std::none_of(m_static.begin(), m_static.end(), in_range)) {
+            return false;
+        }
+
+        // Statics were sorted when the batch was flushed
+        for (const auto& pending: m_static) {
+            if (!in_range(pending)) {
+                continue;
+            }
+
+            bindTextures(pending.bindings);
+
+            m_packet->commands.push_back({.type            = RenderCommandType::RetainedDraw,
+                                          .program         = pending.shader_program->getProgramId(),
+                                          .mvp_id          = pending.shader_program->getMvpId(),
+                                          .alpha_cutoff_id = pending.shader_program->getAlphaCutoffId(),
+                                          .camera          = camera,
+                                          .blend_mode      = pending.blend_mode,
+                                          .depth_test      = m_depth_written,
+                                          .count           = static_cast<std::size_t>(pending.buffer->getHighWater()),
+                                          .target          = pending.buffer});
+
+            m_depth_written = m_depth_written || isOpaque(pending.blend_mode);
+            m_static_draws += pending.buffer->getCount();
+            m_draw_calls++;
+            m_shader_changes++;
+        }
+
+        std::erase_if(m_static, in_range);
+        return true;
+    }
+
+    auto Renderer::drawStreams(bool screen_space, int max_layer, std::size_t camera) -> bool {
+        auto in_range = [screen_space, max_layer](const PendingStream& stream) {
+            return stream.screen_space == screen_space && stream.layer <= max_layer;
+        };
+
+        if (std::none_of(m_streams.begin(), m_streams.end(), in_range)) {
+            return false;
+        }
+
+        // Streams were sorted back to front when the batch was flushed
+        for (const auto& stream: m_streams) {
+            if (!in_range(stream)) {
+                continue;
+            }
+
+            bindTextures(stream.bindings);
+
+            m_packet->commands.push_back({.type            = RenderCommandType::StreamDraw,
+                                          .program         = stream.shader_program->getProgramId(),
+                                          .mvp_id          = stream.shader_program->getMvpId(),
+                                          .alpha_cutoff_id = stream.shader_program->getAlphaCutoffId(),
+                                          .camera          = camera,
+                                          .blend_mode      = stream.blend_mode,
+                                          .depth_test      = m_depth_written,
+                                          .vertex_format   = stream.shader_program->getVertexFormat(),
+                                          .first           = stream.first_vertex,
+                                          .count           = stream.count});
+
+            m_depth_written = m_depth_written || isOpaque(stream.blend_mode);
+            m_draw_calls += static_cast<int>((stream.count + max_indexed_quads - 1) / max_indexed_quads);
+            (stream.mesh ? m_mesh_draws : m_particle_draws) += static_cast<int>(stream.count);
+            m_shader_changes++;
+        }
+
+        std::erase_if(m_streams, in_range);
+        return true;
+    }
+
+    auto Renderer::bindTextures(const TextureBindings& bindings) -> void {
+        m_packet->bindings.push_back(bindings);
+        m_packet->commands.push_back({.type = RenderCommandType::BindTextures, .first = m_packet->bindings.size() - 1});
+        m_texture_binds += static_cast<int>(bindings.texture_count + bindings.texture_array_count);
+    }
+
+    auto Renderer::flushFrame() -> void {
+        ZoneScopedNC("Renderer:FlushFrame", profiler::detail::tracy_colour_render);
+
+        // Programs finished here are used from the next frame
+        m_shader_compiler.update();
+
+        // Static buffers only referenced here have been dropped by their owner. They wait a
+        // frame, so no packet still being recorded or executed can refer to them, then the
+        // executing thread frees them after its current packet.
+        {
+            std::scoped_lock lock(m_released_mutex);
+            std::move(m_retiring_buffers.begin(), m_retiring_buffers.end(), std::back_inserter(m_released_buffers));
+        }
+
+        m_retiring_buffers.clear();
+        std::erase_if(m_static_buffers, [this](std::shared_ptr<QuadBuffer>& buffer) {
+            if (buffer.use_count() > 1) {
+                return false;
+            }
+
+            m_retiring_buffers.push_back(std::move(buffer));
+            return true;
+        });
+
+        for (auto entry = m_retained.begin(); entry != m_retained.end();) {
+            if (entry->second.frame != m_frame) {
+                releaseRetained(entry->second);
+                entry = m_retained.erase(entry);
+            } else {
+                ++entry;
+            }
+        }
+
+        // Hand the changed parts of each retained buffer over for upload
+        for (auto& group: m_retained_groups) {
+            auto source              = m_packet->vertices.size();
+            auto [first, quad_count] = group.buffer->collectDirty(m_packet->vertices);
+            if (quad_count == 0) {
+                continue;
+            }
+
+            m_packet->commands.push_back({.type   = RenderCommandType::RetainedUpload,
+                                          .first  = static_cast<std::size_t>(first),
+                                          .count  = static_cast<std::size_t>(quad_count),
+                                          .source = source,
+                                          .target = group.buffer.get()});
+        }
+
+        m_draw_retained = true;
+        flushBatch();
+        m_draw_retained = false;
+
+        // Switch to screen space once, after every world space batch of the frame. Dynamic
+        // resolution upscales the world here, so it can't happen between two batches.
+        m_packet->commands.push_back({.type = RenderCommandType::ScreenSpace});
+
+        // Screen space draws over the world, whatever its layers
+        if (m_depth_written) {
+            m_packet->commands.push_back({.type = RenderCommandType::ClearDepth});
+        }
+
+        m_packet->commands.insert(m_packet->commands.end(), m_screen_commands.begin(), m_screen_commands.end());
+        m_screen_commands.clear();
+
+        if (m_packet == &m_immediate_packet) {
+            execute(m_immediate_packet);
+            m_immediate_packet.clear();
+        }
+
+        // The next frame starts from a cleared depth buffer
+        m_depth_written        = false;
+        m_screen_depth_written = false;
+
+        // A frame that overflowed the queue grows it to fit, so a steady scene settles into
+        // as few batches as the textures it binds allow
+        if (m_adaptive_batching && m_frame_overflow) {
+            setBatchCapacity(static_cast<int>(std::min<std::size_t>(std::bit_ceil(m_frame_queued), max_batch_quads)));
+        }
+
+        m_frame_queued   = 0;
+        m_frame_overflow = false;
+
+        m_frame++;
     }
 
     auto Renderer::flushBatch() -> void {
         ZoneScopedNC("Renderer:FlushBatch", profiler::detail::tracy_colour_render);
 
-        // bind active textures
-        unsigned int i{0};
-        for (auto texture_id: m_textures) {
-            if (texture_id != 0) {
-                glActiveTexture(GL_TEXTURE0 + i);
-                glBindTexture(GL_TEXTURE_2D, texture_id);
-                m_texture_binds++;
-                i++;
+        std::stable_sort(m_items.begin(), m_items.end(), drawOrder);
+
+        // Every renderable owns 4 consecutive vertices, so the whole queue can be built up
+        // front, independently of how it is split into draws below. Each format the batch is
+        // drawn with needs its own copy of the vertices.
+        std::array<std::size_t, vertex_format_count> first_vertex{};
+        for (std::size_t i = 0; i < vertex_format_count; i++) {
+            auto format = static_cast<VertexFormat>(i);
+            if (std::any_of(m_items.begin(), m_items.end(), [format](const RenderItem& item) { return item.shader_program->getVertexFormat() == format; })) {
+                first_vertex[i] = vertexCount(*m_packet, format);
+                buildVertices(format);
             }
         }
 
-        // sort renderables by world space first, then screen space
-        auto ss_group_start = m_renderables.begin();
-        while (ss_group_start != m_renderables.end()) {
-            auto ss_group_end = std::upper_bound(
-                    ss_group_start, m_renderables.end(),
-                    *ss_group_start, sortByScreenSpace);
-
-            // Within this, sort by shader program
-            std::sort(ss_group_start, ss_group_end, sortByShader);
+        m_retained_pending.clear();
+        if (m_draw_retained) {
+            for (std::size_t i = 0; i < m_retained_groups.size(); i++) {
+                if (m_retained_groups[i].buffer->getCount() > 0) {
+                    m_retained_pending.push_back(i);
+                }
+            }
 
-            ss_group_start = ss_group_end;
+            std::stable_sort(m_retained_pending.begin(), m_retained_pending.end(), [this](std::size_t a, std::size_t b) {
+                return m_retained_groups[a].layer < m_retained_groups[b].layer;
+            });
         }
 
-        // If we're rendering in screen space, use an orthographic projection of the screen
-        // If it's world space, use the regular MVP
+        // Back to front, like the rest of the transparent pass
+        std::stable_sort(m_streams.begin(), m_streams.end(), [](const PendingStream& a, const PendingStream& b) {
+            return a.layer < b.layer;
+        });
+
+        // Opaque statics front to back, transparent ones back to front
+        std::stable_sort(m_static.begin(), m_static.end(), [](const PendingStatic& a, const PendingStatic& b) {
+            if (isOpaque(a.blend_mode) != isOpaque(b.blend_mode)) {
+                return isOpaque(a.blend_mode);
+            }
+
+            return isOpaque(a.blend_mode) ? a.layer > b.layer : a.layer < b.layer;
+        });
 
         unsigned int current_shader_id{0};
-        glm::mat4    current_transform{1.F};
-        int          current_mvp_id{-1};
-        glm::mat4    current_mvp{m_view_matrix * m_projection_matrix};
-        bool         screen_space{false};
+        std::size_t  space_start{0};
+        bool         rebind{false};
+
+        for (bool screen_space: {false, true}) {
+            // If we're rendering in screen space, use an orthographic projection of the screen
+            // If it's world space, use the regular MVP
+            auto camera    = getCameraSlot(screen_space ? m_projection_matrix : m_view_matrix * m_projection_matrix);
+            auto space_end = screen_space ? m_items.size() : space_start;
+            while (space_end < m_items.size() && !m_items[space_end].screen_space) {
+                space_end++;
+            }
+
+            // Screen space is set aside until flushFrame(), so everything in world space is
+            // drawn first even when the frame flushes early. It keeps its own depth state.
+            auto space_commands = m_packet->commands.size();
+            if (screen_space) {
+                std::swap(m_depth_written, m_screen_depth_written);
+            }
 
-        for (auto& renderable: m_renderables) {
+            // Each space uploads its own part of the queue, so either can be drawn on its own
+            if (space_end > space_start) {
+                bindTextures(m_bindings);
 
-            // Check for the switch between world and screen space
-            if (!screen_space && renderable.screen_space) {
-                if (m_index_count > 0) {
-                    flush(current_shader_id, current_mvp, current_mvp_id);
+                std::array<bool, vertex_format_count> formats{};
+                for (std::size_t i = space_start; i < space_end; i++) {
+                    formats[static_cast<std::size_t>(m_items[i].shader_program->getVertexFormat())] = true;
                 }
-                current_mvp  = m_projection_matrix;
-                screen_space = true;
+
+                for (std::size_t i = 0; i < vertex_format_count; i++) {
+                    if (formats[i]) {
+                        m_packet->commands.push_back({.type          = RenderCommandType::Upload,
+                                                      .vertex_format = static_cast<VertexFormat>(i),
+                                                      .first         = first_vertex[i] + space_start * 4,
+                                                      .count         = (space_end - space_start) * 4});
+                    }
+                }
+            }
+
+            rebind = drawRetained(screen_space, true, max_render_layer, camera) || rebind;
+
+            // Transparent statics are interleaved by layer with everything else below
+            if (!screen_space) {
+                rebind = drawStatic(true, max_render_layer, camera) || rebind;
             }
 
-            // Whenever we encounter a different shader program, flush the cache (assuming there is
-            // anything in there).
-            if (renderable.shader_program->getProgramId() != current_shader_id) {
-                if (m_index_count > 0) {
-                    flush(current_shader_id, current_mvp, current_mvp_id);
+            // Lowest layer still waiting to be interleaved with the transparent queue
+            auto layered = nextLayer(screen_space, max_render_layer);
+
+            std::size_t range_start{space_start};
+            for (std::size_t i = space_start; i < space_end; i++) {
+                const auto& item = m_items[i];
+
+                // Transparent retained groups, statics and streams on lower layers have to be drawn
+                // first, those on this layer follow the queued items like they were submitted after
+                bool layered_below = item.blend_mode == BlendMode::Transparent && layered && *layered < item.layer;
+
+                // Whenever we encounter a different shader program or blend mode, draw everything before it
+                const auto& first = m_items[range_start];
+                if (i > range_start && (layered_below || first.shader_program != item.shader_program || first.blend_mode != item.blend_mode)) {
+                    flush(first, camera, range_start - space_start, i - range_start);
+                    range_start = i;
+                }
+
+                if (layered_below) {
+                    rebind  = drawLayered(screen_space, item.layer - 1, camera) || rebind;
+                    layered = nextLayer(screen_space, max_render_layer);
                 }
-                current_shader_id = renderable.shader_program->getProgramId();
-                current_mvp_id    = renderable.shader_program->getMvpId();
-                m_shader_changes++;
+
+                // Retained groups, statics and streams bind their own textures
+                if (rebind) {
+                    bindTextures(m_bindings);
+                    current_shader_id = 0;
+                    rebind            = false;
+                }
+
+                if (item.shader_program->getProgramId() != current_shader_id) {
+                    current_shader_id = item.shader_program->getProgramId();
+                    m_shader_changes++;
+                }
+            }
+
+            // Draw the last range if there is anything left
+            if (space_end > range_start) {
+                flush(m_items[range_start], camera, range_start - space_start, space_end - range_start);
             }
 
-            // Calculate the positions for each of the 4 vertices, taking the object transform
-            // into account.
-            glm::vec2 top_left = renderable.transform *
-                                 glm::vec4(-(renderable.quad.size.x / 2.F),
-                                           -(renderable.quad.size.y / 2.F),
-                                           1.F, 1.F);
-
-            glm::vec2 top_right = renderable.transform *
-                                  glm::vec4((renderable.quad.size.x / 2.F),
-                                            -(renderable.quad.size.y / 2.F),
-                                            1.F, 1.F);
-
-            glm::vec2 bottom_left = renderable.transform *
-                                    glm::vec4(-(renderable.quad.size.x / 2.F),
-                                              (renderable.quad.size.y / 2.F),
-                                              1.F, 1.F);
-
-            glm::vec2 bottom_right = renderable.transform *
-                                     glm::vec4((renderable.quad.size.x / 2.F),
-                                               (renderable.quad.size.y / 2.F),
-                                               1.F, 1.F);
-
-            // Populate the vertex cache with data from the quad
-            m_vertex_buffer_ptr->position       = top_left;
-            m_vertex_buffer_ptr->colour         = renderable.quad.colour;
-            m_vertex_buffer_ptr->texture_coords = renderable.quad.texture_rect_pos;
-            m_vertex_buffer_ptr->texture_slot   = renderable.texture_index;
-            m_vertex_buffer_ptr++;
-
-            m_vertex_buffer_ptr->position       = top_right;
-            m_vertex_buffer_ptr->colour         = renderable.quad.colour;
-            m_vertex_buffer_ptr->texture_coords = {renderable.quad.texture_rect_pos.x + renderable.quad.texture_rect_size.x, renderable.quad.texture_rect_pos.y};
-            m_vertex_buffer_ptr->texture_slot   = renderable.texture_index;
-            m_vertex_buffer_ptr++;
-
-            m_vertex_buffer_ptr->position       = bottom_left;
-            m_vertex_buffer_ptr->colour         = renderable.quad.colour;
-            m_vertex_buffer_ptr->texture_coords = {renderable.quad.texture_rect_pos.x, renderable.quad.texture_rect_pos.y + renderable.quad.texture_rect_size.y};
-            m_vertex_buffer_ptr->texture_slot   = renderable.texture_index;
-            m_vertex_buffer_ptr++;
-
-            m_vertex_buffer_ptr->position       = bottom_right;
-            m_vertex_buffer_ptr->colour         = renderable.quad.colour;
-            m_vertex_buffer_ptr->texture_coords = renderable.quad.texture_rect_pos + renderable.quad.texture_rect_size;
-            m_vertex_buffer_ptr->texture_slot   = renderable.texture_index;
-            m_vertex_buffer_ptr++;
-
-            m_index_count += 6;
-            m_quad_draws++;
-        }
-
-        // Flush the cache one last time if there is anything to render
-        if (m_index_count > 0) {
-            flush(current_shader_id, current_mvp, current_mvp_id);
+            rebind = drawLayered(screen_space, max_render_layer, camera) || rebind;
+
+            if (screen_space) {
+                std::swap(m_depth_written, m_screen_depth_written);
+
+                auto begin = m_packet->commands.begin() + static_cast<std::ptrdiff_t>(space_commands);
+                m_screen_commands.insert(m_screen_commands.end(), begin, m_packet->commands.end());
+                m_packet->commands.erase(begin, m_packet->commands.end());
+            }
+
+            space_start = space_end;
         }
 
+        m_quad_draws += static_cast<int>(m_items.size());
+        m_frame_queued += m_items.size();
+
         // Clear the render queue
-        m_renderables.clear();
+        m_items.clear();
+        m_bindings = {};
+
+        // Set aside screen space commands still refer to the vertices, bindings and cameras
+        // recorded so far, so the immediate packet only drops its commands until the frame ends
+        if (m_packet == &m_immediate_packet) {
+            execute(m_immediate_packet);
+            m_immediate_packet.commands.clear();
+        }
+    }
+
+    auto Renderer::buildVertices(VertexFormat format) -> void {
+        ZoneScopedNC("Renderer:BuildVertices", profiler::detail::tracy_colour_render);
+
+        appendVertices(*m_packet, format, m_items.size() * 4, [this](auto* vertices) {
+            auto build_range = [this, vertices](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    writeItem(vertices + i * 4, m_items[i]);
+                }
+            };
+
+            // Workers write disjoint ranges, so the result is the same as building in order
+            if (m_thread_pool) {
+                m_thread_pool->parallelFor(m_items.size(), min_parallel_quads, build_range);
+            } else {
+                build_range(0, m_items.size());
+            }
+        });
+    }
+
+    auto Renderer::setVertexThreads(std::size_t thread_count) -> void {
+        if (thread_count == 0) {
+            m_thread_pool.reset();
+            return;
+        }
+
+        if (!m_thread_pool || m_thread_pool->getThreadCount() != thread_count) {
+            m_thread_pool = std::make_unique<ThreadPool>(thread_count);
+        }
     }
 
-    auto Renderer::flush(unsigned int shader_program_id, glm::mat4 mvp, int mvp_id) -> void {
-        ZoneScopedNC("Renderer:Flush", profiler::detail::tracy_colour_render);
-        TracyGpuZone("Flush");
+    auto Renderer::getVertexThreads() const -> std::size_t {
+        return m_thread_pool ? m_thread_pool->getThreadCount() : 0;
+    }
+
+    auto Renderer::setBatchCapacity(int quad_count) -> void {
+        m_batch_capacity = std::clamp(quad_count, 1, max_batch_quads);
+        m_items.reserve(m_batch_capacity);
+    }
+
+    auto Renderer::getCameraSlot(const glm::mat4& mvp) -> std::size_t {
+        auto& cameras = m_packet->cameras;
+
+        auto existing = std::find(cameras.begin(), cameras.end(), mvp);
+        if (existing != cameras.end()) {
+            return static_cast<std::size_t>(existing - cameras.begin());
+        }
+
+        cameras.push_back(mvp);
+        return cameras.size() - 1;
+    }
+
+    auto Renderer::flush(const RenderItem& item, std::size_t camera, std::size_t first_quad, std::size_t quad_count) -> void {
+        m_packet->commands.push_back({.type            = RenderCommandType::Draw,
+                                      .program         = item.shader_program->getProgramId(),
+                                      .mvp_id          = item.shader_program->getMvpId(),
+                                      .alpha_cutoff_id = item.shader_program->getAlphaCutoffId(),
+                                      .camera          = camera,
+                                      .blend_mode      = item.blend_mode,
+                                      .depth_test      = m_depth_written,
+                                      .vertex_format   = item.shader_program->getVertexFormat(),
+                                      .first           = first_quad,
+                                      .count           = quad_count});
+
+        m_depth_written = m_depth_written || isOpaque(item.blend_mode);
+        m_draw_calls += static_cast<int>((quad_count + max_indexed_quads - 1) / max_indexed_quads);
+    }
+
+    auto Renderer::beginPacket(FramePacket* packet) -> void {
+        m_packet = packet;
+    }
+
+    auto Renderer::endPacket() -> void {
+        m_packet = &m_immediate_packet;
+    }
+
+    auto Renderer::execute(const FramePacket& packet, const std::function<void()>& begin_screen_space) -> void {
+        ZoneScopedNC("Renderer:Execute", profiler::detail::tracy_colour_render);
+
+        if (packet.commands.empty()) {
+            return;
+        }
+
+        // Anything outside the renderer may have changed state since the last packet
+        auto& state = GlState::current();
+        state.invalidate();
+
+        if (m_vaos[0] == 0) {
+            createGlObjects();
+        }
+
+        uploadCameras(packet);
 
-        glUseProgram(shader_program_id);
-        glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * (static_cast<std::uint32_t>(m_quad_draws * 4)), m_vertex_buffer, GL_DYNAMIC_DRAW);
+        // Programs with a plain mvp uniform, and the camera they last received
+        std::vector<std::pair<GLuint, std::size_t>> legacy_cameras{};
 
-        glUniformMatrix4fv(mvp_id, 1, GL_FALSE, &mvp[0][0]);
+        auto prepare_draw = [&](const RenderCommand& command) {
+            state.useProgram(command.program);
 
-        glDrawElements(GL_TRIANGLES, m_index_count, GL_UNSIGNED_INT, nullptr);
+            if (command.mvp_id >= 0) {
+                auto existing = std::find_if(legacy_cameras.begin(), legacy_cameras.end(), [&](const auto& entry) { return entry.first == command.program; });
+                if (existing == legacy_cameras.end() || existing->second != command.camera) {
+                    glUniformMatrix4fv(command.mvp_id, 1, GL_FALSE, &packet.cameras[command.camera][0][0]);
 
-        m_index_count       = 0;
-        m_texture_count     = 0;
-        m_vertex_buffer_ptr = m_vertex_buffer;
+                    if (existing == legacy_cameras.end()) {
+                        legacy_cameras.emplace_back(command.program, command.camera);
+                    } else {
+                        existing->second = command.camera;
+                    }
+                }
+            } else {
+                state.bindUniformRange(camera_uniform_binding, m_camera_ubo, static_cast<GLintptr>(command.camera) * m_camera_stride, sizeof(glm::mat4));
+            }
+
+            applyBlendState(command.blend_mode, command.depth_test);
+
+            if (command.alpha_cutoff_id >= 0) {
+                glUniform1f(command.alpha_cutoff_id, command.blend_mode == BlendMode::AlphaTested ? 0.5F : 0.F);
+            }
+        };
+
+        for (const auto& command: packet.commands) {
+            switch (command.type) {
+                case RenderCommandType::BindTextures: {
+                    const auto& bindings = packet.bindings[command.first];
+                    for (uint32_t i = 0; i < bindings.texture_count; i++) {
+                        state.bindTexture(i, GL_TEXTURE_2D, bindings.textures[i]);
+                    }
+
+                    // Array textures go in the units after them
+                    for (uint32_t i = 0; i < bindings.texture_array_count; i++) {
+                        state.bindTexture(max_textures + i, GL_TEXTURE_2D_ARRAY, bindings.texture_arrays[i]);
+                    }
+                    break;
+                }
+                case RenderCommandType::Upload: {
+                    auto format = static_cast<std::size_t>(command.vertex_format);
+                    state.bindBuffer(GL_ARRAY_BUFFER, m_vbos[format]);
+                    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(getVertexSize(command.vertex_format) * command.count),
+                                 packetVertices(packet, command.vertex_format, command.first), GL_DYNAMIC_DRAW);
+                    break;
+                }
+                case RenderCommandType::Draw: {
+                    ZoneScopedNC("Renderer:Flush", profiler::detail::tracy_colour_render);
+                    TracyGpuZone("Flush");
 
-        m_draw_calls++;
+                    GpuTimerZone gpu_zone(m_gpu_timer, GpuPass::Batches);
+
+                    prepare_draw(command);
+                    ensureIndices(command.count);
+                    state.bindVertexArray(m_vaos[static_cast<std::size_t>(command.vertex_format)]);
+                    drawQuads(command.first, command.count);
+                    break;
+                }
+                case RenderCommandType::RetainedUpload:
+                    command.target->uploadRange(static_cast<int>(command.first), static_cast<int>(command.count), &packet.vertices[command.source], m_ibo);
+                    break;
+                case RenderCommandType::RetainedDraw: {
+                    ZoneScopedNC("Renderer:DrawRetained", profiler::detail::tracy_colour_render);
+                    GpuTimerZone gpu_zone(m_gpu_timer, GpuPass::Batches);
+
+                    prepare_draw(command);
+                    ensureIndices(command.count);
+                    command.target->draw(static_cast<int>(command.count));
+                    break;
+                }
+                case RenderCommandType::StreamDraw: {
+                    ZoneScopedNC("Renderer:DrawStream", profiler::detail::tracy_colour_render);
+                    GpuTimerZone gpu_zone(m_gpu_timer, GpuPass::Batches);
+
+                    prepare_draw(command);
+                    state.bindVertexArray(m_stream_vaos[static_cast<std::size_t>(command.vertex_format)]);
+                    state.bindBuffer(GL_ARRAY_BUFFER, m_stream_vbos[static_cast<std::size_t>(command.vertex_format)]);
+                    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(getVertexSize(command.vertex_format) * command.count * 4),
+                                 packetVertices(packet, command.vertex_format, command.first), GL_STREAM_DRAW);
+                    ensureIndices(command.count);
+                    state.bindVertexArray(m_stream_vaos[static_cast<std::size_t>(command.vertex_format)]);
+                    drawQuads(0, command.count);
+                    break;
+                }
+                case RenderCommandType::ClearDepth:
+                    state.setDepthMask(true);
+                    glClear(GL_DEPTH_BUFFER_BIT);
+                    break;
+                case RenderCommandType::ScreenSpace:
+                    if (begin_screen_space) {
+                        begin_screen_space();
+                    }
+                    break;
+            }
+        }
+
+        // Leave the default blended state for anything drawn after the renderer
+        applyBlendState(BlendMode::Transparent, false);
+        state.setDepthMask(true);
+
+        // Anything released was last drawn by an earlier packet, or by this one
+        std::vector<std::shared_ptr<QuadBuffer>> released{};
+        {
+            std::scoped_lock lock(m_released_mutex);
+            released.swap(m_released_buffers);
+        }
     }
 
     auto Renderer::getStats() -> RendererStats {
-        return {m_draw_calls, m_quad_draws * 4, m_texture_binds, m_shader_changes};
+        return {m_draw_calls, (m_quad_draws + m_retained_draws + m_particle_draws + m_static_draws + m_mesh_draws) * 4, m_texture_binds, m_shader_changes, m_retained_draws, m_retained_updates, m_particle_draws, m_static_draws, m_mesh_draws, m_batch_capacity, m_gpu_timer.getTimings()};
     }
 
     auto Renderer::clearStats() -> void {
@@ -290,6 +1287,12 @@ namespace rosa {
         m_quad_draws     = 0;
         m_texture_binds  = 0;
         m_shader_changes = 0;
+
+        m_retained_draws   = 0;
+        m_retained_updates = 0;
+        m_particle_draws   = 0;
+        m_static_draws     = 0;
+        m_mesh_draws       = 0;
     }
 
     std::unique_ptr<Renderer> Renderer::s_instance{nullptr};
@@ -0,0 +1,94 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/ResolutionScaler.hpp>
+
+#include <algorithm>
+
+namespace rosa {
+
+    auto ResolutionScaler::setSettings(const DynamicResolution& settings) -> void {
+        std::lock_guard lock(m_mutex);
+
+        m_settings                = settings;
+        m_settings.max_scale      = std::clamp(m_settings.max_scale, 0.1F, 1.F);
+        m_settings.min_scale      = std::clamp(m_settings.min_scale, 0.1F, m_settings.max_scale);
+        m_settings.average_frames = std::max<std::size_t>(m_settings.average_frames, 1);
+
+        m_scale = m_settings.max_scale;
+        m_samples.clear();
+        m_next = 0;
+        m_sum  = 0.F;
+    }
+
+    auto ResolutionScaler::getSettings() const -> DynamicResolution {
+        std::lock_guard lock(m_mutex);
+        return m_settings;
+    }
+
+    auto ResolutionScaler::addFrame(float frame_ms) -> void {
+        std::lock_guard lock(m_mutex);
+
+        if (!m_settings.enabled || frame_ms <= 0.F) {
+            return;
+        }
+
+        if (m_samples.size() < m_settings.average_frames) {
+            m_samples.push_back(frame_ms);
+        } else {
+            m_sum -= m_samples[m_next];
+            m_samples[m_next] = frame_ms;
+            m_next            = (m_next + 1) % m_samples.size();
+        }
+        m_sum += frame_ms;
+
+        if (m_samples.size() < m_settings.average_frames) {
+            return;
+        }
+
+        auto average = m_sum / static_cast<float>(m_samples.size());
+        auto scale   = m_scale;
+
+        if (average > m_settings.target_ms * 1.05F) {
+            scale = std::max(m_settings.min_scale, m_scale - m_settings.step);
+        } else if (average < m_settings.target_ms * 0.8F) {
+            scale = std::min(m_settings.max_scale, m_scale + m_settings.step);
+        }
+
+        if (scale != m_scale) {
+            m_scale = scale;
+            m_samples.clear();
+            m_next = 0;
+            m_sum  = 0.F;
+        }
+    }
+
+    auto ResolutionScaler::getScale() const -> float {
+        std::lock_guard lock(m_mutex);
+        return m_settings.enabled ? m_scale : 1.F;
+    }
+
+    auto ResolutionScaler::getAverage() const -> float {
+        std::lock_guard lock(m_mutex);
+
+        if (m_samples.empty()) {
+            return 0.F;
+        }
+
+        return m_sum / static_cast<float>(m_samples.size());
+    }
+
+}// namespace rosa
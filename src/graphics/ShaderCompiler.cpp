@@ -0,0 +1,202 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/ShaderCompiler.hpp>
+
+#include <ProfilerSections.hpp>
+#include <core/Exception.hpp>
+#include <graphics/gl.hpp>
+#include <spdlog/spdlog.h>
+#include <tracy/Tracy.hpp>
+
+namespace rosa {
+
+    using MaxShaderCompilerThreadsProc = void(GLAPIENTRY*)(GLuint);
+
+    ShaderCompiler::ShaderCompiler(ProgramCache& cache)
+        : m_cache(cache) {}
+
+    ShaderCompiler::~ShaderCompiler() {
+        try {
+            stop();
+        } catch (...) {
+            // Nobody left to report to
+        }
+    }
+
+    auto ShaderCompiler::isParallelSupported() -> bool {
+        if (glfwGetCurrentContext() == nullptr) {
+            return false;
+        }
+
+        return glfwExtensionSupported("GL_KHR_parallel_shader_compile") == GLFW_TRUE ||
+               glfwExtensionSupported("GL_ARB_parallel_shader_compile") == GLFW_TRUE;
+    }
+
+    auto ShaderCompiler::start(GLFWwindow* worker_context) -> void {
+        stop();
+
+        if (isParallelSupported()) {
+            auto max_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+            if (max_threads == nullptr) {
+                max_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+            }
+
+            // Let the driver use as many threads as it likes
+            if (max_threads != nullptr) {
+                max_threads(0xFFFFFFFF);
+            }
+
+            m_mode = ShaderCompileMode::Parallel;
+            spdlog::info("ShaderCompiler: Using parallel shader compilation");
+            return;
+        }
+
+        if (worker_context != nullptr) {
+            m_mode     = ShaderCompileMode::Worker;
+            m_context  = worker_context;
+            m_stopping = false;
+            m_thread   = std::thread([this]() { run(); });
+            spdlog::info("ShaderCompiler: Compiling shaders on a worker thread");
+            return;
+        }
+
+        spdlog::info("ShaderCompiler: No asynchronous compilation available, compiling synchronously");
+    }
+
+    auto ShaderCompiler::stop() -> void {
+        for (auto* program: m_linking) {
+            if (complete(*program)) {
+                program->m_compiled = true;
+            }
+        }
+
+        m_linking.clear();
+
+        if (m_thread.joinable()) {
+            {
+                std::lock_guard lock(m_mutex);
+                m_stopping = true;
+            }
+
+            m_condition.notify_all();
+            m_thread.join();
+        }
+
+        m_mode    = ShaderCompileMode::Synchronous;
+        m_context = nullptr;
+    }
+
+    auto ShaderCompiler::enqueue(ShaderProgram& program) -> void {
+        switch (m_mode) {
+            case ShaderCompileMode::Synchronous:
+                program.compile(&m_cache);
+                break;
+
+            case ShaderCompileMode::Parallel:
+                if (program.begin(&m_cache)) {
+                    program.m_compiled = true;
+                } else {
+                    m_linking.push_back(&program);
+                }
+                break;
+
+            case ShaderCompileMode::Worker:
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_queue.push_back(&program);
+                }
+
+                m_condition.notify_one();
+                break;
+        }
+    }
+
+    auto ShaderCompiler::update() -> void {
+        if (m_linking.empty()) {
+            return;
+        }
+
+        ZoneScopedNC("ShaderCompiler:Update", profiler::detail::tracy_colour_render);
+
+        std::erase_if(m_linking, [this](ShaderProgram* program) {
+            if (!program->isLinkComplete()) {
+                return false;
+            }
+
+            if (complete(*program)) {
+                program->m_compiled = true;
+            }
+
+            return true;
+        });
+    }
+
+    auto ShaderCompiler::getPending() const -> std::size_t {
+        std::lock_guard lock(m_mutex);
+        return m_linking.size() + m_queue.size() + m_in_progress;
+    }
+
+    auto ShaderCompiler::complete(ShaderProgram& program) -> bool {
+        try {
+            program.finish(&m_cache);
+            return true;
+        } catch (const Exception& exception) {
+            spdlog::error("ShaderCompiler: {}", exception.what());
+            return false;
+        }
+    }
+
+    auto ShaderCompiler::run() -> void {
+        glfwMakeContextCurrent(m_context);
+
+        while (true) {
+            ShaderProgram* program{nullptr};
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+
+                // The queue is drained before stopping, so nothing is left uncompiled
+                if (m_queue.empty()) {
+                    break;
+                }
+
+                program = m_queue.front();
+                m_queue.pop_front();
+                m_in_progress++;
+            }
+
+            {
+                ZoneScopedNC("ShaderCompiler:Compile", profiler::detail::tracy_colour_render);
+
+                auto compiled = program->begin(&m_cache) || complete(*program);
+
+                // Other contexts may only use the program once the commands building it are done
+                glFinish();
+                program->m_compiled = compiled;
+            }
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_in_progress--;
+            }
+        }
+
+        glfwMakeContextCurrent(nullptr);
+    }
+
+}// namespace rosa
@@ -14,9 +14,14 @@
 */
 
 
+#include <algorithm>
 #include <core/ResourceManager.hpp>
 #include <graphics/ShaderProgram.hpp>
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 namespace rosa {
     ShaderProgram::ShaderProgram(const Uuid& vertex_shader, const Uuid& fragment_shader)
         : m_vertex_shader_id(vertex_shader), m_fragment_shader_id(fragment_shader) {
@@ -42,7 +47,15 @@ namespace rosa {
         m_compiled           = false;
     }
 
-    auto ShaderProgram::compile() -> void {
+    auto ShaderProgram::compile(ProgramCache* cache) -> void {
+        if (!begin(cache)) {
+            finish(cache);
+        }
+
+        m_compiled = true;
+    }
+
+    auto ShaderProgram::begin(ProgramCache* cache) -> bool {
 
         m_program_id = glCreateProgram();
 
@@ -54,65 +67,144 @@ namespace rosa {
             m_fragment_shader = new Shader("default", Uuid(), "", FragmentShader);
         }
 
-        auto v_shader_id = glCreateShader(VertexShader);
-        auto f_shader_id = glCreateShader(FragmentShader);
+        // A stored binary skips compiling and linking altogether
+        m_cache_key = 0;
+        if (cache != nullptr && cache->isSupported()) {
+            m_cache_key = ProgramCache::makeKey(m_vertex_shader->getSource(), m_fragment_shader->getSource(), ProgramCache::getDriverString());
 
-        GLint result = GL_FALSE;
-        int   info_log_length{0};
+            if (cache->load(m_cache_key, m_program_id)) {
+                spdlog::debug("Loaded shader program from cache");
+                findUniforms();
+                detectVertexFormat();
+                return true;
+            }
 
-        // Compile vertex shader
-        spdlog::debug("Compiling vertex shader");
-        const char* vertex_source_ptr = m_vertex_shader->getSource().c_str();
-        glShaderSource(v_shader_id, 1, &vertex_source_ptr, nullptr);
-        glCompileShader(v_shader_id);
-
-        // Check shader
-        glGetShaderiv(v_shader_id, GL_COMPILE_STATUS, &result);
-        glGetShaderiv(v_shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
-        if (info_log_length > 0) {
-            std::vector<char> error(static_cast<std::uint64_t>(info_log_length) + 1);
-            glGetShaderInfoLog(v_shader_id, info_log_length, nullptr, error.data());
-            throw Exception(fmt::format("Failed to compile shader: {}", error.data()));
+            cache->prepare(m_program_id);
         }
 
-        // Compile fragment shader
-        spdlog::debug("Compiling fragment shader");
+        // Nothing is queried here, so drivers compiling in the background aren't waited on
+        spdlog::debug("Compiling and linking shaders");
+        const char* vertex_source_ptr = m_vertex_shader->getSource().c_str();
+        m_vertex_shader_gl_id         = glCreateShader(VertexShader);
+        glShaderSource(m_vertex_shader_gl_id, 1, &vertex_source_ptr, nullptr);
+        glCompileShader(m_vertex_shader_gl_id);
+
         const char* frag_source_ptr = m_fragment_shader->getSource().c_str();
-        glShaderSource(f_shader_id, 1, &frag_source_ptr, nullptr);
-        glCompileShader(f_shader_id);
-
-        // Check shader
-        glGetShaderiv(f_shader_id, GL_COMPILE_STATUS, &result);
-        glGetShaderiv(f_shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
-        if (info_log_length > 0) {
-            std::vector<char> error(static_cast<std::uint64_t>(info_log_length) + 1);
-            glGetShaderInfoLog(f_shader_id, info_log_length, nullptr, error.data());
-            throw Exception(fmt::format("Failed to compile shader: {}", error.data()));
-        }
+        m_fragment_shader_gl_id     = glCreateShader(FragmentShader);
+        glShaderSource(m_fragment_shader_gl_id, 1, &frag_source_ptr, nullptr);
+        glCompileShader(m_fragment_shader_gl_id);
 
-        // Link shader to program
-        spdlog::debug("Linking shaders");
-        glAttachShader(m_program_id, v_shader_id);
-        glAttachShader(m_program_id, f_shader_id);
+        glAttachShader(m_program_id, m_vertex_shader_gl_id);
+        glAttachShader(m_program_id, m_fragment_shader_gl_id);
         glLinkProgram(m_program_id);
 
+        return false;
+    }
+
+    auto ShaderProgram::isLinkComplete() const -> bool {
+        GLint complete{GL_TRUE};
+        glGetProgramiv(m_program_id, GL_COMPLETION_STATUS_KHR, &complete);
+        return complete == GL_TRUE;
+    }
+
+    auto ShaderProgram::finish(ProgramCache* cache) -> void {
+
+        // Drop the shader objects however this ends
+        auto release_shaders = [this]() {
+            glDetachShader(m_program_id, m_vertex_shader_gl_id);
+            glDetachShader(m_program_id, m_fragment_shader_gl_id);
+            glDeleteShader(m_vertex_shader_gl_id);
+            glDeleteShader(m_fragment_shader_gl_id);
+            m_vertex_shader_gl_id   = 0;
+            m_fragment_shader_gl_id = 0;
+        };
+
+        auto fail = [this, &release_shaders](const std::string& message) {
+            release_shaders();
+            m_failed = true;
+            throw Exception(message);
+        };
+
+        // Logs may hold warnings alone, so only the status decides success
+        auto check_shader = [&fail](unsigned int shader_id) {
+            GLint result{GL_FALSE};
+            int   info_log_length{0};
+            glGetShaderiv(shader_id, GL_COMPILE_STATUS, &result);
+            glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
+
+            if (info_log_length > 1) {
+                std::vector<char> error(static_cast<std::uint64_t>(info_log_length) + 1);
+                glGetShaderInfoLog(shader_id, info_log_length, nullptr, error.data());
+
+                if (result != GL_TRUE) {
+                    fail(fmt::format("Failed to compile shader: {}", error.data()));
+                }
+
+                spdlog::warn("Shader compiled with warnings: {}", error.data());
+            } else if (result != GL_TRUE) {
+                fail("Failed to compile shader");
+            }
+        };
+
+        check_shader(m_vertex_shader_gl_id);
+        check_shader(m_fragment_shader_gl_id);
+
         // Check the program
+        GLint result{GL_FALSE};
+        int   info_log_length{0};
         glGetProgramiv(m_program_id, GL_LINK_STATUS, &result);
         glGetProgramiv(m_program_id, GL_INFO_LOG_LENGTH, &info_log_length);
-        if (info_log_length > 0) {
-            std::vector<char> error(static_cast<std::uint64_t>(info_log_length) + 1);
+        if (result != GL_TRUE) {
+            std::vector<char> error(static_cast<std::uint64_t>(std::max(info_log_length, 0)) + 1);
             glGetProgramInfoLog(m_program_id, info_log_length, nullptr, error.data());
-            throw Exception(fmt::format("Failed to link shaders: {}", error.data()));
+            fail(fmt::format("Failed to link shaders: {}", error.data()));
         }
 
-        m_mvp_id = glGetUniformLocation(m_program_id, "mvp");
+        if (cache != nullptr && m_cache_key != 0) {
+            cache->store(m_cache_key, m_program_id);
+        }
 
-        glDetachShader(m_program_id, v_shader_id);
-        glDetachShader(m_program_id, f_shader_id);
-        glDeleteShader(v_shader_id);
-        glDeleteShader(f_shader_id);
+        findUniforms();
+        detectVertexFormat();
+        release_shaders();
+    }
 
-        m_compiled = true;
+    auto ShaderProgram::findUniforms() -> void {
+        m_mvp_id          = glGetUniformLocation(m_program_id, "mvp");
+        m_alpha_cutoff_id = glGetUniformLocation(m_program_id, "alphaCutoff");
+
+        auto camera_block = glGetUniformBlockIndex(m_program_id, "Camera");
+        if (camera_block != GL_INVALID_INDEX) {
+            glUniformBlockBinding(m_program_id, camera_block, camera_uniform_binding);
+        }
+    }
+
+    auto ShaderProgram::detectVertexFormat() -> void {
+        if (m_vertex_format_set) {
+            return;
+        }
+
+        // Integer attributes fed to a float input read as garbage, so only a uint texture slot means Compact
+        m_vertex_format = VertexFormat::Full;
+
+        GLint attribute_count{0};
+        GLint max_name_length{0};
+        glGetProgramiv(m_program_id, GL_ACTIVE_ATTRIBUTES, &attribute_count);
+        glGetProgramiv(m_program_id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_name_length);
+
+        std::vector<char> name(static_cast<std::uint64_t>(std::max(max_name_length, 1)));
+        for (GLint i = 0; i < attribute_count; i++) {
+            GLint  size{0};
+            GLenum type{0};
+            glGetActiveAttrib(m_program_id, static_cast<GLuint>(i), max_name_length, nullptr, &size, &type, name.data());
+
+            if (glGetAttribLocation(m_program_id, name.data()) == 3) {
+                if (type == GL_UNSIGNED_INT) {
+                    m_vertex_format = VertexFormat::Compact;
+                }
+                break;
+            }
+        }
     }
 
 }// namespace rosa
\ No newline at end of file
@@ -44,10 +44,28 @@ namespace rosa {
                 transform,
                 m_shader_program,
                 m_screen_space};
+        renderable.layer      = m_layer;
+        renderable.blend_mode = m_blend_mode;
 
         Renderer::getInstance().submit(renderable);
     }
 
+    auto Sprite::drawRetained(const Uuid& key, glm::mat4 transform) -> void {
+
+        if (m_shader_program == nullptr) {
+            return;
+        }
+
+        m_quad.pos.x = transform[3].x;
+        m_quad.pos.y = transform[3].y;
+
+        Renderable renderable{m_quad, transform, m_shader_program, m_screen_space};
+        renderable.layer      = m_layer;
+        renderable.blend_mode = m_blend_mode;
+
+        Renderer::getInstance().submitRetained(key, renderable);
+    }
+
     auto Sprite::setColour(const Colour& colour) -> void {
         m_quad.colour = colour;
     }
@@ -55,7 +73,9 @@ namespace rosa {
     auto Sprite::setTexture(const Uuid& uuid) -> void {
         m_texture = &ResourceManager::getInstance().getAsset<Texture>(uuid);
         m_quad.texture_id = m_texture->getOpenGlId();
-        m_quad.texture_rect_size = glm::vec2(1, 1);
+        m_quad.texture_layer = m_texture->getLayer();
+        m_quad.texture_rect_pos = m_texture->getUvOffset();
+        m_quad.texture_rect_size = m_texture->getUvScale();
         m_quad.size = m_texture->getSize();
     }
 
@@ -67,6 +87,22 @@ namespace rosa {
         return m_screen_space;
     }
 
+    auto Sprite::setLayer(int layer) -> void {
+        m_layer = layer;
+    }
+
+    auto Sprite::getLayer() const -> int {
+        return m_layer;
+    }
+
+    auto Sprite::setBlendMode(BlendMode blend_mode) -> void {
+        m_blend_mode = blend_mode;
+    }
+
+    auto Sprite::getBlendMode() const -> BlendMode {
+        return m_blend_mode;
+    }
+
     auto Sprite::getTexture() const -> Texture &
     {
         return *m_texture;
@@ -77,8 +113,9 @@ namespace rosa {
     }
 
     auto Sprite::setTextureRect(glm::vec2 position, glm::vec2 size) -> void {
-        m_quad.texture_rect_pos = position / m_texture->getSize();
-        m_quad.texture_rect_size = size / m_texture->getSize();
+        // Normalise, then remap into the atlas region if the texture has one
+        m_quad.texture_rect_pos = m_texture->getUvOffset() + (position / m_texture->getSize()) * m_texture->getUvScale();
+        m_quad.texture_rect_size = (size / m_texture->getSize()) * m_texture->getUvScale();
         m_quad.size = size;
     }
 
@@ -91,7 +128,12 @@ namespace rosa {
     }
 
     auto Sprite::getTextureRect() -> Rect {
-        return {m_quad.texture_rect_pos, m_quad.texture_rect_size};
+        if (m_texture == nullptr) {
+            return {m_quad.texture_rect_pos, m_quad.texture_rect_size};
+        }
+
+        return {(m_quad.texture_rect_pos - m_texture->getUvOffset()) / m_texture->getUvScale(),
+                m_quad.texture_rect_size / m_texture->getUvScale()};
     }
 
     auto Sprite::setShaders(const Uuid& vertex, const Uuid& fragment) -> void {
@@ -101,6 +143,17 @@ namespace rosa {
         m_shader_program = Renderer::getInstance().makeShaderProgram(m_vertex_shader, m_fragment_shader);
     }
 
+    auto Sprite::getBounds(const glm::mat4& transform) -> const Rect& {
+        if (transform != m_bounds_transform || m_quad.size != m_bounds_size) {
+            m_bounds           = quadBounds(transform, m_quad.size);
+            m_bounds_transform = transform;
+            m_bounds_size      = m_quad.size;
+            m_indexed_as       = Uuid();
+        }
+
+        return m_bounds;
+    }
+
     auto Sprite::getVertexShader() -> const Uuid& {
         return m_vertex_shader;
     }
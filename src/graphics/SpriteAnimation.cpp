@@ -0,0 +1,166 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/SpriteAnimation.hpp>
+
+#include <algorithm>
+#include <core/SerialiserTypes.hpp>
+#include <fmt/format.h>
+#include <physfs.h>
+
+namespace rosa {
+
+    // Zero length frames would never let a clip advance
+    constexpr float min_frame_duration{0.001F};
+
+    static auto parseLoop(const std::string& loop) -> AnimationLoop {
+        if (loop == "once") {
+            return AnimationLoop::Once;
+        }
+
+        if (loop == "ping_pong") {
+            return AnimationLoop::PingPong;
+        }
+
+        if (loop == "loop") {
+            return AnimationLoop::Loop;
+        }
+
+        throw Exception(fmt::format("Unknown animation loop mode {}", loop));
+    }
+
+    SpriteAnimation::SpriteAnimation(const std::string& name, const Uuid& uuid, const std::string& pack)
+        : Resource(name, uuid, pack) {
+
+        if (PHYSFS_exists(name.c_str()) == 0) {
+            throw ResourceNotFoundException(fmt::format("Couldn't find animation {}", name));
+        }
+
+        PHYSFS_file* file = PHYSFS_openRead(name.c_str());
+        if (file == nullptr) {
+            throw Exception(fmt::format("Failed to open file for reading {}", name));
+        }
+
+        std::string content{};
+        content.resize(static_cast<std::size_t>(PHYSFS_fileLength(file)));
+
+        auto length_read = PHYSFS_readBytes(file, content.data(), content.size());
+        PHYSFS_close(file);
+
+        if (length_read != static_cast<PHYSFS_sint64>(content.size())) {
+            throw Exception(fmt::format("Error reading file {}", name));
+        }
+
+        for (auto& clip: parseClips(YAML::Load(content)["clips"])) {
+            m_clips.push_back({std::move(clip)});
+        }
+    }
+
+    SpriteAnimation::SpriteAnimation(const std::string& name, const Uuid& uuid, const std::string& pack, const YAML::Node& clips)
+        : Resource(name, uuid, pack) {
+
+        for (auto& clip: parseClips(clips)) {
+            m_clips.push_back({std::move(clip)});
+        }
+    }
+
+    auto SpriteAnimation::parseClips(const YAML::Node& clips) -> std::vector<AnimationClip> {
+        if (!clips || !clips.IsSequence()) {
+            throw Exception("Animation has no clips");
+        }
+
+        std::vector<AnimationClip> result{};
+
+        for (const auto& node: clips) {
+            AnimationClip clip{};
+            clip.name = node["name"].as<std::string>();
+
+            if (node["loop"]) {
+                clip.loop = parseLoop(node["loop"].as<std::string>());
+            }
+
+            auto frame_duration = node["frame_duration"] ? node["frame_duration"].as<float>() : 0.1F;
+
+            if (const auto& frames = node["frames"]) {
+                for (const auto& frame: frames) {
+                    auto rect     = frame["rect"];
+                    auto duration = frame["duration"] ? frame["duration"].as<float>() : frame_duration;
+
+                    if (!rect.IsSequence() || rect.size() != 4) {
+                        throw Exception(fmt::format("Frame rects in clip {} need x, y, width and height", clip.name));
+                    }
+
+                    clip.frames.push_back({{{rect[0].as<float>(), rect[1].as<float>()}, {rect[2].as<float>(), rect[3].as<float>()}}, duration});
+                }
+            } else if (const auto& grid = node["grid"]) {
+                auto origin  = grid["origin"] ? grid["origin"].as<glm::vec2>() : glm::vec2(0.F);
+                auto size    = grid["size"].as<glm::vec2>();
+                auto count   = grid["count"].as<int>();
+                auto columns = std::max(grid["columns"] ? grid["columns"].as<int>() : count, 1);
+
+                for (int i = 0; i < count; i++) {
+                    auto cell = glm::vec2(static_cast<float>(i % columns), static_cast<float>(i / columns));
+                    clip.frames.push_back({{origin + cell * size, size}, frame_duration});
+                }
+            }
+
+            if (clip.frames.empty()) {
+                throw Exception(fmt::format("Clip {} has no frames", clip.name));
+            }
+
+            for (auto& frame: clip.frames) {
+                frame.duration = std::max(frame.duration, min_frame_duration);
+            }
+
+            result.push_back(std::move(clip));
+        }
+
+        return result;
+    }
+
+    auto SpriteAnimation::findClip(std::string_view name) const -> std::optional<std::size_t> {
+        for (std::size_t i = 0; i < m_clips.size(); i++) {
+            if (m_clips[i].clip.name == name) {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    auto SpriteAnimation::getFrameUv(std::size_t clip, std::size_t frame, const Texture& texture) const -> const AnimationFrameUv& {
+        const auto& data = m_clips[clip];
+
+        // Worked out again only when the clip is used with a different texture
+        if (data.texture != &texture) {
+            auto texture_size = texture.getSize();
+            auto uv_offset    = texture.getUvOffset();
+            auto uv_scale     = texture.getUvScale();
+
+            data.uvs.clear();
+            for (const auto& animation_frame: data.clip.frames) {
+                data.uvs.push_back({uv_offset + (animation_frame.rect.position / texture_size) * uv_scale,
+                                    (animation_frame.rect.size / texture_size) * uv_scale,
+                                    animation_frame.rect.size});
+            }
+
+            data.texture = &texture;
+        }
+
+        return data.uvs[frame];
+    }
+
+}// namespace rosa
@@ -0,0 +1,83 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/TextLayout.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace rosa {
+
+    // Colours compare with an epsilon, so only the text is hashed
+    static auto hashText(std::string_view text) -> std::size_t {
+        return std::hash<std::string_view>()(text);
+    }
+
+    auto TextLayoutCache::find(std::string_view text, Colour colour) const -> std::shared_ptr<TextLayout> {
+        auto [begin, end] = m_layouts.equal_range(hashText(text));
+        for (auto entry = begin; entry != end; ++entry) {
+            auto layout = entry->second.lock();
+            if (layout && layout->text == text && layout->colour == colour) {
+                return layout;
+            }
+        }
+
+        return nullptr;
+    }
+
+    auto TextLayoutCache::insert(const std::shared_ptr<TextLayout>& layout) -> void {
+        if (m_layouts.size() >= m_sweep_size) {
+            sweep();
+        }
+
+        if (m_spare_nodes.empty()) {
+            m_layouts.emplace(hashText(layout->text), layout);
+            return;
+        }
+
+        auto node     = std::move(m_spare_nodes.back());
+        node.key()    = hashText(layout->text);
+        node.mapped() = layout;
+        m_spare_nodes.pop_back();
+        m_layouts.insert(std::move(node));
+    }
+
+    auto TextLayoutCache::remove(const TextLayout& layout) -> void {
+        auto [begin, end] = m_layouts.equal_range(hashText(layout.text));
+        for (auto entry = begin; entry != end; ++entry) {
+            auto live = entry->second.lock();
+            if (live.get() == &layout) {
+                m_spare_nodes.push_back(m_layouts.extract(entry));
+                return;
+            }
+        }
+    }
+
+    auto TextLayoutCache::sweep() -> void {
+        for (auto entry = m_layouts.begin(); entry != m_layouts.end();) {
+            if (entry->second.expired()) {
+                m_spare_nodes.push_back(m_layouts.extract(entry++));
+            } else {
+                ++entry;
+            }
+        }
+
+        // Keep a few spare nodes for layouts changing in place, free the rest
+        m_spare_nodes.resize(std::min(m_spare_nodes.size(), min_sweep_size));
+        m_sweep_size = std::max(min_sweep_size, m_layouts.size() * 2);
+    }
+
+}// namespace rosa
@@ -15,6 +15,7 @@
 
 #include <GLFW/glfw3.h>
 #include <graphics/Texture.hpp>
+#include <graphics/TextureAtlas.hpp>
 #include <graphics/gl.hpp>
 
 #include <cstring>
@@ -35,7 +36,7 @@
 #endif
 
 namespace rosa {
-    Texture::Texture(const std::string& name, const Uuid& uuid, const std::string& pack, TextureFilterParams filter_params)
+    Texture::Texture(const std::string& name, const Uuid& uuid, const std::string& pack, TextureFilterParams filter_params, bool defer_upload)
         : rosa::Resource(name, uuid, pack), m_filter_params(filter_params) {
 
         if (PHYSFS_exists(name.c_str()) == 0) {
@@ -77,36 +78,47 @@ namespace rosa {
         std::memcpy(&four_cc,       &header[80], sizeof(unsigned int));
         // clang-format on
 
-        m_size = glm::vec2(width, height);
-        std::vector<unsigned char> buffer;
+        m_size          = glm::vec2(width, height);
+        m_mip_map_count = mip_map_count;
 
         /* how big is it going to be including all mipmaps? */
         unsigned int buf_size{mip_map_count > 1 ? linear_size * 2 : linear_size};
 
         // Read the remainder
-        buffer.resize(buf_size);
-        PHYSFS_readBytes(file, buffer.data(), buf_size);
+        m_pixel_data.resize(buf_size);
+        PHYSFS_readBytes(file, m_pixel_data.data(), buf_size);
 
         // Close up physfs stream
         PHYSFS_close(file);
 
         // Process DDS
-        unsigned int format{0};
         switch (four_cc) {
             case FOURCC_DXT1:
-                format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                m_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
                 break;
             case FOURCC_DXT3:
-                format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+                m_format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
                 break;
             case FOURCC_DXT5:
-                format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                m_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
                 break;
             default:
                 throw MalformedDDSException("Could not determine DDS texture compression");
                 break;
         }
 
+        if (!defer_upload) {
+            upload();
+        }
+    }
+
+    Texture::~Texture() {
+        if (m_atlas != nullptr) {
+            m_atlas->release(m_atlas_region);
+        }
+    }
+
+    auto Texture::upload() -> void {
         if (glfwGetCurrentContext() != nullptr) {
             // Create one OpenGL texture
             glGenTextures(1, &m_texture_id);
@@ -119,25 +131,38 @@ namespace rosa {
             glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-            unsigned int block_size = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
-            unsigned int offset     = 0;
-
             /* load the mipmaps */
-            for (unsigned int level = 0; level < mip_map_count && (width > 0 || height > 0); ++level) {
-                auto size = ((width + 3) / 4) * ((height + 3) / 4) * block_size;
-                glCompressedTexImage2D(
-                        GL_TEXTURE_2D,
-                        static_cast<GLint>(level),
-                        format,
-                        static_cast<GLsizei>(width),
-                        static_cast<GLsizei>(height),
-                        0, static_cast<GLsizei>(size),
-                        buffer.data() + offset);
-
-                offset += size;
-                width /= 2;
-                height /= 2;
+            forEachLevel([this](int level, int width, int height, int size, const unsigned char* data) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, m_format, width, height, 0, size, data);
+            });
+        }
+
+        // Data lives on the GPU from here on
+        m_pixel_data.clear();
+        m_pixel_data.shrink_to_fit();
+    }
+
+    auto Texture::forEachLevel(const std::function<void(int level, int width, int height, int size, const unsigned char* data)>& func) const -> void {
+        unsigned int block_size = (m_format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
+        unsigned int offset     = 0;
+        auto         width      = static_cast<unsigned int>(m_size.x);
+        auto         height     = static_cast<unsigned int>(m_size.y);
+
+        for (unsigned int level = 0; level < m_mip_map_count && (width > 0 || height > 0); ++level) {
+            auto size = ((width + 3) / 4) * ((height + 3) / 4) * block_size;
+            if (offset + size > m_pixel_data.size()) {
+                break;
             }
+
+            func(static_cast<int>(level),
+                 static_cast<int>(width),
+                 static_cast<int>(height),
+                 static_cast<int>(size),
+                 m_pixel_data.data() + offset);
+
+            offset += size;
+            width /= 2;
+            height /= 2;
         }
     }
 
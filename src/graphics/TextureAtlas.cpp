@@ -0,0 +1,168 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <GLFW/glfw3.h>
+#include <graphics/TextureAtlas.hpp>
+#include <graphics/gl.hpp>
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+#ifndef GL_EXT_texture_compression_s3tc
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+
+namespace rosa {
+
+    // Atlases only have a single level, so mipmapped filtering falls back to its base mode
+    static auto baseFilter(TextureFilterMode mode) -> TextureFilterMode {
+        switch (mode) {
+            case TextureFilterMode::NearestMipMapNearest:
+            case TextureFilterMode::NearestMipMapLinear:
+                return TextureFilterMode::Nearest;
+            case TextureFilterMode::LinearMipMapNearest:
+            case TextureFilterMode::LinearMipMapLinear:
+                return TextureFilterMode::Linear;
+            default:
+                return mode;
+        }
+    }
+
+    TextureAtlas::TextureAtlas(int size, unsigned int format, TextureFilterParams filter_params, int padding)
+        : m_size(size),
+          m_format(format),
+          m_filter_params({baseFilter(filter_params.minify), baseFilter(filter_params.magnify)}),
+          m_allocator(size, size, format == GL_RGBA8 ? 1 : 4, padding) {
+
+        if (glfwGetCurrentContext() == nullptr) {
+            return;
+        }
+
+        glGenTextures(1, &m_texture_id);
+        glBindTexture(GL_TEXTURE_2D, m_texture_id);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_filter_params.minify);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_filter_params.magnify);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        // Start from cleared storage so the gutters sample as transparent
+        if (isCompressed()) {
+            auto                       block_size = (m_format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
+            auto                       data_size  = (size / 4) * (size / 4) * block_size;
+            std::vector<unsigned char> empty(static_cast<std::size_t>(data_size), 0);
+
+            // Zeroed DXT3/5 blocks have zero alpha, but a zeroed DXT1 block is opaque black.
+            // Equal endpoints select the 3 colour mode, where index 3 is transparent black.
+            if (m_format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) {
+                for (std::size_t i = 4; i < empty.size(); i += 8) {
+                    std::fill_n(empty.begin() + static_cast<std::ptrdiff_t>(i), 4, 0xFF);
+                }
+            }
+            glCompressedTexImage2D(GL_TEXTURE_2D, 0, m_format, size, size, 0, data_size, empty.data());
+        } else {
+            std::vector<unsigned char> empty(static_cast<std::size_t>(size) * static_cast<std::size_t>(size) * 4, 0);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, empty.data());
+        }
+
+        spdlog::debug("TextureAtlas: Created {}x{} atlas with format {:#x}", size, size, format);
+    }
+
+    TextureAtlas::~TextureAtlas() {
+        if (m_texture_id != 0 && glfwGetCurrentContext() != nullptr) {
+            glDeleteTextures(1, &m_texture_id);
+        }
+    }
+
+    auto TextureAtlas::insert(Texture& texture) -> bool {
+        auto width  = static_cast<int>(texture.getSize().x);
+        auto height = static_cast<int>(texture.getSize().y);
+
+        // Compressed blocks can only be copied whole
+        if (!isCompressed() || texture.getFormat() != m_format || width % 4 != 0 || height % 4 != 0) {
+            return false;
+        }
+
+        auto region = m_allocator.allocate(width, height);
+        if (!region) {
+            return false;
+        }
+
+        if (m_texture_id != 0) {
+            glBindTexture(GL_TEXTURE_2D, m_texture_id);
+            texture.forEachLevel([this, &region](int level, int level_width, int level_height, int size, const unsigned char* data) {
+                if (level == 0) {
+                    glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, region->x, region->y, level_width, level_height, m_format, size, data);
+                }
+            });
+        }
+
+        texture.m_texture_id   = m_texture_id;
+        texture.m_atlas        = this;
+        texture.m_atlas_region = *region;
+        texture.m_uv_offset    = getUvOffset(*region);
+        texture.m_uv_scale     = getUvScale(*region);
+        texture.m_pixel_data.clear();
+        texture.m_pixel_data.shrink_to_fit();
+
+        return true;
+    }
+
+    auto TextureAtlas::insert(int width, int height, const unsigned char* pixels) -> std::optional<AtlasRegion> {
+        if (isCompressed()) {
+            return std::nullopt;
+        }
+
+        auto region = m_allocator.allocate(width, height);
+        if (!region) {
+            return std::nullopt;
+        }
+
+        if (m_texture_id != 0) {
+            glBindTexture(GL_TEXTURE_2D, m_texture_id);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, region->x, region->y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+
+        return region;
+    }
+
+    auto TextureAtlas::release(const AtlasRegion& region) -> void {
+        m_allocator.release(region);
+        m_evictions++;
+    }
+
+    auto TextureAtlas::accepts(unsigned int format, TextureFilterParams filter_params) const -> bool {
+        return format == m_format &&
+               baseFilter(filter_params.minify) == m_filter_params.minify &&
+               baseFilter(filter_params.magnify) == m_filter_params.magnify;
+    }
+
+    auto TextureAtlas::getUvOffset(const AtlasRegion& region) const -> glm::vec2 {
+        return glm::vec2(region.x, region.y) / static_cast<float>(m_size);
+    }
+
+    auto TextureAtlas::getUvScale(const AtlasRegion& region) const -> glm::vec2 {
+        return glm::vec2(region.width, region.height) / static_cast<float>(m_size);
+    }
+
+    auto TextureAtlas::isCompressed() const -> bool {
+        return m_format != GL_RGBA8;
+    }
+
+}// namespace rosa
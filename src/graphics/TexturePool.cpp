@@ -0,0 +1,87 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <GLFW/glfw3.h>
+#include <graphics/TexturePool.hpp>
+#include <graphics/gl.hpp>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace rosa {
+
+    TexturePool::TexturePool(const std::string& name, glm::vec2 size, unsigned int format, unsigned int mip_map_count, int layer_count, TextureFilterParams filter_params)
+        : m_name(name), m_size(size), m_format(format), m_mip_map_count(mip_map_count), m_capacity(layer_count), m_filter_params(filter_params) {}
+
+    TexturePool::~TexturePool() {
+        if (m_texture_id != 0 && glfwGetCurrentContext() != nullptr) {
+            glDeleteTextures(1, &m_texture_id);
+        }
+    }
+
+    auto TexturePool::addLayer(Texture& texture) -> int {
+        if (texture.getSize() != m_size || texture.getFormat() != m_format || texture.getMipMapCount() != m_mip_map_count) {
+            throw TexturePoolMismatchException(fmt::format("Texture {} doesn't match texture pool {}", texture.getName(), m_name));
+        }
+
+        if (m_layer_count >= m_capacity) {
+            throw TexturePoolMismatchException(fmt::format("Texture pool {} is full", m_name));
+        }
+
+        if (glfwGetCurrentContext() == nullptr) {
+            return m_layer_count++;
+        }
+
+        // Storage is allocated on first use, so the level sizes can be taken from real data
+        if (m_texture_id == 0) {
+            glGenTextures(1, &m_texture_id);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_id);
+
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, m_filter_params.minify);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, m_filter_params.magnify);
+            glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+            texture.forEachLevel([this](int level, int width, int height, int size, const unsigned char* /*data*/) {
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, m_format, width, height, m_capacity, 0, size * m_capacity, nullptr);
+            });
+
+            spdlog::debug("TexturePool: Allocated pool {} with {} layers of {}x{}", m_name, m_capacity, m_size.x, m_size.y);
+        } else {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_id);
+        }
+
+        int layer = m_layer_count;
+        texture.forEachLevel([this, layer](int level, int width, int height, int size, const unsigned char* data) {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, m_format, size, data);
+        });
+
+        texture.m_texture_id = m_texture_id;
+        texture.m_layer      = layer;
+        texture.m_pixel_data.clear();
+        texture.m_pixel_data.shrink_to_fit();
+
+        return m_layer_count++;
+    }
+
+    auto TexturePool::getMaxLayers() -> int {
+        GLint max_layers{256};
+        if (glfwGetCurrentContext() != nullptr) {
+            glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+        }
+        return max_layers;
+    }
+
+}// namespace rosa
@@ -0,0 +1,80 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/VertexFormat.hpp>
+#include <graphics/gl.hpp>
+
+namespace rosa {
+
+    auto getVertexSize(VertexFormat format) -> std::size_t {
+        return format == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex);
+    }
+
+    auto setupVertexLayout(VertexFormat format) -> void {
+        if (format == VertexFormat::Full) {
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, position.x));
+
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_TRUE, sizeof(Vertex), (const void*) offsetof(Vertex, texture_coords.x));
+
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, colour.r));
+
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, texture_slot));
+
+            glEnableVertexAttribArray(4);
+            glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, texture_layer));
+
+            glEnableVertexAttribArray(5);
+            glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, depth));
+            return;
+        }
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(CompactVertex), (const void*) offsetof(CompactVertex, position));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex), (const void*) offsetof(CompactVertex, texture_coords));
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CompactVertex), (const void*) offsetof(CompactVertex, colour));
+
+        glEnableVertexAttribArray(3);
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_BYTE, sizeof(CompactVertex), (const void*) offsetof(CompactVertex, texture_slot));
+
+        glEnableVertexAttribArray(4);
+        glVertexAttribIPointer(4, 1, GL_UNSIGNED_SHORT, sizeof(CompactVertex), (const void*) offsetof(CompactVertex, texture_layer));
+
+        glEnableVertexAttribArray(5);
+        glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(CompactVertex), (const void*) offsetof(CompactVertex, depth));
+    }
+
+    auto stageVertices(const Vertex* vertices, std::size_t count, VertexFormat format, std::vector<CompactVertex>& staging) -> const void* {
+        if (format == VertexFormat::Full) {
+            return vertices;
+        }
+
+        staging.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            staging[i] = packVertex(vertices[i]);
+        }
+
+        return staging.data();
+    }
+
+}// namespace rosa
@@ -0,0 +1,88 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <graphics/AtlasAllocator.hpp>
+#include <snitch/snitch.hpp>
+#include <vector>
+
+TEST_CASE("Atlas allocations don't overlap", "[atlas]") {
+
+    rosa::AtlasAllocator allocator(256, 256);
+    std::vector<rosa::AtlasRegion> regions{};
+
+    for (int i = 0; i < 16; i++) {
+        auto region = allocator.allocate(64, 64);
+        REQUIRE(region.has_value());
+        regions.push_back(*region);
+    }
+
+    for (std::size_t a = 0; a < regions.size(); a++) {
+        for (std::size_t b = a + 1; b < regions.size(); b++) {
+            bool overlap = regions[a].x < regions[b].x + regions[b].width &&
+                           regions[b].x < regions[a].x + regions[a].width &&
+                           regions[a].y < regions[b].y + regions[b].height &&
+                           regions[b].y < regions[a].y + regions[a].height;
+            REQUIRE(!overlap);
+        }
+    }
+
+    REQUIRE(allocator.getFillRatio() == 1.F);
+    REQUIRE(!allocator.allocate(1, 1).has_value());
+}
+
+TEST_CASE("Atlas allocations respect alignment and padding", "[atlas]") {
+
+    rosa::AtlasAllocator allocator(64, 64, 4, 2);
+
+    auto first  = allocator.allocate(5, 5);
+    auto second = allocator.allocate(5, 5);
+
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    REQUIRE(first->width == 5);
+    REQUIRE(second->x % 4 == 0);
+    REQUIRE(second->y % 4 == 0);
+    REQUIRE((second->x >= 8 || second->y >= 8));
+}
+
+TEST_CASE("Released atlas regions can be reused", "[atlas]") {
+
+    rosa::AtlasAllocator allocator(128, 128);
+
+    auto big = allocator.allocate(128, 128);
+    REQUIRE(big.has_value());
+    REQUIRE(!allocator.allocate(16, 16).has_value());
+
+    allocator.release(*big);
+    REQUIRE(allocator.getAllocationCount() == 0);
+    REQUIRE(allocator.getFillRatio() == 0.F);
+
+    auto quarter_a = allocator.allocate(64, 128);
+    auto quarter_b = allocator.allocate(64, 128);
+    REQUIRE(quarter_a.has_value());
+    REQUIRE(quarter_b.has_value());
+
+    // Freeing one half should leave room for a block of the same size again
+    allocator.release(*quarter_a);
+    REQUIRE(allocator.allocate(64, 128).has_value());
+}
+
+TEST_CASE("Oversized atlas allocations fail", "[atlas]") {
+
+    rosa::AtlasAllocator allocator(32, 32);
+
+    REQUIRE(!allocator.allocate(33, 8).has_value());
+    REQUIRE(!allocator.allocate(0, 8).has_value());
+}
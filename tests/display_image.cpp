@@ -91,4 +91,29 @@ TEST_CASE("Displays a simple 2d image on a quad", "[gl]") {
 
     // Reference image should match the current framebuffer
     REQUIRE(rosa::ImageComparator::compareEqualityBasic(pixels, ref_pixels) == true);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Reads a frame back asynchronously", "[gl]") {
+
+    auto game_mgr = rosa::GameManager(800, 600, "Display Image", 0, /*window_hidden=*/true);
+
+    rosa::ResourceManager::getInstance().registerAssetPack("references/base.pak", "");
+
+    game_mgr.addScene("display_image", std::make_unique<DisplayImage>(game_mgr.getRenderWindow()));
+    game_mgr.changeScene("display_image");
+
+    // Ask for the next frame before running, it arrives a couple of frames later
+    auto capture = game_mgr.getRenderWindow()->getFrameReader().request();
+
+    game_mgr.run(3);
+
+    REQUIRE(capture.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+
+    auto frame = capture.get();
+    REQUIRE(frame.width == 800);
+    REQUIRE(frame.height == 600);
+    REQUIRE(frame.depth.empty());
+
+    std::vector<unsigned char> ref_pixels = rosa::ImageComparator::readPNG("references/display_image.png");
+    REQUIRE(rosa::ImageComparator::compareEqualityBasic(frame.colour, ref_pixels) == true);
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <filesystem>
+#include <fstream>
+#include <graphics/FrameRecorder.hpp>
+#include <iterator>
+#include <snitch/snitch.hpp>
+#include <string>
+
+static auto makeFrame(int width, int height, unsigned char value) -> rosa::FrameCapture {
+    rosa::FrameCapture capture{0, width, height};
+    capture.colour.assign(static_cast<std::size_t>(width * height * 4), value);
+    return capture;
+}
+
+static auto readFile(const std::filesystem::path& path) -> std::string {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+TEST_CASE("Frame recorder writes raw frames in order without dropping when blocking", "[capture]") {
+
+    auto path = std::filesystem::temp_directory_path() / "rosa-capture-test.rgba";
+
+    rosa::FrameRecorder recorder{};
+    recorder.start({rosa::CaptureFormat::Raw, path.string(), 2, 4, rosa::CaptureOverflow::Block});
+
+    for (int i = 0; i < 32; i++) {
+        REQUIRE(recorder.push(makeFrame(4, 2, static_cast<unsigned char>(i))));
+    }
+
+    recorder.stop();
+
+    auto stats = recorder.getStats();
+    REQUIRE(stats.captured == 32);
+    REQUIRE(stats.encoded == 32);
+    REQUIRE(stats.dropped == 0);
+
+    auto data = readFile(path);
+    REQUIRE(data.size() == std::size_t{32 * 4 * 2 * 4});
+    for (std::size_t i = 0; i < 32; i++) {
+        REQUIRE(static_cast<unsigned char>(data[i * 32]) == i);
+        REQUIRE(static_cast<unsigned char>(data[i * 32 + 31]) == i);
+    }
+
+    // Streams keep the size of their first frame
+    recorder.start({rosa::CaptureFormat::Raw, path.string()});
+    REQUIRE(recorder.push(makeFrame(4, 2, 0)));
+    REQUIRE(!recorder.push(makeFrame(2, 2, 0)));
+    recorder.stop();
+    REQUIRE(recorder.getStats().dropped == 1);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Frame recorder writes a Y4M stream", "[capture]") {
+
+    auto path = std::filesystem::temp_directory_path() / "rosa-capture-test.y4m";
+
+    rosa::FrameRecorder recorder{};
+    recorder.start({rosa::CaptureFormat::Y4m, path.string(), 4, 1, rosa::CaptureOverflow::Block, 30});
+
+    // Odd sizes round the chroma planes up
+    REQUIRE(recorder.push(makeFrame(5, 3, 255)));
+    REQUIRE(recorder.push(makeFrame(5, 3, 0)));
+    recorder.stop();
+
+    std::string header = "YUV4MPEG2 W5 H3 F30:1 Ip A1:1 C420jpeg\n";
+    std::size_t frame  = 6 + 5 * 3 + 3 * 2 * 2;
+
+    auto data = readFile(path);
+    REQUIRE(data.size() == header.size() + frame * 2);
+    REQUIRE(data.starts_with(header + "FRAME\n"));
+
+    // White then black, both with neutral chroma
+    REQUIRE(static_cast<unsigned char>(data[header.size() + 6]) == 255);
+    REQUIRE(static_cast<unsigned char>(data[header.size() + 6 + 15]) == 128);
+    REQUIRE(static_cast<unsigned char>(data[header.size() + frame + 6]) == 0);
+    REQUIRE(static_cast<unsigned char>(data[header.size() + frame + 6 + 15]) == 128);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Frame recorder writes raw frames to a pipe", "[capture]") {
+
+    auto path = std::filesystem::temp_directory_path() / "rosa-capture-pipe.rgba";
+
+    rosa::FrameRecorder recorder{};
+    recorder.start({rosa::CaptureFormat::Raw, "|cat > " + path.string()});
+
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(recorder.push(makeFrame(4, 2, static_cast<unsigned char>(i))));
+    }
+
+    recorder.stop();
+
+    REQUIRE(recorder.getStats().encoded == 4);
+    REQUIRE(readFile(path).size() == std::size_t{4 * 4 * 2 * 4});
+
+    std::filesystem::remove(path);
+}
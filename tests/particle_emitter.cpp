@@ -0,0 +1,68 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <core/ThreadPool.hpp>
+#include <core/components/ParticleEmitterComponent.hpp>
+#include <snitch/snitch.hpp>
+
+TEST_CASE("Particle emitters spawn, move and expire particles", "[particles]") {
+
+    rosa::ParticleEmitterComponent emitter{};
+
+    rosa::ParticleSettings settings{};
+    settings.rate          = 0.F;
+    settings.max_particles = 10000;
+    settings.lifetime      = {1.F, 1.F};
+    settings.speed         = {10.F, 10.F};
+    settings.direction     = 0.F;
+    settings.spread        = 0.F;
+    settings.start_size    = 4.F;
+    settings.end_size      = 8.F;
+    emitter.setSettings(settings);
+
+    // Bursts are capped at max_particles
+    emitter.burst(6000, {5.F, 5.F});
+    emitter.burst(6000, {5.F, 5.F});
+    REQUIRE(emitter.getCount() == 10000);
+
+    // Large emitters are split across workers
+    rosa::ThreadPool pool(4);
+    emitter.update(0.5F, {0.F, 0.F}, &pool);
+    REQUIRE(emitter.getCount() == 10000);
+
+    bool moved{true};
+    for (std::size_t i = 0; i < emitter.getCount(); i++) {
+        moved = moved && emitter.getPositionX()[i] == 10.F && emitter.getPositionY()[i] == 5.F;
+    }
+    REQUIRE(moved);
+    REQUIRE(emitter.getColours()[0].a == 0.5F);
+
+    emitter.update(0.5F, {0.F, 0.F});
+    REQUIRE(emitter.getCount() == 0);
+
+    // Emitting spawns at the rate given, carrying fractions over to the next update
+    settings.rate = 10.F;
+    emitter.setSettings(settings);
+    emitter.update(0.25F, {0.F, 0.F});
+    REQUIRE(emitter.getCount() == 2);
+    emitter.update(0.25F, {0.F, 0.F});
+    REQUIRE(emitter.getCount() == 5);
+
+    emitter.setEmitting(false);
+    emitter.update(0.25F, {0.F, 0.F});
+    REQUIRE(emitter.getCount() == 5);
+}
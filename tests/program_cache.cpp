@@ -0,0 +1,80 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <filesystem>
+#include <fstream>
+#include <graphics/ProgramCache.hpp>
+#include <snitch/snitch.hpp>
+
+TEST_CASE("Program cache keys change with every input", "[program_cache]") {
+
+    auto key = rosa::ProgramCache::makeKey("vertex", "fragment", "driver");
+
+    REQUIRE(key == rosa::ProgramCache::makeKey("vertex", "fragment", "driver"));
+    REQUIRE(key != rosa::ProgramCache::makeKey("vertex2", "fragment", "driver"));
+    REQUIRE(key != rosa::ProgramCache::makeKey("vertex", "fragment2", "driver"));
+    REQUIRE(key != rosa::ProgramCache::makeKey("vertex", "fragment", "driver2"));
+
+    // Text moving from one source to the other must not give the same key
+    REQUIRE(rosa::ProgramCache::makeKey("ab", "c", "") != rosa::ProgramCache::makeKey("a", "bc", ""));
+}
+
+TEST_CASE("Program cache entries round trip through disk", "[program_cache]") {
+
+    auto directory = std::filesystem::temp_directory_path() / "rosa-program-cache-test";
+    std::filesystem::remove_all(directory);
+
+    rosa::ProgramCache cache(directory);
+    rosa::ProgramBinary binary{0x1234, {1, 2, 3, 4, 5}};
+
+    REQUIRE(!cache.read(42).has_value());
+    REQUIRE(cache.write(42, binary));
+
+    auto stored = cache.read(42);
+    REQUIRE(stored.has_value());
+    REQUIRE(stored->format == 0x1234);
+    REQUIRE(stored->data == binary.data);
+
+    // A different key never picks up another entry
+    REQUIRE(!cache.read(43).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Truncated program cache entries are ignored", "[program_cache]") {
+
+    auto directory = std::filesystem::temp_directory_path() / "rosa-program-cache-truncated";
+    std::filesystem::remove_all(directory);
+
+    rosa::ProgramCache cache(directory);
+    REQUIRE(cache.write(7, {1, std::vector<unsigned char>(64, 0xAB)}));
+
+    for (const auto& entry: std::filesystem::directory_iterator(directory)) {
+        std::filesystem::resize_file(entry.path(), std::filesystem::file_size(entry.path()) - 8);
+    }
+
+    REQUIRE(!cache.read(7).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("A program cache without a directory stores nothing", "[program_cache]") {
+
+    rosa::ProgramCache cache{std::filesystem::path{}};
+
+    REQUIRE(!cache.write(1, {1, {1, 2, 3}}));
+    REQUIRE(!cache.read(1).has_value());
+}
@@ -0,0 +1,237 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <core/GameManager.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <graphics/Renderer.hpp>
+#include <snitch/snitch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+
+static auto countCommands(const rosa::FramePacket& packet, rosa::RenderCommandType type) -> std::size_t {
+    return static_cast<std::size_t>(std::count_if(packet.commands.begin(), packet.commands.end(), [type](const rosa::RenderCommand& command) {
+        return command.type == type;
+    }));
+}
+
+TEST_CASE("Meshes sharing a font are streamed in a single draw", "[gl]") {
+
+    auto game_mgr = rosa::GameManager(800, 600, "Renderer Batching", 0, /*window_hidden=*/true);
+
+    rosa::ResourceManager::getInstance().registerAssetPack("references/base.pak", "");
+
+    auto& renderer = rosa::Renderer::getInstance();
+
+    // Never compiled, so every label falls back to the same default program
+    rosa::ShaderProgram program{};
+
+    rosa::Quad font{};
+    font.texture_id = 1;
+
+    std::array<rosa::Vertex, 8> glyphs{};
+
+    rosa::FramePacket packet{};
+    renderer.beginPacket(&packet);
+
+    for (int i = 0; i < 100; i++) {
+        renderer.submitMesh({glyphs.data(), 2, glm::translate(glm::mat4(1.F), glm::vec3(0.F, static_cast<float>(i) * 10.F, 0.F)), font, &program, true});
+    }
+
+    renderer.flushFrame();
+    renderer.endPacket();
+
+    REQUIRE(countCommands(packet, rosa::RenderCommandType::StreamDraw) == 1);
+
+    auto draw = std::find_if(packet.commands.begin(), packet.commands.end(), [](const rosa::RenderCommand& command) {
+        return command.type == rosa::RenderCommandType::StreamDraw;
+    });
+    REQUIRE(draw->count == 200);
+}
+
+TEST_CASE("Submitting a span of items builds the same vertices as submitting them one by one", "[gl]") {
+
+    auto game_mgr = rosa::GameManager(800, 600, "Renderer Batching", 0, /*window_hidden=*/true);
+
+    rosa::ResourceManager::getInstance().registerAssetPack("references/base.pak", "");
+
+    auto& renderer = rosa::Renderer::getInstance();
+
+    rosa::ShaderProgram program{};
+
+    std::vector<rosa::Renderable> renderables{};
+    std::vector<rosa::RenderItem> items{};
+
+    for (int i = 0; i < 64; i++) {
+        rosa::Renderable renderable{};
+        renderable.quad.size              = glm::vec2(16.F, 8.F);
+        renderable.quad.pos               = glm::vec2(static_cast<float>(i), 0.F);
+        renderable.quad.colour            = rosa::Colour(0.5F, 0.25F, 1.F);
+        renderable.quad.texture_id        = static_cast<uint32_t>(1 + (i % 3));
+        renderable.quad.texture_rect_pos  = glm::vec2(2.F, 4.F);
+        renderable.quad.texture_rect_size = glm::vec2(16.F, 8.F);
+        renderable.transform              = glm::rotate(glm::translate(glm::mat4(1.F), glm::vec3(static_cast<float>(i) * 20.F, 10.F, 0.F)),
+                                                        static_cast<float>(i) * 0.1F, glm::vec3(0.F, 0.F, 1.F));
+        renderable.shader_program         = &program;
+        renderable.layer                  = (i % 3) - 1;
+
+        renderables.push_back(renderable);
+        items.push_back(rosa::RenderItem::fromRenderable(renderable));
+    }
+
+    rosa::FramePacket one_by_one{};
+    renderer.beginPacket(&one_by_one);
+    for (const auto& renderable : renderables) {
+        renderer.submit(renderable);
+    }
+    renderer.flushFrame();
+    renderer.endPacket();
+
+    rosa::FramePacket bulk{};
+    renderer.beginPacket(&bulk);
+    renderer.submit(std::span<const rosa::RenderItem>(items));
+    renderer.flushFrame();
+    renderer.endPacket();
+
+    // The default program reads compact vertices, which are built in place
+    REQUIRE(!bulk.compact_vertices.empty());
+    REQUIRE(one_by_one.compact_vertices.size() == bulk.compact_vertices.size());
+    REQUIRE(one_by_one.commands.size() == bulk.commands.size());
+
+    for (std::size_t i = 0; i < bulk.compact_vertices.size(); i++) {
+        const auto& expected = one_by_one.compact_vertices[i];
+        const auto& actual   = bulk.compact_vertices[i];
+        REQUIRE(expected.position == actual.position);
+        REQUIRE(expected.texture_coords == actual.texture_coords);
+        REQUIRE(expected.colour == actual.colour);
+        REQUIRE(expected.texture_slot == actual.texture_slot);
+        REQUIRE(expected.texture_layer == actual.texture_layer);
+        REQUIRE(expected.depth == actual.depth);
+    }
+}
+
+TEST_CASE("Meshes draw over queued renderables on the same layer and under higher ones", "[gl]") {
+
+    auto game_mgr = rosa::GameManager(800, 600, "Renderer Batching", 0, /*window_hidden=*/true);
+
+    rosa::ResourceManager::getInstance().registerAssetPack("references/base.pak", "");
+
+    auto& renderer = rosa::Renderer::getInstance();
+
+    rosa::ShaderProgram program{};
+
+    rosa::Renderable panel{};
+    panel.quad.size       = glm::vec2(64.F, 32.F);
+    panel.quad.texture_id = 2;
+    panel.shader_program  = &program;
+    panel.screen_space    = true;
+
+    rosa::Quad font{};
+    font.texture_id = 1;
+
+    std::array<rosa::Vertex, 4> glyph{};
+
+    auto draw_order = [](const rosa::FramePacket& packet) {
+        std::vector<rosa::RenderCommandType> order{};
+        for (const auto& command: packet.commands) {
+            if (command.type == rosa::RenderCommandType::Draw || command.type == rosa::RenderCommandType::StreamDraw) {
+                order.push_back(command.type);
+            }
+        }
+        return order;
+    };
+
+    // The label is submitted first, yet still lands over the panel sharing its layer
+    rosa::FramePacket same_layer{};
+    renderer.beginPacket(&same_layer);
+    renderer.submitMesh({glyph.data(), 1, glm::mat4(1.F), font, &program, true, 0});
+    renderer.submit(panel);
+    renderer.flushFrame();
+    renderer.endPacket();
+
+    REQUIRE(draw_order(same_layer) == std::vector{rosa::RenderCommandType::Draw, rosa::RenderCommandType::StreamDraw});
+
+    // A panel on a higher layer covers it
+    panel.layer = 1;
+
+    rosa::FramePacket higher_layer{};
+    renderer.beginPacket(&higher_layer);
+    renderer.submitMesh({glyph.data(), 1, glm::mat4(1.F), font, &program, true, 0});
+    renderer.submit(panel);
+    renderer.flushFrame();
+    renderer.endPacket();
+
+    REQUIRE(draw_order(higher_layer) == std::vector{rosa::RenderCommandType::StreamDraw, rosa::RenderCommandType::Draw});
+}
+
+TEST_CASE("Screen space starts once per frame, after world space flushed mid-frame", "[gl]") {
+
+    auto game_mgr = rosa::GameManager(800, 600, "Renderer Batching", 0, /*window_hidden=*/true);
+
+    rosa::ResourceManager::getInstance().registerAssetPack("references/base.pak", "");
+
+    auto& renderer = rosa::Renderer::getInstance();
+
+    // A queue this small has to flush several times before the frame ends
+    auto capacity = renderer.getBatchCapacity();
+    auto adaptive = renderer.getAdaptiveBatching();
+    renderer.setAdaptiveBatching(false);
+    renderer.setBatchCapacity(4);
+
+    rosa::ShaderProgram program{};
+
+    rosa::Renderable quad{};
+    quad.quad.size      = glm::vec2(8.F, 8.F);
+    quad.shader_program = &program;
+
+    rosa::FramePacket packet{};
+    renderer.beginPacket(&packet);
+
+    // World and screen space are submitted interleaved, so early flushes hold both
+    for (int i = 0; i < 15; i++) {
+        quad.screen_space = i % 5 == 4;
+        renderer.submit(quad);
+    }
+
+    renderer.flushFrame();
+    renderer.endPacket();
+
+    renderer.setBatchCapacity(capacity);
+    renderer.setAdaptiveBatching(adaptive);
+
+    REQUIRE(countCommands(packet, rosa::RenderCommandType::ScreenSpace) == 1);
+
+    std::size_t world_quads{0};
+    std::size_t screen_quads{0};
+    bool        in_screen_space{false};
+    for (const auto& command: packet.commands) {
+        if (command.type == rosa::RenderCommandType::ScreenSpace) {
+            in_screen_space = true;
+        } else if (command.type == rosa::RenderCommandType::Draw) {
+            (in_screen_space ? screen_quads : world_quads) += command.count;
+        }
+    }
+
+    REQUIRE(world_quads == 12);
+    REQUIRE(screen_quads == 3);
+
+    // Stands in for the dynamic resolution upscale, which has to see the whole world
+    int screen_space_calls{0};
+    renderer.execute(packet, [&screen_space_calls]() { screen_space_calls++; });
+    REQUIRE(screen_space_calls == 1);
+}
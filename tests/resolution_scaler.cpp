@@ -0,0 +1,61 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/ResolutionScaler.hpp>
+#include <snitch/snitch.hpp>
+
+TEST_CASE("Resolution scale follows the average frame time", "[dynamic_resolution]") {
+
+    rosa::ResolutionScaler scaler{};
+
+    // Disabled scalers always draw at full size
+    scaler.addFrame(100.F);
+    REQUIRE(scaler.getScale() == 1.F);
+
+    scaler.setSettings({true, 0.5F, 1.F, 10.F, 0.25F, 4});
+    REQUIRE(scaler.getScale() == 1.F);
+
+    // Nothing changes until the average is full
+    for (int i = 0; i < 3; i++) {
+        scaler.addFrame(20.F);
+    }
+    REQUIRE(scaler.getScale() == 1.F);
+
+    scaler.addFrame(20.F);
+    REQUIRE(scaler.getScale() == 0.75F);
+
+    // Slow frames walk down to the lower bound and stop there
+    for (int i = 0; i < 12; i++) {
+        scaler.addFrame(20.F);
+    }
+    REQUIRE(scaler.getScale() == 0.5F);
+
+    // Inside the band the scale holds
+    for (int i = 0; i < 8; i++) {
+        scaler.addFrame(9.F);
+    }
+    REQUIRE(scaler.getScale() == 0.5F);
+
+    for (int i = 0; i < 4; i++) {
+        scaler.addFrame(5.F);
+    }
+    REQUIRE(scaler.getScale() == 0.75F);
+
+    for (int i = 0; i < 8; i++) {
+        scaler.addFrame(5.F);
+    }
+    REQUIRE(scaler.getScale() == 1.F);
+}
@@ -15,8 +15,11 @@
 
 #include <core/Entity.hpp>
 #include <core/Scene.hpp>
+#include <core/components/SpriteComponent.hpp>
+#include <core/components/TransformComponent.hpp>
 #include <graphics/Renderer.hpp>
 #include <snitch/snitch.hpp>
+#include <vector>
 
 TEST_CASE("Allows us to create an entity in a scene", "[scene]") {
 
@@ -67,4 +70,33 @@ TEST_CASE("Create an entity and retrieve it", "[scene]") {
     REQUIRE(original_entity == retrieved_entity);
 
     rosa::Renderer::shutdown();
-}
\ No newline at end of file
+}
+TEST_CASE("Spatial index follows children of a moved parent", "[scene]") {
+
+    auto scene       = rosa::Scene();
+    auto parent_uuid = scene.createEntity().getUuid();
+    auto child_uuid  = scene.createEntity().getUuid();
+
+    auto& child = scene.getEntity(child_uuid);
+    child.addComponent<rosa::SpriteComponent>();
+    child.setParent(parent_uuid);
+    scene.update(0.F);
+
+    const rosa::Rect origin{{-1.F, -1.F}, {2.F, 2.F}};
+    const rosa::Rect moved{{99.F, 99.F}, {2.F, 2.F}};
+
+    REQUIRE(scene.getSpatialIndex().queryRect(origin) == std::vector<rosa::Uuid>{child_uuid});
+
+    // Nothing touched since the last update, so nothing changes
+    scene.update(0.F);
+    REQUIRE(scene.getSpatialIndex().queryRect(origin) == std::vector<rosa::Uuid>{child_uuid});
+
+    // Only the parent is marked, the child is picked up through it
+    scene.getEntity(parent_uuid).getComponent<rosa::TransformComponent>().setPosition(100.F, 100.F);
+    scene.update(0.F);
+
+    REQUIRE(scene.getSpatialIndex().queryRect(origin).empty());
+    REQUIRE(scene.getSpatialIndex().queryRect(moved) == std::vector<rosa::Uuid>{child_uuid});
+
+    rosa::Renderer::shutdown();
+}
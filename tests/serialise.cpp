@@ -330,3 +330,21 @@ TEST_CASE("Serialise a scene", "[serialiser]") {
 
     check_entities(entities);
 }
+
+TEST_CASE("Blend modes are serialised by name", "[serialiser]") {
+
+    for (auto mode: {rosa::BlendMode::Transparent, rosa::BlendMode::Opaque, rosa::BlendMode::AlphaTested}) {
+        YAML::Emitter out;
+        out << mode;
+
+        auto node = YAML::Load(out.c_str());
+        REQUIRE(node.as<std::string>() != std::to_string(static_cast<int>(mode)));
+        REQUIRE(node.as<rosa::BlendMode>() == mode);
+    }
+
+    REQUIRE(YAML::Load("alpha_tested").as<rosa::BlendMode>() == rosa::BlendMode::AlphaTested);
+
+    // Numbers, even in range, and unknown names are refused instead of becoming invalid modes
+    REQUIRE_THROWS_AS(YAML::Load("1").as<rosa::BlendMode>(), rosa::Exception);
+    REQUIRE_THROWS_AS(YAML::Load("additive").as<rosa::BlendMode>(), rosa::Exception);
+}
@@ -0,0 +1,107 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <core/SpatialIndex.hpp>
+#include <snitch/snitch.hpp>
+
+#include <limits>
+
+TEST_CASE("Spatial index only sees changes after commit", "[spatial]") {
+
+    rosa::SpatialIndex index(64.F);
+    auto               uuid = rosa::Uuid::generate();
+
+    index.update(uuid, {{10.F, 10.F}, {20.F, 20.F}});
+    REQUIRE(index.queryPoint({15.F, 15.F}).empty());
+
+    index.commit();
+    REQUIRE(index.queryPoint({15.F, 15.F}).size() == 1);
+
+    index.remove(uuid);
+    REQUIRE(index.size() == 1);
+
+    index.commit();
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.queryPoint({15.F, 15.F}).empty());
+}
+
+TEST_CASE("Spatial index queries return each handle once", "[spatial]") {
+
+    rosa::SpatialIndex index(64.F);
+    auto               wide  = rosa::Uuid::generate();
+    auto               small = rosa::Uuid::generate();
+    auto               huge  = rosa::Uuid::generate();
+
+    // Spans several cells, covers more than max_cells_per_axis, and sits in a single cell
+    index.update(wide, {{0.F, 0.F}, {300.F, 300.F}});
+    index.update(huge, {{-5000.F, -5000.F}, {10000.F, 10000.F}});
+    index.update(small, {{500.F, 500.F}, {10.F, 10.F}});
+    index.commit();
+
+    auto results = index.queryRect({{-100.F, -100.F}, {400.F, 400.F}});
+    REQUIRE(results.size() == 2);
+    REQUIRE(results[0] == wide);
+    REQUIRE(results[1] == huge);
+
+    REQUIRE(index.queryRect({{-10000.F, -10000.F}, {20000.F, 20000.F}}).size() == 3);
+}
+
+TEST_CASE("Spatial index follows moving bounds", "[spatial]") {
+
+    rosa::SpatialIndex index(64.F);
+    auto               uuid = rosa::Uuid::generate();
+
+    index.update(uuid, {{0.F, 0.F}, {10.F, 10.F}});
+    index.commit();
+
+    // Same cell, then across several cells
+    index.update(uuid, {{20.F, 20.F}, {10.F, 10.F}});
+    index.commit();
+    REQUIRE(index.queryPoint({5.F, 5.F}).empty());
+    REQUIRE(index.queryPoint({25.F, 25.F}).size() == 1);
+
+    index.update(uuid, {{1000.F, -1000.F}, {10.F, 10.F}});
+    index.commit();
+    REQUIRE(index.queryPoint({25.F, 25.F}).empty());
+    REQUIRE(index.queryRadius({1000.F, -1020.F}, 25.F).size() == 1);
+    REQUIRE(index.queryRadius({1000.F, -1020.F}, 15.F).empty());
+    REQUIRE(index.getBounds(uuid)->position == glm::vec2(1000.F, -1000.F));
+}
+
+TEST_CASE("Spatial index keeps non-finite bounds out of the grid", "[spatial]") {
+
+    rosa::SpatialIndex index(64.F);
+    auto               finite   = rosa::Uuid::generate();
+    auto               infinite = rosa::Uuid::generate();
+    auto               broken   = rosa::Uuid::generate();
+
+    constexpr auto infinity = std::numeric_limits<float>::infinity();
+    constexpr auto nan      = std::numeric_limits<float>::quiet_NaN();
+
+    index.update(finite, {{0.F, 0.F}, {10.F, 10.F}});
+    index.update(infinite, {{0.F, 0.F}, {infinity, infinity}});
+    index.update(broken, {{nan, nan}, {10.F, 10.F}});
+    index.commit();
+
+    REQUIRE(index.contains(broken));
+    REQUIRE(index.queryPoint({5.F, 5.F}).size() == 2);
+
+    // Back to finite bounds, the entry is found through the grid again
+    index.update(broken, {{100.F, 100.F}, {10.F, 10.F}});
+    index.commit();
+
+    REQUIRE(index.queryPoint({105.F, 105.F}).size() == 2);
+    REQUIRE(index.queryPoint({5.F, 5.F}).size() == 2);
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <core/components/SpriteAnimationComponent.hpp>
+#include <snitch/snitch.hpp>
+
+TEST_CASE("Sprite animation clips parse and step", "[sprite_animation]") {
+
+    auto clips = YAML::Load(R"(
+- name: walk
+  frame_duration: 0.5
+  frames:
+    - rect: [0, 0, 16, 16]
+    - rect: [16, 0, 16, 16]
+      duration: 1.0
+- name: run
+  loop: once
+  frame_duration: 0.25
+  grid: {origin: [0, 16], size: [8, 8], columns: 2, count: 3}
+- name: bob
+  loop: ping_pong
+  frame_duration: 1.0
+  grid: {origin: [0, 0], size: [4, 4], columns: 4, count: 3}
+)");
+
+    rosa::SpriteAnimation animation("", rosa::Uuid::generate(), "", clips);
+    REQUIRE(animation.getClipCount() == 3);
+
+    const auto& run = animation.getClip(*animation.findClip("run"));
+    REQUIRE(run.loop == rosa::AnimationLoop::Once);
+    REQUIRE(run.frames.size() == 3);
+    REQUIRE(run.frames[2].rect.position == glm::vec2(0.F, 24.F));
+    REQUIRE(!animation.findClip("jump"));
+
+    rosa::SpriteAnimationComponent component{};
+    component.setAnimation(animation);
+    REQUIRE(!component.play("jump"));
+
+    // Looping clips wrap around and honour per-frame durations
+    REQUIRE(component.play("walk"));
+    REQUIRE(component.step(0.F));
+    REQUIRE(!component.step(0.25F));
+    REQUIRE(component.step(0.25F));
+    REQUIRE(component.getFrame() == 1);
+    REQUIRE(!component.step(0.5F));
+    REQUIRE(component.step(0.5F));
+    REQUIRE(component.getFrame() == 0);
+
+    // Clips that play once stop on their last frame
+    REQUIRE(component.play("run"));
+    component.step(1.F);
+    REQUIRE(component.getFrame() == 2);
+    REQUIRE(component.isFinished());
+    REQUIRE(!component.isPlaying());
+
+    // Ping pong turns around at each end
+    REQUIRE(component.play("bob"));
+    std::size_t expected[] = {1, 2, 1, 0, 1};
+    for (auto frame: expected) {
+        component.step(1.F);
+        REQUIRE(component.getFrame() == frame);
+    }
+}
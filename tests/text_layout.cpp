@@ -0,0 +1,114 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include <core/Exception.hpp>
+#include <core/ResourceManager.hpp>
+#include <graphics/BitmapFont.hpp>
+#include <graphics/TextLayout.hpp>
+#include <snitch/snitch.hpp>
+
+static auto sameLayout(const rosa::TextLayout& a, const rosa::TextLayout& b) -> bool {
+    if (a.text != b.text || a.vertices.size() != b.vertices.size()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < a.vertices.size(); i++) {
+        if (a.vertices[i].position != b.vertices[i].position ||
+            a.vertices[i].texture_coords != b.vertices[i].texture_coords ||
+            !(a.vertices[i].colour == b.vertices[i].colour)) {
+            return false;
+        }
+    }
+
+    return a.bounds.position == b.bounds.position && a.bounds.size == b.bounds.size;
+}
+
+TEST_CASE("Text layouts are shared while alive and can be changed in place", "[text]") {
+
+    rosa::TextLayoutCache cache{};
+
+    auto score    = std::make_shared<rosa::TextLayout>();
+    score->text   = "Score 10";
+    score->colour = rosa::Colour{1.F, 0.F, 0.F};
+    cache.insert(score);
+
+    REQUIRE(cache.find("Score 10", rosa::Colour{1.F, 0.F, 0.F}) == score);
+    REQUIRE(cache.find("Score 10", rosa::Colour{0.F, 1.F, 0.F}) == nullptr);
+    REQUIRE(cache.find("Score 11", rosa::Colour{1.F, 0.F, 0.F}) == nullptr);
+
+    // Withdrawn while it changes, then found under its new text
+    cache.remove(*score);
+    score->text = "Score 11";
+    cache.insert(score);
+
+    REQUIRE(cache.find("Score 10", rosa::Colour{1.F, 0.F, 0.F}) == nullptr);
+    REQUIRE(cache.find("Score 11", rosa::Colour{1.F, 0.F, 0.F}) == score);
+    REQUIRE(cache.size() == 1);
+
+    // Nothing is kept alive by the cache itself
+    score.reset();
+    REQUIRE(cache.find("Score 11", rosa::Colour{1.F, 0.F, 0.F}) == nullptr);
+}
+
+TEST_CASE("Changed text lays out the same as a fresh layout of it", "[text]") {
+
+    auto& rm = rosa::ResourceManager::getInstance();
+    REQUIRE_NOTHROW(rm.registerAssetPack("../examples/base.pak", ""));
+
+    auto& font = rm.getAsset<rosa::BitmapFont>(rosa::Uuid("286d945e-7fd9-4444-a95e-3faa3e541536"));
+
+    auto relayout = [&font](rosa::TextLayout& layout, std::string_view text, rosa::Colour colour) {
+        font.layout(layout, text, colour);
+
+        rosa::TextLayout fresh{};
+        font.layout(fresh, text, colour);
+        return sameLayout(layout, fresh);
+    };
+
+    rosa::TextLayout layout{};
+    font.layout(layout, "Score 10", rosa::Colour{1.F, 1.F, 1.F});
+
+    // Longer, with the cursor carried on from the kept prefix
+    REQUIRE(relayout(layout, "Score 1024", rosa::Colour{1.F, 1.F, 1.F}));
+
+    // Changed in the middle, with glyphs of different widths
+    REQUIRE(relayout(layout, "Score WiW4", rosa::Colour{1.F, 1.F, 1.F}));
+
+    // Shorter, and sharing nothing
+    REQUIRE(relayout(layout, "Sc", rosa::Colour{1.F, 1.F, 1.F}));
+    REQUIRE(relayout(layout, "Lives 3", rosa::Colour{1.F, 1.F, 1.F}));
+
+    // A new colour regenerates every glyph
+    REQUIRE(relayout(layout, "Lives 3", rosa::Colour{1.F, 0.F, 0.F}));
+
+    REQUIRE_NOTHROW(rm.unregisterAssetPack("../examples/base.pak"));
+}
+
+TEST_CASE("Text longer than the layout limit is refused", "[text]") {
+
+    auto& rm = rosa::ResourceManager::getInstance();
+    REQUIRE_NOTHROW(rm.registerAssetPack("../examples/base.pak", ""));
+
+    auto& font = rm.getAsset<rosa::BitmapFont>(rosa::Uuid("286d945e-7fd9-4444-a95e-3faa3e541536"));
+
+    rosa::TextLayout layout{};
+    REQUIRE_NOTHROW(font.layout(layout, std::string(bf_max_layout_length, 'a')));
+    REQUIRE_THROWS_AS(font.layout(layout, std::string(bf_max_layout_length + 1, 'a')), rosa::Exception);
+
+    REQUIRE_NOTHROW(rm.unregisterAssetPack("../examples/base.pak"));
+}
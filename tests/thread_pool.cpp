@@ -0,0 +1,66 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <core/ThreadPool.hpp>
+#include <snitch/snitch.hpp>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("Thread pool covers every index exactly once", "[threads]") {
+
+    rosa::ThreadPool pool(3);
+    std::vector<int> hits(10007, 0);
+
+    pool.parallelFor(hits.size(), 100, [&hits](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            hits[i]++;
+        }
+    });
+
+    for (auto count: hits) {
+        REQUIRE(count == 1);
+    }
+}
+
+TEST_CASE("Thread pool runs submitted jobs and rethrows failures", "[threads]") {
+
+    rosa::ThreadPool pool(2);
+    std::atomic<int> counter{0};
+
+    std::vector<std::future<void>> jobs{};
+    for (int i = 0; i < 64; i++) {
+        jobs.push_back(pool.submit([&counter]() { counter++; }));
+    }
+
+    for (auto& job: jobs) {
+        job.get();
+    }
+
+    REQUIRE(counter == 64);
+
+    bool thrown{false};
+    try {
+        pool.parallelFor(1000, 10, [](std::size_t begin, std::size_t) {
+            if (begin > 0) {
+                throw std::runtime_error("range failed");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+
+    REQUIRE(thrown);
+}
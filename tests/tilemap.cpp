@@ -0,0 +1,50 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <core/components/TilemapComponent.hpp>
+#include <snitch/snitch.hpp>
+
+TEST_CASE("Tilemaps store tiles in chunks and cull them against the view", "[tilemap]") {
+
+    rosa::TilemapComponent tilemap{};
+    tilemap.resize(100, 40);
+
+    REQUIRE(tilemap.getChunkCount() == glm::ivec2(4, 2));
+    REQUIRE(tilemap.getTile(99, 39) == rosa::TilemapComponent::empty_tile);
+
+    tilemap.setTile(99, 39, 7);
+    tilemap.setTile(100, 0, 3);
+    REQUIRE(tilemap.getTile(99, 39) == 7);
+    REQUIRE(tilemap.getTile(100, 0) == rosa::TilemapComponent::empty_tile);
+
+    // 16 unit tiles make 512 unit chunks
+    glm::mat4 transform{1.F};
+
+    auto [first, last] = tilemap.getVisibleChunks(transform, {{600.F, 100.F}, {500.F, 200.F}});
+    REQUIRE(first == glm::ivec2(1, 0));
+    REQUIRE(last == glm::ivec2(3, 1));
+
+    // Off the map entirely
+    auto [outside_first, outside_last] = tilemap.getVisibleChunks(transform, {{-2000.F, -2000.F}, {100.F, 100.F}});
+    REQUIRE(outside_first == outside_last);
+
+    // The map moves with its entity
+    transform[3] = glm::vec4(-512.F, 0.F, 0.F, 1.F);
+    auto [moved_first, moved_last] = tilemap.getVisibleChunks(transform, {{0.F, 0.F}, {10.F, 10.F}});
+    REQUIRE(moved_first == glm::ivec2(1, 0));
+    REQUIRE(moved_last == glm::ivec2(2, 1));
+}
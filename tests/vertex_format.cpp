@@ -0,0 +1,64 @@
+/*
+ * This file is part of rosa.
+ *
+ *  rosa is free software: you can redistribute it and/or modify it under the terms of the
+ *  GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  rosa is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ *  even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with rosa. If not,
+ *  see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+
+#include <graphics/VertexFormat.hpp>
+#include <snitch/snitch.hpp>
+
+TEST_CASE("Compact vertices pack colour, texture coordinates and slots into integers", "[vertex]") {
+
+    REQUIRE(sizeof(rosa::CompactVertex) == 24);
+    REQUIRE(rosa::getVertexSize(rosa::VertexFormat::Full) == sizeof(rosa::Vertex));
+
+    rosa::Vertex vertex{};
+    vertex.texture_coords = {1.F, 0.5F};
+    vertex.colour         = rosa::Colour{1.F, 0.F, 0.5F, 2.F};
+    vertex.texture_slot   = 17.F;
+    vertex.texture_layer  = 3.F;
+    vertex.depth          = -0.25F;
+
+    std::vector<rosa::CompactVertex> staging{};
+
+    // Full vertices are uploaded as they are
+    REQUIRE(rosa::stageVertices(&vertex, 1, rosa::VertexFormat::Full, staging) == &vertex);
+    REQUIRE(staging.empty());
+
+    const auto* packed = static_cast<const rosa::CompactVertex*>(rosa::stageVertices(&vertex, 1, rosa::VertexFormat::Compact, staging));
+    REQUIRE(packed == staging.data());
+    REQUIRE(packed->texture_coords[0] == 65535);
+    REQUIRE(packed->texture_coords[1] == 32768);
+    REQUIRE(packed->colour[0] == 255);
+    REQUIRE(packed->colour[1] == 0);
+    REQUIRE(packed->colour[2] == 128);
+    REQUIRE(packed->colour[3] == 255);
+    REQUIRE(packed->texture_slot == 17);
+    REQUIRE(packed->texture_layer == 3);
+    REQUIRE(packed->depth == -0.25F);
+}
+
+TEST_CASE("Packing clamps texture coordinates and colours to the normalised range", "[vertex]") {
+
+    rosa::Vertex vertex{};
+    vertex.texture_coords = {1.5F, -0.25F};
+    vertex.colour         = rosa::Colour{-1.F, 0.F, 1.F, 4.F};
+
+    auto packed = rosa::packVertex(vertex);
+    REQUIRE(packed.texture_coords[0] == 65535);
+    REQUIRE(packed.texture_coords[1] == 0);
+    REQUIRE(packed.colour[0] == 0);
+    REQUIRE(packed.colour[3] == 255);
+}